@@ -0,0 +1,420 @@
+/*!
+ * \file
+ */
+#include "batchrun.hpp"
+#include "runpipeline.hpp"
+#include "runcache.hpp"
+#include "validationcache.hpp"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QSettings>
+#include <QThread>
+#include <QDebug>
+
+namespace Developer {
+
+BatchRun::BatchRun(QObject *parent)
+    : QObject(parent)
+    , _compiler("gp2compile")
+    , _maxParallelRuns(1)
+    , _validationCache(0)
+    , _runCache(0)
+    , _reuseResults(true)
+    , _timeLimit(0)
+    , _cpuLimit(0)
+    , _memoryLimit(0)
+    , _sharedValidated(false)
+    , _active(false)
+    , _finished(0)
+    , _succeeded(0)
+{
+    QSettings settings;
+    setMaxParallelRuns(settings.value("Run/ParallelRuns",
+                                      QThread::idealThreadCount()).toInt());
+}
+
+BatchRun::~BatchRun()
+{
+    // Nobody is left to hear about the batch ending
+    disconnect();
+    cancel();
+}
+
+QString BatchRun::compiler() const
+{
+    return _compiler;
+}
+
+void BatchRun::setCompiler(const QString &compiler)
+{
+    _compiler = compiler;
+}
+
+QStringList BatchRun::rules() const
+{
+    return _rules;
+}
+
+void BatchRun::setRules(const QStringList &rulePaths)
+{
+    _rules = rulePaths;
+}
+
+int BatchRun::maxParallelRuns() const
+{
+    return _maxParallelRuns;
+}
+
+void BatchRun::setMaxParallelRuns(int count)
+{
+    _maxParallelRuns = (count < 1) ? 1 : count;
+}
+
+ValidationCache *BatchRun::validationCache() const
+{
+    return _validationCache;
+}
+
+void BatchRun::setValidationCache(ValidationCache *cache)
+{
+    _validationCache = cache;
+}
+
+RunCache *BatchRun::runCache() const
+{
+    return _runCache;
+}
+
+void BatchRun::setRunCache(RunCache *cache)
+{
+    _runCache = cache;
+}
+
+bool BatchRun::reuseResults() const
+{
+    return _reuseResults;
+}
+
+void BatchRun::setReuseResults(bool reuse)
+{
+    _reuseResults = reuse;
+}
+
+void BatchRun::setLimits(int timeLimit, int cpuLimit, int memoryLimit)
+{
+    _timeLimit = timeLimit;
+    _cpuLimit = cpuLimit;
+    _memoryLimit = memoryLimit;
+}
+
+int BatchRun::instanceCount() const
+{
+    return _instances.count();
+}
+
+int BatchRun::finishedCount() const
+{
+    return _finished;
+}
+
+bool BatchRun::isRunning() const
+{
+    return _active;
+}
+
+QStringList BatchRun::expandGraphs(const QString &pattern, const QDir &base)
+{
+    QStringList graphs;
+    QString path = QDir::fromNativeSeparators(pattern.trimmed());
+    if(path.isEmpty())
+        return graphs;
+
+    QFileInfo info(base, path);
+    QDir dir;
+    QStringList filters;
+    if(info.isDir())
+    {
+        dir = QDir(info.absoluteFilePath());
+        filters << "*.host";
+    }
+    else
+    {
+        // Only the final component is treated as a pattern
+        dir = info.absoluteDir();
+        filters << info.fileName();
+    }
+
+    QStringList names = dir.entryList(filters, QDir::Files | QDir::Readable,
+                                      QDir::Name);
+    for(int i = 0; i < names.count(); ++i)
+        graphs << dir.absoluteFilePath(names.at(i));
+
+    return graphs;
+}
+
+QString BatchRun::statusName(InstanceStatus status)
+{
+    switch(status)
+    {
+    case Instance_Pending:
+        return tr("Pending");
+    case Instance_Running:
+        return tr("Running");
+    case Instance_Succeeded:
+        return tr("Succeeded");
+    case Instance_NoOutput:
+        return tr("No output graph");
+    case Instance_Failed:
+        return tr("Failed");
+    case Instance_Cancelled:
+        return tr("Cancelled");
+    case Instance_LimitExceeded:
+        return tr("Limit exceeded");
+    default:
+        return QString();
+    }
+}
+
+void BatchRun::start(const QString &programFile, const QStringList &graphFiles,
+                     const QString &outputDirectory)
+{
+    if(_active)
+    {
+        qDebug() << "BatchRun::start() called during a batch, ignoring";
+        return;
+    }
+
+    _programFile = programFile;
+    _compilerIdentity = ValidationCache::identify(_compiler);
+    _instances.clear();
+    _pending.clear();
+    _sharedValidated = false;
+    _finished = 0;
+    _succeeded = 0;
+    _failureTitle = QString();
+    _failureMessage = QString();
+    _active = true;
+
+    QDir outputDir(outputDirectory);
+    if(!outputDir.exists())
+        outputDir.mkpath(outputDir.absolutePath());
+
+    _instances.resize(graphFiles.count());
+    for(int i = 0; i < graphFiles.count(); ++i)
+    {
+        Instance &instance = _instances[i];
+        instance.graphFile = graphFiles.at(i);
+        instance.outputFile = outputDir.filePath(
+                    QFileInfo(instance.graphFile).completeBaseName() + ".host");
+        instance.runKey = RunCache::key(_programFile, instance.graphFile,
+                                        _compilerIdentity);
+        instance.status = Instance_Pending;
+        _pending << i;
+    }
+
+    qDebug() << "  Starting batch of" << _instances.count() << "host graphs with"
+             << "up to" << _maxParallelRuns << "parallel runs";
+    emit progress(0, _instances.count());
+
+    // Anything which has been run before with identical inputs is done
+    if(_runCache != 0 && _reuseResults)
+    {
+        QList<int> pending = _pending;
+        for(int i = 0; i < pending.count(); ++i)
+        {
+            int index = pending.at(i);
+            QString previous = _runCache->result(_instances.at(index).runKey);
+            if(previous.isEmpty())
+                continue;
+
+            qDebug() << "    Reusing earlier result for"
+                     << _instances.at(index).graphFile;
+            _pending.removeOne(index);
+            _instances[index].outputFile = previous;
+            instanceDone(index, hasOutputGraph(previous) ? Instance_Succeeded
+                                                         : Instance_NoOutput,
+                         0);
+        }
+    }
+
+    fillPool();
+    checkFinished();
+}
+
+void BatchRun::cancel()
+{
+    if(!_active)
+        return;
+
+    qDebug() << "  Batch cancelled with" << _running.count() << "runs in flight";
+
+    QList<RunPipeline *> pipelines = _running.keys();
+    for(int i = 0; i < pipelines.count(); ++i)
+    {
+        RunPipeline *pipeline = pipelines.at(i);
+        pipeline->disconnect(this);
+        pipeline->cancel();
+        pipeline->deleteLater();
+        _instances[_running.value(pipeline)].status = Instance_Cancelled;
+    }
+    _running.clear();
+
+    for(int i = 0; i < _pending.count(); ++i)
+        _instances[_pending.at(i)].status = Instance_Cancelled;
+    _pending.clear();
+
+    _active = false;
+    emit finished(_succeeded, _instances.count());
+}
+
+void BatchRun::pipelineStageChanged(int stage, QString description)
+{
+    Q_UNUSED(description)
+
+    // The rules and program have passed, the other instances can use the
+    // cached validation and go straight to their host graphs
+    if(!_sharedValidated && stage >= RunPipeline::Stage_ValidateGraph
+            && stage != RunPipeline::Stage_Finished)
+    {
+        _sharedValidated = true;
+        fillPool();
+    }
+}
+
+void BatchRun::pipelineFailed(QString title, QString message)
+{
+    RunPipeline *pipeline = qobject_cast<RunPipeline *>(sender());
+    if(pipeline == 0 || !_running.contains(pipeline))
+        return;
+
+    qDebug() << "    Batch instance failed:"
+             << _instances.at(_running.value(pipeline)).graphFile << "-" << title;
+    if(!_sharedValidated)
+    {
+        _failureTitle = title;
+        _failureMessage = message;
+    }
+}
+
+void BatchRun::pipelineFinished(bool success)
+{
+    RunPipeline *pipeline = qobject_cast<RunPipeline *>(sender());
+    if(pipeline == 0 || !_running.contains(pipeline))
+        return;
+
+    int index = _running.take(pipeline);
+    pipeline->deleteLater();
+    qint64 elapsed = _instances.at(index).timer.elapsed();
+
+    if(!success && !_sharedValidated)
+    {
+        // The rules or the program are invalid, every instance would fail
+        instanceDone(index, Instance_Failed, elapsed);
+        for(int i = 0; i < _pending.count(); ++i)
+            _instances[_pending.at(i)].status = Instance_Cancelled;
+        _pending.clear();
+
+        emit failed(_failureTitle, _failureMessage);
+        checkFinished();
+        return;
+    }
+
+    InstanceStatus status = Instance_Failed;
+    if(success)
+    {
+        const Instance &instance = _instances.at(index);
+        status = hasOutputGraph(instance.outputFile) ? Instance_Succeeded
+                                                     : Instance_NoOutput;
+        if(_runCache != 0)
+            _runCache->insert(instance.runKey, instance.outputFile);
+    }
+    else if(pipeline->exceededLimit() != RunPipeline::Limit_None)
+        status = Instance_LimitExceeded;
+
+    instanceDone(index, status, elapsed);
+    fillPool();
+    checkFinished();
+}
+
+void BatchRun::fillPool()
+{
+    // Until the shared inputs have been validated only one instance runs
+    int limit = _sharedValidated ? _maxParallelRuns : 1;
+    while(_active && !_pending.isEmpty() && _running.count() < limit)
+    {
+        startInstance(_pending.takeFirst());
+        limit = _sharedValidated ? _maxParallelRuns : 1;
+    }
+}
+
+void BatchRun::startInstance(int index)
+{
+    Instance &instance = _instances[index];
+    instance.status = Instance_Running;
+
+    RunPipeline *pipeline = new RunPipeline(this);
+    pipeline->setCompiler(_compiler);
+    pipeline->setRules(_rules);
+    pipeline->setValidationCache(_validationCache);
+    pipeline->setTimeLimit(_timeLimit);
+    pipeline->setCpuLimit(_cpuLimit);
+    pipeline->setMemoryLimit(_memoryLimit);
+    pipeline->setLogFile(QFileInfo(instance.outputFile).dir().filePath(
+                             QFileInfo(instance.outputFile).completeBaseName()
+                             + ".log"));
+    connect(pipeline, SIGNAL(stageChanged(int,QString)),
+            this, SLOT(pipelineStageChanged(int,QString)));
+    connect(pipeline, SIGNAL(failed(QString,QString)),
+            this, SLOT(pipelineFailed(QString,QString)));
+    connect(pipeline, SIGNAL(finished(bool)),
+            this, SLOT(pipelineFinished(bool)));
+
+    // Registered first, the pipeline may finish before start() returns
+    _running.insert(pipeline, index);
+    instance.timer.start();
+    pipeline->start(_programFile, instance.graphFile, instance.outputFile);
+}
+
+void BatchRun::instanceDone(int index, InstanceStatus status, qint64 elapsed)
+{
+    Instance &instance = _instances[index];
+    instance.status = status;
+    ++_finished;
+    if(status == Instance_Succeeded)
+        ++_succeeded;
+
+    emit instanceFinished(instance.graphFile, instance.outputFile, status,
+                          elapsed);
+    emit progress(_finished, _instances.count());
+}
+
+void BatchRun::checkFinished()
+{
+    if(!_active || !_running.isEmpty() || !_pending.isEmpty())
+        return;
+
+    _active = false;
+    if(_runCache != 0)
+        _runCache->save();
+
+    qDebug() << "  Batch complete," << _succeeded << "of" << _instances.count()
+             << "instances produced an output graph";
+    emit finished(_succeeded, _instances.count());
+}
+
+bool BatchRun::hasOutputGraph(const QString &outputFile)
+{
+    // The compiler reports failure in place of the output graph:
+    //  "No output graph: rule %s not applicable."
+    //  "No output graph: Fail statement invoked"
+    QFile result(outputFile);
+    if(!result.open(QIODevice::ReadOnly | QIODevice::Text))
+        return false;
+
+    QTextStream data(&result);
+    return data.atEnd() || !data.readLine().startsWith("No output graph");
+}
+
+}
@@ -0,0 +1,196 @@
+/*!
+ * \file
+ */
+#ifndef BATCHRUN_HPP
+#define BATCHRUN_HPP
+
+#include <QObject>
+#include <QStringList>
+#include <QVector>
+#include <QMap>
+#include <QDir>
+#include <QElapsedTimer>
+
+namespace Developer {
+
+class RunPipeline;
+class ValidationCache;
+class RunCache;
+
+/*!
+ * \brief Runs one GP program against a set of host graphs
+ *
+ * Each host graph is an instance of the batch, and is run by its own
+ * RunPipeline in its own build directory. Up to maxParallelRuns() instances
+ * are in flight at once.
+ *
+ * The rules and the program are the same for every instance, so the first
+ * instance is started on its own. Once it has validated them, and they have
+ * been recorded in the ValidationCache, the rest of the pool is filled and
+ * those instances go straight to validating their host graph. If the shared
+ * validation fails then the whole batch stops with that failure rather than
+ * reporting it once per graph.
+ *
+ * gp2compile builds the host graph into the executable it generates, so the
+ * compile, build and execute stages still happen once per instance.
+ *
+ * Unless reuseResults() is turned off, instances whose result is already in
+ * the RunCache are reported straight away without being run.
+ */
+class BatchRun : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum InstanceStatus
+    {
+        //! Waiting for a free worker
+        Instance_Pending,
+        //! A pipeline is working on the instance
+        Instance_Running,
+        //! An output graph was produced
+        Instance_Succeeded,
+        //! The program ran but reported that there is no output graph
+        Instance_NoOutput,
+        //! A stage of the pipeline failed
+        Instance_Failed,
+        //! The batch was cancelled before the instance completed
+        Instance_Cancelled,
+        //! The program was stopped by a time, CPU or memory limit
+        Instance_LimitExceeded
+    };
+
+    explicit BatchRun(QObject *parent = 0);
+    ~BatchRun();
+
+    QString compiler() const;
+    void setCompiler(const QString &compiler);
+    QStringList rules() const;
+    void setRules(const QStringList &rulePaths);
+    int maxParallelRuns() const;
+    void setMaxParallelRuns(int count);
+    ValidationCache *validationCache() const;
+    void setValidationCache(ValidationCache *cache);
+    RunCache *runCache() const;
+    void setRunCache(RunCache *cache);
+    bool reuseResults() const;
+    void setReuseResults(bool reuse);
+
+    /*!
+     * \brief Limit each run of the program, see RunPipeline
+     * \param timeLimit    Wall clock seconds, 0 for no limit
+     * \param cpuLimit     CPU seconds, 0 for no limit
+     * \param memoryLimit  Megabytes of address space, 0 for no limit
+     */
+    void setLimits(int timeLimit, int cpuLimit, int memoryLimit);
+
+    int instanceCount() const;
+    int finishedCount() const;
+    bool isRunning() const;
+
+    /*!
+     * \brief Find the host graphs described by a directory or glob pattern
+     *
+     * A directory selects every .host file within it. Anything else is taken
+     * as a path whose final component may contain wildcards, for example
+     * "instances/grid-*.host".
+     *
+     * \param pattern   The directory or pattern, relative paths are resolved
+     *  against base
+     * \param base      Directory relative patterns start from
+     * \return Absolute paths of the matching files, sorted by name
+     */
+    static QStringList expandGraphs(const QString &pattern, const QDir &base);
+
+    static QString statusName(InstanceStatus status);
+
+public slots:
+    /*!
+     * \brief Begin running the batch
+     *
+     * \param programFile       The program text with all rules appended
+     * \param graphFiles        The host graphs, one instance each
+     * \param outputDirectory   Directory the output graphs are written to,
+     *  each is named after its host graph
+     */
+    void start(const QString &programFile, const QStringList &graphFiles,
+               const QString &outputDirectory);
+
+    /*!
+     * \brief Stop every running instance and abandon the rest
+     */
+    void cancel();
+
+signals:
+    /*!
+     * \brief Emitted as each instance completes, in completion order
+     * \param graphFile     The instance's host graph
+     * \param outputFile    The output graph, valid for Instance_Succeeded and
+     *  Instance_NoOutput
+     * \param status        One of InstanceStatus
+     * \param elapsed       Wall clock time taken by the instance, in
+     *  milliseconds
+     */
+    void instanceFinished(QString graphFile, QString outputFile, int status,
+                          qint64 elapsed);
+    void progress(int value, int maximum);
+
+    /*!
+     * \brief Emitted if the inputs shared by every instance are invalid
+     */
+    void failed(QString title, QString message);
+
+    /*!
+     * \brief Emitted once no instance is left running
+     * \param succeeded Number of instances which produced an output graph
+     * \param total     Number of instances in the batch
+     */
+    void finished(int succeeded, int total);
+
+private slots:
+    void pipelineStageChanged(int stage, QString description);
+    void pipelineFailed(QString title, QString message);
+    void pipelineFinished(bool success);
+
+private:
+    struct Instance
+    {
+        QString graphFile;
+        QString outputFile;
+        QByteArray runKey;
+        InstanceStatus status;
+        QElapsedTimer timer;
+    };
+
+    void fillPool();
+    void startInstance(int index);
+    void instanceDone(int index, InstanceStatus status, qint64 elapsed);
+    void checkFinished();
+    static bool hasOutputGraph(const QString &outputFile);
+
+    QString _compiler;
+    QStringList _rules;
+    int _maxParallelRuns;
+    ValidationCache *_validationCache;
+    RunCache *_runCache;
+    bool _reuseResults;
+    int _timeLimit;
+    int _cpuLimit;
+    int _memoryLimit;
+
+    QString _programFile;
+    QString _compilerIdentity;
+    QVector<Instance> _instances;
+    QList<int> _pending;
+    QMap<RunPipeline *, int> _running;
+    bool _sharedValidated;
+    bool _active;
+    int _finished;
+    int _succeeded;
+    QString _failureTitle;
+    QString _failureMessage;
+};
+
+}
+
+#endif // BATCHRUN_HPP
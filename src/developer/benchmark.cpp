@@ -0,0 +1,208 @@
+/*!
+ * \file
+ */
+#include "benchmark.hpp"
+
+#include <QFile>
+#include <QTextStream>
+#include <QStringList>
+#include <QDebug>
+
+#include <algorithm>
+#include <math.h>
+
+namespace Developer {
+
+BenchmarkSummary::BenchmarkSummary()
+    : count(0)
+    , min(0)
+    , median(0)
+    , mean(0)
+    , p95(0)
+    , stddev(0)
+{
+}
+
+Benchmark::Benchmark()
+{
+}
+
+bool Benchmark::isEmpty() const
+{
+    return _samples.isEmpty();
+}
+
+int Benchmark::count() const
+{
+    return _samples.count();
+}
+
+void Benchmark::clear()
+{
+    _samples.clear();
+}
+
+void Benchmark::addSample(const ResourceUsage &usage)
+{
+    _samples.append(usage);
+}
+
+ResourceUsage Benchmark::sample(int index) const
+{
+    return _samples.at(index);
+}
+
+BenchmarkSummary Benchmark::wallTime() const
+{
+    QVector<double> values;
+    for(int i = 0; i < _samples.count(); ++i)
+        values << _samples.at(i).wallTime;
+
+    return summarise(values);
+}
+
+BenchmarkSummary Benchmark::peakMemory() const
+{
+    QVector<double> values;
+    for(int i = 0; i < _samples.count(); ++i)
+        values << _samples.at(i).peakMemory;
+
+    return summarise(values);
+}
+
+BenchmarkSummary Benchmark::summarise(QVector<double> values)
+{
+    BenchmarkSummary summary;
+    summary.count = values.count();
+    if(values.isEmpty())
+        return summary;
+
+    std::sort(values.begin(), values.end());
+    int n = values.count();
+
+    summary.min = values.first();
+    summary.median = (n % 2 == 1) ? values.at(n / 2)
+                                  : (values.at(n / 2 - 1) + values.at(n / 2)) / 2;
+
+    // Nearest rank: the smallest value with at least 95% of samples at or
+    // below it
+    int rank = static_cast<int>(ceil(0.95 * n));
+    summary.p95 = values.at(qBound(0, rank - 1, n - 1));
+
+    double sum = 0;
+    for(int i = 0; i < n; ++i)
+        sum += values.at(i);
+    summary.mean = sum / n;
+
+    if(n > 1)
+    {
+        double squares = 0;
+        for(int i = 0; i < n; ++i)
+            squares += (values.at(i) - summary.mean)
+                    * (values.at(i) - summary.mean);
+        summary.stddev = sqrt(squares / (n - 1));
+    }
+
+    return summary;
+}
+
+bool Benchmark::saveCsv(const QString &filePath) const
+{
+    QFile file(filePath);
+    if(!file.open(QFile::WriteOnly | QFile::Truncate | QFile::Text))
+    {
+        qDebug() << "    Could not write benchmark samples: " << filePath;
+        return false;
+    }
+
+    QTextStream out(&file);
+    out << "run,wall_ms,user_ms,system_ms,peak_kb\n";
+    for(int i = 0; i < _samples.count(); ++i)
+    {
+        const ResourceUsage &usage = _samples.at(i);
+        out << (i + 1) << "," << usage.wallTime << "," << usage.userTime << ","
+            << usage.systemTime << "," << usage.peakMemory << "\n";
+    }
+
+    return true;
+}
+
+bool Benchmark::loadCsv(const QString &filePath)
+{
+    clear();
+
+    QFile file(filePath);
+    if(!file.exists() || !file.open(QFile::ReadOnly | QFile::Text))
+        return false;
+
+    QTextStream in(&file);
+    in.readLine();  // Header
+    while(!in.atEnd())
+    {
+        QStringList fields = in.readLine().split(',');
+        if(fields.count() < 5)
+            continue;
+
+        ResourceUsage usage;
+        usage.wallTime = fields.at(1).toLongLong();
+        usage.userTime = fields.at(2).toLongLong();
+        usage.systemTime = fields.at(3).toLongLong();
+        usage.peakMemory = fields.at(4).toLongLong();
+        usage.processes = 1;
+        addSample(usage);
+    }
+
+    return true;
+}
+
+static QString jsonSummary(const BenchmarkSummary &summary)
+{
+    return QString("{\"min\": %1, \"median\": %2, \"mean\": %3, \"p95\": %4, "
+                   "\"stddev\": %5}")
+            .arg(summary.min, 0, 'f', 3)
+            .arg(summary.median, 0, 'f', 3)
+            .arg(summary.mean, 0, 'f', 3)
+            .arg(summary.p95, 0, 'f', 3)
+            .arg(summary.stddev, 0, 'f', 3);
+}
+
+bool Benchmark::saveJson(const QString &filePath) const
+{
+    QFile file(filePath);
+    if(!file.open(QFile::WriteOnly | QFile::Truncate | QFile::Text))
+    {
+        qDebug() << "    Could not write benchmark summary: " << filePath;
+        return false;
+    }
+
+    QTextStream out(&file);
+    out << "{\n";
+    out << "    \"runs\": " << _samples.count() << ",\n";
+    out << "    \"wall_ms\": " << jsonSummary(wallTime()) << ",\n";
+    out << "    \"peak_kb\": " << jsonSummary(peakMemory()) << ",\n";
+    out << "    \"samples\": [";
+    for(int i = 0; i < _samples.count(); ++i)
+    {
+        const ResourceUsage &usage = _samples.at(i);
+        out << (i == 0 ? "\n" : ",\n")
+            << "        {\"wall_ms\": " << usage.wallTime
+            << ", \"user_ms\": " << usage.userTime
+            << ", \"system_ms\": " << usage.systemTime
+            << ", \"peak_kb\": " << usage.peakMemory << "}";
+    }
+    out << "\n    ]\n}\n";
+
+    return true;
+}
+
+QString Benchmark::csvFile(const QString &resultFile)
+{
+    return resultFile + ".benchmark.csv";
+}
+
+QString Benchmark::jsonFile(const QString &resultFile)
+{
+    return resultFile + ".benchmark.json";
+}
+
+}
@@ -0,0 +1,78 @@
+/*!
+ * \file
+ */
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include "runusage.hpp"
+
+#include <QString>
+#include <QVector>
+
+namespace Developer {
+
+/*!
+ * \brief Summary statistics of one measured quantity over many runs
+ */
+struct BenchmarkSummary
+{
+    BenchmarkSummary();
+
+    int count;
+    double min;
+    double median;
+    double mean;
+    //! 95th percentile, by the nearest rank method
+    double p95;
+    //! Sample standard deviation, 0 for fewer than two samples
+    double stddev;
+};
+
+/*!
+ * \brief The measured executions of a benchmark run
+ *
+ * Each sample is the usage of one execution of gp2run. The samples are stored
+ * next to the result graph as CSV, one execution per line:
+ *
+ * \code
+ *  run,wall_ms,user_ms,system_ms,peak_kb
+ *  1,1520,1490,20,20480
+ * \endcode
+ *
+ * The samples and their summary are also written as JSON for other tools, that
+ * file is never read back.
+ */
+class Benchmark
+{
+public:
+    Benchmark();
+
+    bool isEmpty() const;
+    int count() const;
+    void clear();
+    void addSample(const ResourceUsage &usage);
+    ResourceUsage sample(int index) const;
+
+    //! Wall clock times, in milliseconds
+    BenchmarkSummary wallTime() const;
+    //! Peak resident set sizes, in kilobytes
+    BenchmarkSummary peakMemory() const;
+    static BenchmarkSummary summarise(QVector<double> values);
+
+    bool saveCsv(const QString &filePath) const;
+    bool loadCsv(const QString &filePath);
+    bool saveJson(const QString &filePath) const;
+
+    /*!
+     * \brief Get the path the samples of a result graph are stored at
+     */
+    static QString csvFile(const QString &resultFile);
+    static QString jsonFile(const QString &resultFile);
+
+private:
+    QVector<ResourceUsage> _samples;
+};
+
+}
+
+#endif // BENCHMARK_HPP
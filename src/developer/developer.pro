@@ -73,7 +73,23 @@ HEADERS += \
     list.hpp \
     firstrundialog.hpp \
     listvalidator.hpp \
-    runconfig.hpp
+    runconfig.hpp \
+    projectindex.hpp \
+    runprocess.hpp \
+    runpipeline.hpp \
+    validationcache.hpp \
+    runcache.hpp \
+    batchrun.hpp \
+    runusage.hpp \
+    outputlog.hpp \
+    syntaxcheck.hpp \
+    benchmark.hpp \
+    runqueue.hpp \
+    runqueueview.hpp \
+    graphview/renderstyle.hpp \
+    graphview/textcache.hpp \
+    graphview/spatialgrid.hpp \
+    graphview/layoutjob.hpp
 
 FORMS += \
     welcome.ui \
@@ -105,7 +121,8 @@ FORMS += \
     importruledialog.ui \
     importgraphdialog.ui \
     openprojectprogressdialog.ui \
-    firstrundialog.ui
+    firstrundialog.ui \
+    runqueueview.ui
 
 RESOURCES += \
     icons.qrc \
@@ -173,7 +190,23 @@ SOURCES += \
     list.cpp \
     firstrundialog.cpp \
     listvalidator.cpp \
-    runconfig.cpp
+    runconfig.cpp \
+    projectindex.cpp \
+    runprocess.cpp \
+    runpipeline.cpp \
+    validationcache.cpp \
+    runcache.cpp \
+    batchrun.cpp \
+    runusage.cpp \
+    outputlog.cpp \
+    syntaxcheck.cpp \
+    benchmark.cpp \
+    runqueue.cpp \
+    runqueueview.cpp \
+    graphview/renderstyle.cpp \
+    graphview/textcache.cpp \
+    graphview/spatialgrid.cpp \
+    graphview/layoutjob.cpp
 
 OTHER_FILES += \
     templates/newproject.gpp \
@@ -18,6 +18,7 @@ Graph::Graph(const QString &graphPath, bool autoInitialise, QObject *parent, boo
     , _nodeIdCounter(0)
     , _edgeIdCounter(0)
     , _isRuleGraph(isRuleGraph)
+    , _opened(graphPath.isEmpty())
 {
     if(autoInitialise && !graphPath.isEmpty())
         open();
@@ -30,6 +31,7 @@ Graph::Graph(const graph_t &inputGraph, QObject *parent, bool isRuleGraph)
     , _nodeIdCounter(0)
     , _edgeIdCounter(0)
     , _isRuleGraph(isRuleGraph)
+    , _opened(true)
 {
     // We don't follow the normal open procedure here, since this is not coming
     // from a file. This is intended for create in-memory graph objects and
@@ -49,6 +51,11 @@ bool Graph::save()
         return false;
     }
 
+    // A graph which has never been read in cannot have changed, so the file on
+    // disk is already up to date
+    if(!_opened)
+        return true;
+
     _fp->close();
     ++_internalChanges;
     _fp->open(QFile::Truncate | QFile::WriteOnly);
@@ -131,6 +138,9 @@ bool Graph::saveAs(const QString &filePath)
             return false;
     }
 
+    // The contents must be read from the old file before it is left behind
+    ensureOpen();
+
     // Cache the path to the old file, if the save process fails then we should
     // restore the old one
     QString pathCache = _path;
@@ -248,19 +258,46 @@ bool Graph::open()
 {
     if(!GPFile::open())
     {
+        // Nothing can be read in, stop the accessors from trying again
+        _opened = true;
         emit openComplete();
         return false;
     }
 
+    // A graph already in memory is kept, as when it is saved under a new name
+    if(_opened)
+    {
+        emit openComplete();
+        return true;
+    }
+
     qDebug() << "Opening graph file: " << _path;
+    if(!parse())
+    {
+        qDebug() << "    Graph parsing failed.";
+        return false;
+    }
 
-    if ( (_fp ==0) || !_fp->exists())
+    qDebug() << "    Finished parsing graph file.";
+    emit openComplete();
+    return true;
+}
+
+bool Graph::parse()
+{
+    // Set this first, openGraphT() goes through the public accessors which
+    // would otherwise try to parse the file again
+    _opened = true;
+
+    QFile file(_path);
+    if(!file.open(QFile::ReadOnly | QFile::Text))
     {
         qDebug() << "    Graph file does not exist." << _path;
         return false;
     }
 
-    QString contents = _fp->readAll();
+    QString contents = file.readAll();
+    file.close();
     //std::string contentsString = contents.toStdString();
 
     graph_t graph;
@@ -297,24 +334,23 @@ bool Graph::open()
         }
     }
 
-    if(!openGraphT(graph))
-    {
-        qDebug() << "    Graph parsing failed.";
-        return false;
-    }
+    return openGraphT(graph);
+}
 
-    qDebug() << "    Finished parsing graph file.";
-    emit openComplete();
-    return true;
+bool Graph::isOpened() const
+{
+    return _opened;
 }
 
 QRect Graph::canvas() const
 {
+    ensureOpen();
     return _canvas;
 }
 
 Node *Graph::node(const QString &id) const
 {
+    ensureOpen();
     for(nodeConstIter iter = _nodes.begin(); iter != _nodes.end(); ++iter)
     {
         Node *n = *iter;
@@ -327,6 +363,7 @@ Node *Graph::node(const QString &id) const
 
 Edge *Graph::edge(const QString &id) const
 {
+    ensureOpen();
     for(edgeConstIter iter = _edges.begin(); iter != _edges.end(); ++iter)
     {
         Edge *e = *iter;
@@ -339,6 +376,7 @@ Edge *Graph::edge(const QString &id) const
 
 bool Graph::hasEdgeFrom(const QString &id) const
 {
+    ensureOpen();
     for(edgeConstIter iter = _edges.begin(); iter != _edges.end(); ++iter)
     {
         Edge *e = *iter;
@@ -351,6 +389,7 @@ bool Graph::hasEdgeFrom(const QString &id) const
 
 bool Graph::hasEdgeTo(const QString &id) const
 {
+    ensureOpen();
     for(edgeConstIter iter = _edges.begin(); iter != _edges.end(); ++iter)
     {
         Edge *e = *iter;
@@ -364,6 +403,7 @@ bool Graph::hasEdgeTo(const QString &id) const
 
 bool Graph::hasEdgeFromTo(const QString &sourceId, const QString &targetId) const
 {
+    ensureOpen();
     for(edgeConstIter iter = _edges.begin(); iter != _edges.end(); ++iter)
     {
         Edge *e = *iter;
@@ -376,11 +416,13 @@ bool Graph::hasEdgeFromTo(const QString &sourceId, const QString &targetId) cons
 
 std::vector<Node *> Graph::nodes() const
 {
+    ensureOpen();
     return _nodes;
 }
 
 std::vector<Edge *> Graph::edges(const QString &id) const
 {
+    ensureOpen();
     if(id.isEmpty())
         return _edges;
     else
@@ -424,6 +466,7 @@ std::vector<Edge *> Graph::edges(const QString &id) const
 
 std::vector<Edge *> Graph::edgesFrom(const QString &id) const
 {
+    ensureOpen();
     std::vector<Edge *> result;
 
     if(node(id) != 0)
@@ -441,6 +484,7 @@ std::vector<Edge *> Graph::edgesFrom(const QString &id) const
 
 std::vector<Edge *> Graph::edgesTo(const QString &id) const
 {
+    ensureOpen();
     std::vector<Edge *> result;
 
     if(node(id) != 0)
@@ -458,6 +502,7 @@ std::vector<Edge *> Graph::edgesTo(const QString &id) const
 
 std::vector<Edge *> Graph::edgesFromTo(const QString &sourceId, const QString &targetId) const
 {
+    ensureOpen();
     std::vector<Edge *> result;
 
     if((node(sourceId) != 0) && (node(targetId) != 0))
@@ -476,6 +521,7 @@ std::vector<Edge *> Graph::edgesFromTo(const QString &sourceId, const QString &t
 
 QStringList Graph::nodeIdentifiers() const
 {
+    ensureOpen();
     QStringList result;
 
     for(nodeConstIter iter = _nodes.begin(); iter != _nodes.end(); ++iter)
@@ -489,6 +535,7 @@ QStringList Graph::nodeIdentifiers() const
 
 QStringList Graph::edgeIdentifiers() const
 {
+    ensureOpen();
     QStringList result;
 
     for(edgeConstIter iter = _edges.begin(); iter != _edges.end(); ++iter)
@@ -555,6 +602,7 @@ QString Graph::toString(int outputType, bool keepLayout)
 
 QString Graph::toGxl(bool keepLayout) const
 {
+    ensureOpen();
     QDomImplementation impl;
     QDomDocumentType gxlDoctype = impl.createDocumentType(
                 "gxl",
@@ -614,6 +662,7 @@ QString Graph::toGxl(bool keepLayout) const
 
 QString Graph::toDot(bool keepLayout) const
 {
+    ensureOpen();
     QString result = "digraph " + baseName() + " {";
     result += "\n    node [shape=ellipse];";
     if(keepLayout)
@@ -674,6 +723,7 @@ QString Graph::toDot(bool keepLayout) const
 
 QString Graph::toAlternative()
 {
+    ensureOpen();
     QString result = "[";
     // First add the canvas
     result += "<";
@@ -777,6 +827,7 @@ QString Graph::toAlternative()
 
 QString Graph::toLaTeX() const
 {
+    ensureOpen();
     QString result = "\\begin{tikzpicture}[every path/.style={>=latex}]\n";
 
     QRect rect = canvas();
@@ -841,6 +892,7 @@ QString Graph::toLaTeX() const
 
 void Graph::setCanvas(const QRect &rect)
 {
+    ensureOpen();
     _canvas = rect;
 }
 
@@ -1065,6 +1117,20 @@ bool Graph::openGraphT(const graph_t &inputGraph)
     return true;
 }
 
+void Graph::ensureOpen() const
+{
+    // Graphs constructed without being automatically initialised are read in
+    // the first time their contents are requested. Nothing has changed as far
+    // as anyone listening is concerned, so this goes without signals.
+    if(_opened)
+        return;
+
+    Graph *graph = const_cast<Graph *>(this);
+    bool blocked = graph->blockSignals(true);
+    graph->parse();
+    graph->blockSignals(blocked);
+}
+
 void Graph::trackChange()
 {
     _status = Modified;
@@ -33,6 +33,16 @@ public:
 
     bool open();
 
+    /*!
+     * \brief Test whether the graph file has been read in yet
+     *
+     * A graph constructed with autoInitialise set to false is not parsed until
+     * open() is called or its contents are first requested.
+     *
+     * \return True if the graph's nodes and edges are loaded, false otherwise
+     */
+    bool isOpened() const;
+
     QRect canvas() const;
     Node *node(const QString &id) const;
     Edge *edge(const QString &id) const;
@@ -102,12 +112,21 @@ protected slots:
 protected:
     // Protected member functions
     bool openGraphT(const graph_t &inputGraph);
+    /*!
+     * \brief Read the nodes and edges in from the file
+     *
+     * Unlike open() this leaves the file and its status alone and does not
+     * emit openComplete(), ensureOpen() uses it to read a graph on demand.
+     */
+    bool parse();
+    void ensureOpen() const;
 
     // Protected member variables
     int _nodeIdCounter;
     int _edgeIdCounter;
     QRect _canvas;
     bool _isRuleGraph;
+    bool _opened;
     std::vector<Node *> _nodes;
     std::vector<Edge *> _edges;
 
@@ -4,17 +4,16 @@
 #include "edgeitem.hpp"
 #include "edge.hpp"
 #include "editedgedialog.hpp"
+#include "renderstyle.hpp"
 
 #include "graph.hpp"
 
 #include <QApplication>
 #include <QPainter>
 #include <QStyleOptionGraphicsItem>
-#include <QSettings>
 #include <QGraphicsSceneMouseEvent>
 #include <QDebug>
 #include <QGraphicsScene>
-#include <QSettings>
 
 namespace Developer {
 
@@ -26,6 +25,9 @@ EdgeItem::EdgeItem(Edge *edge, NodeItem *edgeFrom, NodeItem *edgeTo, QGraphicsIt
     , _hover(false)
     , _mark(edge->mark())
     , _isBidirectional(edge->isBidirectional())
+    , _parallelSlot(0)
+    , _parallelCount(1)
+    , _oppositeEdge(false)
 {
     setZValue(EDGE_Z_VALUE);
 
@@ -35,6 +37,9 @@ EdgeItem::EdgeItem(Edge *edge, NodeItem *edgeFrom, NodeItem *edgeTo, QGraphicsIt
     setFrom(edgeFrom);
     setTo(edgeTo);
 
+    connect(RenderStyle::instance(), SIGNAL(changed()),
+            this, SLOT(nodeMoved()));
+
     nodeMoved();
 }
 
@@ -47,6 +52,9 @@ EdgeItem::EdgeItem(const QString &edgeId, NodeItem *edgeFrom, NodeItem *edgeTo,
     , _hover(false)
     , _mark(edgeMark)
     , _isBidirectional(isBidirectional)
+    , _parallelSlot(0)
+    , _parallelCount(1)
+    , _oppositeEdge(false)
 {
     setZValue(EDGE_Z_VALUE);
 
@@ -56,6 +64,9 @@ EdgeItem::EdgeItem(const QString &edgeId, NodeItem *edgeFrom, NodeItem *edgeTo,
     setFrom(edgeFrom);
     setTo(edgeTo);
 
+    connect(RenderStyle::instance(), SIGNAL(changed()),
+            this, SLOT(nodeMoved()));
+
     nodeMoved();
 }
 
@@ -102,32 +113,67 @@ void EdgeItem::setBidirectional(bool isBidirectional)
 
 void EdgeItem::setFrom(NodeItem *edgeFrom)
 {
-    // Assign the node this edge is from and ensure that it sends a signal to
-    // existing edges that they may need to recalculate
     _from = edgeFrom;
-    _from->addedEdge();
 
     // Ensure that this edge is notified of any changes which may affect this
     // edge's presentation
-    connect(_from, SIGNAL(edgeAdded()), this, SLOT(nodeMoved()));
-    connect(_from, SIGNAL(xChanged()), this, SLOT(nodeMoved()));
-    connect(_from, SIGNAL(yChanged()), this, SLOT(nodeMoved()));
+    connect(_from, SIGNAL(moved()), this, SLOT(nodeMoved()));
     connect(_from, SIGNAL(shapeChanged()), this, SLOT(nodeMoved()));
 }
 
 void EdgeItem::setTo(NodeItem *edgeTo)
 {
-    // Assign the node this edge is to and ensure that it sends a signal to
-    // existing edges that they may need to recalculate
     _to = edgeTo;
-    _to->addedEdge();
 
     // Ensure that this edge is notified of any changes which may affect this
-    // edge's presentation
-    connect(_to, SIGNAL(edgeAdded()), this, SLOT(nodeMoved()));
-    connect(_to, SIGNAL(xChanged()), this, SLOT(nodeMoved()));
-    connect(_to, SIGNAL(yChanged()), this, SLOT(nodeMoved()));
-    connect(_to, SIGNAL(shapeChanged()), this, SLOT(nodeMoved()));
+    // edge's presentation, only once if it is a loop
+    connect(_to, SIGNAL(moved()), this, SLOT(nodeMoved()),
+            Qt::UniqueConnection);
+    connect(_to, SIGNAL(shapeChanged()), this, SLOT(nodeMoved()),
+            Qt::UniqueConnection);
+}
+
+void EdgeItem::setEdge(Edge *edge, NodeItem *edgeFrom, NodeItem *edgeTo)
+{
+    Q_ASSERT(_from == 0 && _to == 0);
+
+    _edge = edge;
+    _id = edge->id();
+    _label = edge->label();
+    _mark = edge->mark();
+    _isBidirectional = edge->isBidirectional();
+    _hover = false;
+    _parallelSlot = 0;
+    _parallelCount = 1;
+    _oppositeEdge = false;
+    setItemState(edge->isPhantomEdge() ? GraphItem_Deleted : GraphItem_Normal);
+
+    setFrom(edgeFrom);
+    setTo(edgeTo);
+    nodeMoved();
+}
+
+void EdgeItem::detach()
+{
+    if(_from != 0)
+        disconnect(_from, 0, this, 0);
+    if(_to != 0)
+        disconnect(_to, 0, this, 0);
+
+    _from = 0;
+    _to = 0;
+}
+
+void EdgeItem::setParallel(int slot, int count, bool opposite)
+{
+    if(slot == _parallelSlot && count == _parallelCount
+            && opposite == _oppositeEdge)
+        return;
+
+    _parallelSlot = slot;
+    _parallelCount = count;
+    _oppositeEdge = opposite;
+    nodeMoved();
 }
 
 void EdgeItem::setLabel(const QString &itemLabel)
@@ -156,6 +202,10 @@ void EdgeItem::preserveEdge()
 
 QLineF EdgeItem::line() const
 {
+    // Both ends are kept until one of the nodes moves or changes shape
+    if(!_line.isNull())
+        return _line;
+
     QLineF initial = QLineF(_from->centerPos(), _to->centerPos());
     QList<QPointF> fromIntersection = _from->intersection(initial);
     QList<QPointF> toIntersection = _to->intersection(initial);
@@ -171,11 +221,9 @@ QPolygonF EdgeItem::polygon(double polygonWidth)
     if(_polygons.contains(polygonWidth))
         return _polygons[polygonWidth];
 
-    QSettings settings;
-    QFont font = settings.value("GraphView/Edges/Font", qApp->font()
-                                ).value<QFont>();
-    qreal arrowSize = settings.value("GraphView/Edges/ArrowSize", 9).toDouble();
-    QFontMetrics metrics(font);
+    const RenderStyle *style = RenderStyle::instance();
+    qreal arrowSize = style->edgeArrowSize();
+    const QFontMetrics &metrics = style->edgeMetrics();
 
     // Determine if path() is drawing a straight edge, a curved edge or an ellipse (loop edge)
     bool straightLine = false;
@@ -264,9 +312,14 @@ QPolygonF EdgeItem::edgePolygon(double padding)
 {
     // This method works exactly like the above one, except that the width of
     // the produced polygon is just sufficient to contain the arrow itself
-    QSettings settings;
-    qreal arrowSize = settings.value("GraphView/Edges/ArrowSize", 9).toDouble();
-    return polygon(arrowSize+(2*padding));
+    qreal width = RenderStyle::instance()->edgeArrowSize() + (2*padding);
+
+    // Hit tests ask for this on every mouse move, keep it until nodeMoved()
+    // clears the cached polygons
+    if(!_polygons.contains(width))
+        _polygons.insert(width, polygon(width));
+
+    return _polygons[width];
 }
 
 QRectF EdgeItem::boundingRect() const
@@ -287,14 +340,13 @@ QPainterPath EdgeItem::path()
     if(!_path.isEmpty())
         return _path;
 
-    QSettings settings;
-    qreal lineWidth = settings.value("GraphView/Edges/LineWidth", 1.5).toDouble();
+    qreal lineWidth = RenderStyle::instance()->edgeLineWidth();
 
     if(_from != _to)
     {
         QLineF edgeLine = line();
         // Is there an edge in the other direction?
-        bool oppositeEdge = _from->node()->parent()->hasEdgeFromTo(_to->id(), _from->id());
+        bool oppositeEdge = _oppositeEdge;
 
         // There is a loop in the other direction, curve this one to avoid
         // it - the other one should also curve producing a gap
@@ -310,29 +362,11 @@ QPainterPath EdgeItem::path()
         angle += 90; if(angle > 360) angle -= 360;
         opposingLine.setAngle(angle);
 
-        // Is there an edge in the same direction?
-        std::vector<Edge *> edges;
-
-        if(_to->node() == 0)
-            edges = std::vector<Edge *>();
-        else
-            edges = _edge->parent()->edgesFromTo(_from->id(), _to->id());   // obtain the parallel edges
-
+        // Edges in the same direction are spread out by their position among
+        // the parallel edges
         qreal positionIncrement = 0;
-        if (edges.size() >= 2)
-        {
-            // There are multiple edges in the same direction
-            for (std::vector<Edge *>::const_iterator it = edges.begin(); it != edges.end(); ++it)
-            {
-                Edge* otherEdge = *it;
-                if (otherEdge != _edge)
-                    // keep incrementing until we find this edge in the collection of parallel edges
-                    positionIncrement+=32;
-                else
-                    break;
-            }
-            //qDebug() << "  edgeitem.cpp: ("<< _edge->id() << ") Edge in the same direction detected, increment: " << positionIncrement;
-        }
+        if (_parallelCount >= 2)
+            positionIncrement = 32 * _parallelSlot;
 
         opposingLine.setLength(opposingLine.length() + positionIncrement);
 
@@ -362,33 +396,14 @@ QPainterPath EdgeItem::path()
         QPointF center = _from->centerPos();
 
 
-        // Is there an edge in the same direction?
-        std::vector<Edge *> edges;
-
-        if(_to->node() == 0)
-            edges = std::vector<Edge *>();
-        else
-            edges = _edge->parent()->edgesFromTo(_from->id(), _to->id());   // obtain the parallel edges
-
+        // Parallel loops are nested, tighter when there are more of them
         qreal positionIncrement = 0;
-        if (edges.size() >= 2)
+        if (_parallelCount >= 2)
         {
-            if (edges.size() > 10)
+            if (_parallelCount > 10)
                 qDebug() << "  Warning: Attempting to draw more than 10 parallel loops";
-            // There are multiple edges in the same direction
-            for (std::vector<Edge *>::const_iterator it = edges.begin(); it != edges.end(); ++it)
-            {
-                Edge* otherEdge = *it;
-                if (otherEdge != _edge)
-                    // keep incrementing until we find this edge in the collection of parallel edges
-                    if (edges.size() >= 4)
-                        positionIncrement+=8;
-                    else
-                        positionIncrement+=10;
-                else
-                    break;
-            }
-            // qDebug() << "  edgeitem.cpp: ("<< _edge->id() << ") Loop in the same direction detected, increment: " << positionIncrement;
+            positionIncrement = _parallelSlot
+                    * ((_parallelCount >= 4) ? 8 : 10);
         }
 
         // Move the ellipse center up by it's 2nd radius units
@@ -453,8 +468,7 @@ QPainterPath EdgeItem::arrowHead(qreal adjustment) const
     if(_arrowHeads.contains(adjustment))
         return _arrowHeads[adjustment];
 
-    QSettings settings;
-    qreal arrowSize = settings.value("GraphView/Edges/ArrowSize", 9).toDouble();
+    qreal arrowSize = RenderStyle::instance()->edgeArrowSize();
 
     QLineF drawLine(_path.pointAtPercent(.95 + adjustment),
                     _path.pointAtPercent(1.0 + adjustment));
@@ -503,45 +517,18 @@ void EdgeItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
 {
     Q_UNUSED(widget)
 
-    QSettings settings;
-    QFont font = settings.value("GraphView/Edges/Font", qApp->font()
-                                ).value<QFont>();
-    qreal lineWidth = settings.value("GraphView/Edges/LineWidth", 1.5).toDouble();
-    QFontMetrics metrics(font);
-    QColor textColour = settings.value("GraphView/Edges/TextColour",
-                                       QColor(0x33, 0x33, 0x33)).value<QColor>();
+    const RenderStyle *style = RenderStyle::instance();
+    QFont font = style->edgeFont();
+    qreal lineWidth = style->edgeLineWidth();
+    QColor textColour = style->edgeTextColour();
     QColor lineColour;
     if(option->state & QStyle::State_Selected)
     {
-        lineColour  = settings.value("GraphView/Edges/SelectedColour",
-                                     QColor(0xcc,0xcc,0x33)).value<QColor>();
+        lineColour = style->edgeSelectedColour();
     }
     else
     {
-        // default
-        lineColour = settings.value("GraphView/Edges/Background",
-                             QColor(0x11,0x11,0x11) // black
-                             ).value<QColor>();
-
-        if (_mark == "red")
-            lineColour = settings.value("GraphView/Edges/ColourRed",
-                                 QColor(0xee,0x77,0x77) // light red
-                                 ).value<QColor>();
-
-        if (_mark == "green")
-            lineColour = settings.value("GraphView/Edges/ColourGreen",
-                                 QColor(0x60,0xcb,0x60) // green
-                                 ).value<QColor>();
-
-        if (_mark == "blue")
-            lineColour = settings.value("GraphView/Edges/ColourBlue",
-                                 QColor(0x22,0x70,0xee) // blue
-                                 ).value<QColor>();
-
-        if (_mark == "any")
-            lineColour = settings.value("GraphView/Edges/ColourAny",
-                                 QColor(0xee,0x82,0xee) // purple-ish
-                                 ).value<QColor>();
+        lineColour = style->edgeColour(_mark);
 
         if (_hover)
         {
@@ -549,6 +536,20 @@ void EdgeItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
         }
     }
 
+    qreal detail = option->levelOfDetailFromTransform(painter->worldTransform());
+    if(detail < style->outlineDetail())
+    {
+        // A loop is lost inside its node at this scale, anything else is
+        // drawn as a hairline between the ends of its curve
+        if(_from == _to || _path.isEmpty())
+            return;
+
+        painter->setRenderHint(QPainter::Antialiasing, false);
+        painter->setPen(QPen(lineColour, 0));
+        painter->drawLine(QPointF(_path.elementAt(0)), _path.currentPosition());
+        return;
+    }
+
     if(SHOW_VISUALISATION_DEBUG)
     {
         painter->setPen(DEBUG_COLOUR);
@@ -572,8 +573,8 @@ void EdgeItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
     painter->drawPath(painterPath);
 
     // Draw the pointer on the end
-    // ONLY IF EDGE IS NOT BIDIRECTIONAL
-    if (!_isBidirectional)
+    // ONLY IF EDGE IS NOT BIDIRECTIONAL, and only while it can be made out
+    if (!_isBidirectional && detail >= style->arrowDetail())
     {
         QPainterPath arrowPath;
         if(_from == _to)
@@ -585,6 +586,9 @@ void EdgeItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
     }
 
 
+    if(detail < style->textDetail())
+        return;
+
     // Now draw the label
     painter->setPen(textColour);
     QPointF midPoint = painterPath.pointAtPercent(.5);
@@ -593,8 +597,13 @@ void EdgeItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
     if(angle > 90 && angle < 270) { angle -= 180; }
     if(angle < 0) angle += 360;
     painter->rotate(-angle);
-    qreal xOffset = metrics.width(label())/2;
-    painter->drawText(QPointF(-xOffset,-3), label());
+    // Laid out once per font and text, and shared between items
+    TextCache::Entry labelText = RenderStyle::instance()->textCache()->entry(
+                font, label());
+    qreal xOffset = labelText.width/2;
+    // The label's baseline sits just above the line
+    painter->drawStaticText(QPointF(-xOffset, -3 - labelText.ascent),
+                            labelText.text);
 
     // Draw the edge ID
     /*
@@ -609,8 +618,15 @@ void EdgeItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
 
 void EdgeItem::nodeMoved()
 {
-    QSettings settings;
-    qreal arrowSize = settings.value("GraphView/Edges/ArrowSize", 9).toDouble();
+    // A detached edge waiting to be reused has nothing to follow
+    if(_from == 0 || _to == 0)
+        return;
+
+    qreal arrowSize = RenderStyle::instance()->edgeArrowSize();
+    // The bounding rectangle is about to change, the scene's index must know
+    prepareGeometryChange();
+    _line = QLineF();
+    _line = line();
     _path = QPainterPath();
     _path = path();
     _arrowHeads.clear();
@@ -630,17 +646,15 @@ void EdgeItem::hoverEnterEvent(QGraphicsSceneHoverEvent *event)
     if(edgePolygon().containsPoint(event->scenePos(), Qt::OddEvenFill))
     {
         event->accept();
-        _hover = true;
+        setHover(true);
         //qDebug() << "  edgeitem.cpp: Edge "<<_id << " has hover focus (1)";
     }
     else
     {
         event->ignore();
-        _hover = false;
+        setHover(false);
         //qDebug() << "  edgeitem.cpp: Edge "<<_id << " has LOST hover focus (2)";
     }
-
-    update();
 }
 
 void EdgeItem::hoverMoveEvent(QGraphicsSceneHoverEvent *event)
@@ -648,23 +662,29 @@ void EdgeItem::hoverMoveEvent(QGraphicsSceneHoverEvent *event)
     if(edgePolygon().containsPoint(event->scenePos(), Qt::OddEvenFill))
     {
         event->accept();
-        _hover = true;
+        setHover(true);
         //qDebug() << "  edgeitem.cpp: Edge "<<_id << " has hover focus (2)";
     }
     else
     {
         event->ignore();
-        _hover = false;
+        setHover(false);
     }
-
-    update();
 }
 
 void EdgeItem::hoverLeaveEvent(QGraphicsSceneHoverEvent *event)
 {
     Q_UNUSED(event)
-    _hover = false;
+    setHover(false);
+}
+
+void EdgeItem::setHover(bool hover)
+{
+    // Hover moves arrive constantly, most of them change nothing
+    if(hover == _hover)
+        return;
 
+    _hover = hover;
     update();
 }
 
@@ -36,6 +36,28 @@ public:
     void setMark(const QString &mark);
     void setBidirectional(bool isBidirectional);
 
+    /*!
+     * \brief Set where this edge sits among the edges joining its two nodes
+     *
+     * Kept up to date by GraphScene, which indexes the edges between each pair
+     * of nodes, so that drawing an edge does not search the whole graph.
+     *
+     * \param slot      Position of this edge among those in its direction
+     * \param count     Number of edges in the same direction, this one included
+     * \param opposite  True if an edge runs in the other direction
+     */
+    void setParallel(int slot, int count, bool opposite);
+
+    /*!
+     * \brief Show a different edge with this item
+     *
+     * Lets GraphScene reuse items rather than create new ones. The item must
+     * have been detached first.
+     */
+    void setEdge(Edge *edge, NodeItem *edgeFrom, NodeItem *edgeTo);
+    //! Stop following the nodes at either end, which may then be deleted
+    void detach();
+
     void preserveEdge();
     void deleteEdge();
 
@@ -68,8 +90,11 @@ protected:
     void mouseReleaseEvent(QGraphicsSceneMouseEvent *event);
 
 private:
+    void setHover(bool hover);
+
     Edge *_edge;
     QRectF _boundingRect;
+    QLineF _line;
     QMap<qreal, QPolygonF> _polygons;
     QPainterPath _shape;
     QPainterPath _path;
@@ -80,6 +105,9 @@ private:
     QString _mark;
     bool _hover;
     QPoint _controlPoint;   // used when drawing non-loop edges
+    int _parallelSlot;
+    int _parallelCount;
+    bool _oppositeEdge;
 };
 
 }
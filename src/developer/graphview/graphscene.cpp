@@ -2,25 +2,13 @@
  * \file
  */
 #include "graphscene.hpp"
-
-#include <ogdf/basic/basic.h>
-#include <ogdf/tree/TreeLayout.h>
-#include <ogdf/layered/SugiyamaLayout.h>
-#include <ogdf/tree/RadialTreeLayout.h>
-#include <ogdf/planarlayout/FPPLayout.h>
-#include <ogdf/planarlayout/PlanarDrawLayout.h>
-#include <ogdf/planarlayout/PlanarStraightLayout.h>
-#include <ogdf/planarlayout/SchnyderLayout.h>
-#include <ogdf/planarity/PlanarizationGridLayout.h>
-#include <ogdf/layered/FastHierarchyLayout.h>
-#include <ogdf/misclayout/CircularLayout.h>
-#include <ogdf/energybased/SpringEmbedderFR.h>
-#include <ogdf/energybased/DavidsonHarelLayout.h>
-#include <ogdf/energybased/FMMMLayout.h>
-#include <ogdf/energybased/GEMLayout.h>
+#include "renderstyle.hpp"
 
 #include <QGraphicsSceneMouseEvent>
+#include <QGraphicsView>
 #include <QKeyEvent>
+#include <QTimer>
+#include <QTimeLine>
 #include <QDebug>
 
 #include <QPainter>
@@ -28,8 +16,6 @@
 
 namespace Developer {
 
-using ogdf::GraphAttributes;
-
 GraphScene::GraphScene(QObject *parent)
     : QGraphicsScene(parent)
     , _linkedGraph(0)
@@ -37,12 +23,54 @@ GraphScene::GraphScene(QObject *parent)
     , _internalGraph(true)
     , _drawingEdge(false)
     , _selecting(false)
+    , _movingItems(false)
+    , _indexMode(Index_Automatic)
+    , _bulkUpdates(0)
+    , _virtualMode(Virtual_Automatic)
+    , _virtualized(false)
+    , _virtualUpdatePending(false)
+    , _layoutJob(0)
 {
+    QSettings settings;
+    _indexThreshold = settings.value("GraphView/IndexThreshold", 2000).toInt();
+    _virtualThreshold = settings.value("GraphView/Virtual/Threshold", 100000
+                                       ).toInt();
+    _virtualItemLimit = settings.value("GraphView/Virtual/ItemLimit", 5000
+                                       ).toInt();
+    // Fraction of the view's size by which items extend past each side of it
+    _virtualMargin = settings.value("GraphView/Virtual/Margin", 0.5
+                                    ).toDouble();
+    _animateLayouts = settings.value("GraphView/Layout/Animate", true).toBool();
+    // Moving more nodes than this every frame would not look smooth
+    _animationLimit = settings.value("GraphView/Layout/AnimationLimit", 1000
+                                     ).toInt();
+
+    _layoutTimeLine = new QTimeLine(
+                settings.value("GraphView/Layout/AnimationDuration", 400
+                               ).toInt(), this);
+    _layoutTimeLine->setCurveShape(QTimeLine::EaseInOutCurve);
+    connect(_layoutTimeLine, SIGNAL(valueChanged(qreal)),
+            this, SLOT(animateLayout(qreal)));
+    connect(_layoutTimeLine, SIGNAL(finished()),
+            this, SLOT(layoutAnimationFinished()));
+
     _graph = new Graph();
     setItemIndexMethod(QGraphicsScene::NoIndex);
     setBackgroundBrush(QColor(Qt::white));
 }
 
+GraphScene::~GraphScene()
+{
+    // A layout still running deletes itself once it is done
+    if(_layoutJob != 0)
+        _layoutJob->cancel();
+
+    // Items in the scene are deleted by QGraphicsScene, the spares are not in
+    // it
+    qDeleteAll(_spareNodes);
+    qDeleteAll(_spareEdges);
+}
+
 Graph *GraphScene::graph() const
 {
     return _graph;
@@ -50,10 +78,21 @@ Graph *GraphScene::graph() const
 
 void GraphScene::setGraph(Graph *newGraph)
 {
+    // A layout of the old graph has nothing to apply to
+    cancelLayout();
+    stopLayoutAnimation();
+    // The items being dragged are about to go
+    endMovingItems();
+
+    beginBulkUpdate();
+
     // Remove child items from the scene
     qDeleteAll(items());
     _nodes.clear();
     _edges.clear();
+    _edgeGroups.clear();
+    _unplacedNodes.clear();
+    clearVirtualGraph();
 
     // Only delete if this is an internal graph being replaced
     if(_internalGraph)
@@ -72,6 +111,14 @@ void GraphScene::setGraph(Graph *newGraph)
         setSceneRect(canvas);
     }
 
+    _virtualized = shouldVirtualize();
+    if(_virtualized)
+    {
+        setVirtualGraph();
+        endBulkUpdate();
+        return;
+    }
+
     bool layoutSet = false;
     std::vector<Node *> nList = _graph->nodes();
     for(std::vector<Node *>::iterator iter = nList.begin(); iter != nList.end();
@@ -102,8 +149,10 @@ void GraphScene::setGraph(Graph *newGraph)
             }
         }
 
-        if(!layoutSet)
-            layoutSet = (nodeItem->pos().x() != 0 || nodeItem->pos().y() != 0);
+        if(nodeItem->pos().x() != 0 || nodeItem->pos().y() != 0)
+            layoutSet = true;
+        else
+            _unplacedNodes.insert(n);
     }
 
     // If we have a linked graph, check for unrepresented nodes which should be
@@ -141,8 +190,10 @@ void GraphScene::setGraph(Graph *newGraph)
             nodeItem->setItemState(GraphItem::GraphItem_Deleted);
             addNodeItem(nodeItem, n->pos());
 
-            if(!layoutSet)
-                layoutSet = (nodeItem->pos().x() != 0 || nodeItem->pos().y() != 0);
+            if(nodeItem->pos().x() != 0 || nodeItem->pos().y() != 0)
+                layoutSet = true;
+            else
+                _unplacedNodes.insert(n);
         }
     }
 
@@ -249,11 +300,13 @@ void GraphScene::setGraph(Graph *newGraph)
     }
 
     if(!layoutSet)
-        layoutCircular();
+        layoutNow(LayoutJob::Algorithm_Circular);
 
     resizeToContents();
 
     _readOnly = (_graph->status() == GPFile::ReadOnly);
+
+    endBulkUpdate();
 }
 
 Graph *GraphScene::linkedGraph() const
@@ -308,7 +361,7 @@ bool GraphScene::readOnly() const
 
 void GraphScene::setReadOnly(bool readOnlyFlag)
 {
-    _readOnly = readOnlyFlag;
+    _readOnly = readOnlyFlag || _virtualized;
 }
 
 void GraphScene::addNodeItem(NodeItem *nodeItem, const QPointF &position)
@@ -316,6 +369,7 @@ void GraphScene::addNodeItem(NodeItem *nodeItem, const QPointF &position)
     addItem(nodeItem);
     nodeItem->setPos(position);
     _nodes.insert(nodeItem->id(), nodeItem);
+    updateIndexMethod();
     emit nodeAdded(nodeItem);
 }
 
@@ -323,241 +377,1066 @@ void GraphScene::addEdgeItem(EdgeItem *edgeItem)
 {
     addItem(edgeItem);
     _edges.insert(edgeItem->id(), edgeItem);
+    addToEdgeGroup(edgeItem);
+    updateIndexMethod();
     emit edgeAdded(edgeItem);
 }
 
-void GraphScene::layoutInit()
+GraphScene::NodePair GraphScene::edgeGroupKey(EdgeItem *edgeItem)
 {
-    _g = ogdf::Graph();
-    _ga = GraphAttributes(_g, GraphAttributes::nodeGraphics
-                       | GraphAttributes::edgeGraphics
-                       | GraphAttributes::nodeLabel
-                       | GraphAttributes::edgeLabel);
+    NodeItem *from = edgeItem->from();
+    NodeItem *to = edgeItem->to();
+    return (from < to) ? NodePair(from, to) : NodePair(to, from);
+}
 
-    _nodeMap.clear();
+void GraphScene::addToEdgeGroup(EdgeItem *edgeItem)
+{
+    NodePair key = edgeGroupKey(edgeItem);
+    _edgeGroups[key].append(edgeItem);
+    updateEdgeGroup(key);
+}
+
+void GraphScene::removeFromEdgeGroup(EdgeItem *edgeItem)
+{
+    NodePair key = edgeGroupKey(edgeItem);
+    QHash<NodePair, QList<EdgeItem *> >::iterator group = _edgeGroups.find(key);
+    if(group == _edgeGroups.end())
+        return;
+
+    group->removeAll(edgeItem);
+    if(group->isEmpty())
+        _edgeGroups.erase(group);
+    else
+        updateEdgeGroup(key);
+}
 
-    for(nodeIter iter = _nodes.begin(); iter != _nodes.end(); ++iter)
+void GraphScene::updateEdgeGroup(const NodePair &key)
+{
+    const QList<EdgeItem *> group = _edgeGroups.value(key);
+
+    // Edges are numbered within their direction in the order they were added,
+    // which for a loaded graph is the order of the graph file
+    int forward = 0;
+    int backward = 0;
+    for(int i = 0; i < group.count(); ++i)
     {
-        NodeItem *node = *iter;
-        ogdf::node ogdfNode = _g.newNode();
-        _ga.x(ogdfNode) = node->pos().x();
-        _ga.y(ogdfNode) = node->pos().y();
-        _ga.labelNode(ogdfNode) = ogdf::String(node->label().toStdString().c_str());
-        _ga.width(ogdfNode) = node->shape().boundingRect().width();
-        _ga.height(ogdfNode) = node->shape().boundingRect().height();
-        _nodeMap.insert(node->id(), ogdfNode);
+        if(group.at(i)->from() == key.first)
+            ++forward;
+        else
+            ++backward;
     }
 
-    for(edgeIter iter = _edges.begin(); iter != _edges.end(); ++iter)
+    int forwardSlot = 0;
+    int backwardSlot = 0;
+    bool loop = (key.first == key.second);
+    for(int i = 0; i < group.count(); ++i)
     {
-        EdgeItem *edge = *iter;
-        Q_ASSERT(_nodeMap.contains(edge->from()->id()));
-        Q_ASSERT(_nodeMap.contains(edge->to()->id()));
-        ogdf::edge ogdfEdge = _g.newEdge(
-                    _nodeMap[edge->from()->id()],
-                    _nodeMap[edge->to()->id()]
-                );
-        _ga.labelEdge(ogdfEdge) = ogdf::String(edge->label().toStdString().c_str());
+        EdgeItem *edgeItem = group.at(i);
+        if(edgeItem->from() == key.first)
+            edgeItem->setParallel(forwardSlot++, forward,
+                                  !loop && backward > 0);
+        else
+            edgeItem->setParallel(backwardSlot++, backward, forward > 0);
     }
 }
 
-void GraphScene::layoutTree(LayoutDirections direction)
+GraphScene::IndexMode GraphScene::indexMode() const
 {
-    layoutInit();
+    return _indexMode;
+}
 
-    ogdf::TreeLayout tree;
-    tree.siblingDistance(40.0);
-    tree.subtreeDistance(30.0);
-    tree.levelDistance(60.0);
-    tree.treeDistance(60.0);
+void GraphScene::setIndexMode(IndexMode mode)
+{
+    _indexMode = mode;
+    updateIndexMethod();
+}
+
+int GraphScene::indexThreshold() const
+{
+    return _indexThreshold;
+}
 
-    switch(direction)
+void GraphScene::setIndexThreshold(int items)
+{
+    _indexThreshold = qMax(items, 0);
+    updateIndexMethod();
+}
+
+bool GraphScene::isIndexed() const
+{
+    return itemIndexMethod() == QGraphicsScene::BspTreeIndex;
+}
+
+void GraphScene::beginBulkUpdate()
+{
+    ++_bulkUpdates;
+    updateIndexMethod();
+}
+
+void GraphScene::endBulkUpdate()
+{
+    if(_bulkUpdates == 0)
     {
-    case Layout_RightToLeft:
-        tree.orientation(ogdf::rightToLeft);
-        break;
-    case Layout_BottomToTop:
-        tree.orientation(ogdf::bottomToTop);
-        break;
-    case Layout_LeftToRight:
-        tree.orientation(ogdf::leftToRight);
-        break;
-    case Layout_TopToBottom:
-    default:
-        tree.orientation(ogdf::topToBottom);
-        break;
+        qDebug() << "GraphScene::endBulkUpdate() called without a matching "
+                 << "beginBulkUpdate(), ignoring";
+        return;
     }
 
-    tree.call(_ga);
+    --_bulkUpdates;
+    updateIndexMethod();
+}
 
-    layoutApply();
+void GraphScene::updateIndexMethod()
+{
+    bool indexed = false;
+    if(_bulkUpdates == 0)
+    {
+        switch(_indexMode)
+        {
+        case Index_Bsp:
+            indexed = true;
+            break;
+        case Index_Automatic:
+            indexed = (_nodes.count() + _edges.count()) >= _indexThreshold;
+            break;
+        case Index_None:
+        default:
+            break;
+        }
+    }
+
+    if(indexed == isIndexed())
+        return;
+
+    if(indexed)
+    {
+        // A depth of 0 lets Qt choose one to suit the number of items
+        setBspTreeDepth(0);
+        setItemIndexMethod(QGraphicsScene::BspTreeIndex);
+    }
+    else
+        setItemIndexMethod(QGraphicsScene::NoIndex);
 }
 
-void GraphScene::layoutSugiyama()
+GraphScene::VirtualMode GraphScene::virtualMode() const
 {
-    layoutInit();
+    return _virtualMode;
+}
 
-    ogdf::SugiyamaLayout sugiyama;
+void GraphScene::setVirtualMode(VirtualMode mode)
+{
+    _virtualMode = mode;
+}
 
-    ogdf::FastHierarchyLayout *fhl = new ogdf::FastHierarchyLayout;
-    fhl->layerDistance(45.0);
-    fhl->nodeDistance(30.0);
-    sugiyama.setLayout(fhl);
+int GraphScene::virtualThreshold() const
+{
+    return _virtualThreshold;
+}
 
-    sugiyama.call(_ga);
+void GraphScene::setVirtualThreshold(int elements)
+{
+    _virtualThreshold = qMax(elements, 0);
+}
 
-    layoutApply();
+int GraphScene::virtualItemLimit() const
+{
+    return _virtualItemLimit;
 }
 
-void GraphScene::layoutRadialTree()
+void GraphScene::setVirtualItemLimit(int items)
 {
-    layoutInit();
+    _virtualItemLimit = qMax(items, 0);
+    viewportChanged();
+}
 
-    ogdf::RadialTreeLayout radialTree;
-    radialTree.levelDistance(60.0);
-    radialTree.connectedComponentDistance(60.0);
+bool GraphScene::isVirtualized() const
+{
+    return _virtualized;
+}
 
-    radialTree.call(_ga);
+bool GraphScene::shouldVirtualize() const
+{
+    // The comparison with a linked graph needs an item for every element
+    if(_linkedGraph != 0)
+        return false;
 
-    layoutApply();
+    switch(_virtualMode)
+    {
+    case Virtual_Always:
+        return true;
+    case Virtual_Never:
+        return false;
+    case Virtual_Automatic:
+    default:
+        return (_graph->nodes().size() + _graph->edges().size())
+                >= static_cast<size_t>(_virtualThreshold);
+    }
 }
 
-void GraphScene::layoutFPP()
+void GraphScene::setVirtualGraph()
 {
-    layoutInit();
+    // Editing would change the model behind the grids' backs
+    _readOnly = true;
 
-    ogdf::FPPLayout fpp;
+    bool layoutSet = false;
+    std::vector<Node *> nList = _graph->nodes();
+    for(std::vector<Node *>::iterator iter = nList.begin();
+        iter != nList.end(); ++iter)
+    {
+        Node *n = *iter;
+        if(n->pos().x() != 0 || n->pos().y() != 0)
+            layoutSet = true;
+        else
+            _unplacedNodes.insert(n);
+    }
 
-    fpp.call(_ga);
+    buildVirtualGraph();
+
+    if(!layoutSet)
+        layoutNow(LayoutJob::Algorithm_Circular);
 
-    layoutApply();
+    resizeToContents();
+    viewportChanged();
 }
 
-void GraphScene::layoutPlanarDraw()
+void GraphScene::buildVirtualGraph()
 {
-    layoutInit();
+    // Items are positioned from the grids, so give them all up first
+    QList<int> materialised = _materialisedEdges.toList();
+    for(QList<int>::iterator iter = materialised.begin();
+        iter != materialised.end(); ++iter)
+        releaseEdge(*iter);
+    materialised = _materialisedNodes.toList();
+    for(QList<int>::iterator iter = materialised.begin();
+        iter != materialised.end(); ++iter)
+        releaseNode(*iter);
 
-    ogdf::PlanarDrawLayout planarDraw;
+    std::vector<Node *> nList = _graph->nodes();
+    std::vector<Edge *> eList = _graph->edges();
+
+    _virtualNodes.clear();
+    _virtualNodeIndex.clear();
+    _virtualEdges.clear();
+    _virtualEdgeEnds.clear();
+    _virtualEdgeIndex.clear();
+    _nodeGrid.clear();
+    _edgeGrid.clear();
+
+    _virtualNodes.reserve(nList.size());
+    _virtualNodeIndex.reserve(nList.size());
+    for(std::vector<Node *>::iterator iter = nList.begin(); iter != nList.end();
+        ++iter)
+    {
+        Node *n = *iter;
+        int index = _virtualNodes.count();
+        _virtualNodes.append(n);
+        _virtualNodeIndex.insert(n->id(), index);
+        _nodeGrid.insert(index, virtualNodeRect(n));
+    }
+
+    _virtualEdges.reserve(eList.size());
+    _virtualEdgeEnds.reserve(eList.size());
+    _virtualEdgeIndex.reserve(eList.size());
+    for(std::vector<Edge *>::iterator iter = eList.begin(); iter != eList.end();
+        ++iter)
+    {
+        Edge *e = *iter;
+        int from = _virtualNodeIndex.value(e->from()->id(), -1);
+        int to = _virtualNodeIndex.value(e->to()->id(), -1);
+        if(from < 0 || to < 0)
+        {
+            qDebug() << "Edge missing node, ignoring: " << e->id();
+            continue;
+        }
 
-    planarDraw.call(_ga);
+        int index = _virtualEdges.count();
+        _virtualEdges.append(e);
+        _virtualEdgeEnds.append(QPair<int, int>(from, to));
+        _virtualEdgeIndex.insert(e, index);
+        _edgeGrid.insert(index, virtualEdgeRect(index));
+    }
 
-    layoutApply();
+    _nodeItems = QVector<NodeItem *>(_virtualNodes.count(), 0);
+    _edgeItems = QVector<EdgeItem *>(_virtualEdges.count(), 0);
 }
 
-void GraphScene::layoutPlanarStraight()
+void GraphScene::clearVirtualGraph()
 {
-    layoutInit();
+    // Only called once the items themselves have been deleted
+    _virtualized = false;
+    _virtualNodes.clear();
+    _virtualNodeIndex.clear();
+    _virtualEdges.clear();
+    _virtualEdgeEnds.clear();
+    _virtualEdgeIndex.clear();
+    _nodeGrid.clear();
+    _edgeGrid.clear();
+    _nodeItems.clear();
+    _edgeItems.clear();
+    _materialisedNodes.clear();
+    _materialisedEdges.clear();
+
+    qDeleteAll(_spareNodes);
+    _spareNodes.clear();
+    qDeleteAll(_spareEdges);
+    _spareEdges.clear();
+}
 
-    ogdf::PlanarStraightLayout planarStraight;
+QRectF GraphScene::virtualNodeRect(Node *node) const
+{
+    return NodeItem::boundingRectFor(node->label(), node->isRoot()).translated(
+                node->pos());
+}
 
-    planarStraight.call(_ga);
+QRectF GraphScene::virtualEdgeRect(int index) const
+{
+    const QPair<int, int> &ends = _virtualEdgeEnds.at(index);
+    QRectF rect = _nodeGrid.rect(ends.first).united(
+                _nodeGrid.rect(ends.second));
 
-    layoutApply();
+    // Leave room for parallel edges curving away from the line between the
+    // nodes, and for loops, which rise above their node
+    return rect.adjusted(-40, -40, 40, 40);
 }
 
-void GraphScene::layoutSchnyder()
+QPointF GraphScene::virtualNodeCenter(int index) const
 {
-    layoutInit();
+    NodeItem *nodeItem = _nodeItems.at(index);
+    if(nodeItem != 0)
+        return nodeItem->centerPos();
+
+    // The ID at the bottom of the bounding rectangle is not part of the shape
+    QRectF rect = _nodeGrid.rect(index);
+    qreal idHeight = 1 + RenderStyle::instance()->nodeMetrics().height() + 1;
+    return QPointF(rect.center().x(),
+                   rect.top() + (rect.height() - idHeight)/2);
+}
 
-    ogdf::SchnyderLayout schnyder;
+void GraphScene::syncVirtualNode(int index)
+{
+    // A node's item may have moved it, or its label may have been edited
+    Node *node = _virtualNodes.at(index);
+    QRectF rect = virtualNodeRect(node);
+    if(rect == _nodeGrid.rect(index))
+        return;
 
-    schnyder.call(_ga);
+    _nodeGrid.move(index, rect);
 
-    layoutApply();
+    std::vector<Edge *> edges = node->edges();
+    for(std::vector<Edge *>::iterator iter = edges.begin();
+        iter != edges.end(); ++iter)
+    {
+        int edgeIndex = _virtualEdgeIndex.value(*iter, -1);
+        if(edgeIndex >= 0)
+            _edgeGrid.move(edgeIndex, virtualEdgeRect(edgeIndex));
+    }
 }
 
-void GraphScene::layoutPlanarizationGrid()
+void GraphScene::materialiseNode(int index)
+{
+    Node *node = _virtualNodes.at(index);
+
+    NodeItem *nodeItem;
+    if(_spareNodes.isEmpty())
+        nodeItem = new NodeItem(node);
+    else
+    {
+        nodeItem = _spareNodes.takeLast();
+        nodeItem->setNode(node);
+    }
+
+    _nodeItems[index] = nodeItem;
+    _materialisedNodes.insert(index);
+    addNodeItem(nodeItem, node->pos());
+}
+
+void GraphScene::materialiseEdge(int index)
 {
-    layoutInit();
+    const QPair<int, int> &ends = _virtualEdgeEnds.at(index);
+    NodeItem *from = _nodeItems.at(ends.first);
+    NodeItem *to = _nodeItems.at(ends.second);
+    if(from == 0 || to == 0)
+    {
+        qDebug() << "GraphScene::materialiseEdge() called before the edge's "
+                 << "nodes were materialised, ignoring";
+        return;
+    }
 
-    ogdf::PlanarizationGridLayout planarGrid;
-    planarGrid.separation(50.0);
+    Edge *edge = _virtualEdges.at(index);
 
-    planarGrid.call(_ga);
+    EdgeItem *edgeItem;
+    if(_spareEdges.isEmpty())
+        edgeItem = new EdgeItem(edge, from, to);
+    else
+    {
+        edgeItem = _spareEdges.takeLast();
+        edgeItem->setEdge(edge, from, to);
+    }
 
-    layoutApply();
+    _edgeItems[index] = edgeItem;
+    _materialisedEdges.insert(index);
+    addEdgeItem(edgeItem);
 }
 
-void GraphScene::layoutCircular()
+void GraphScene::releaseNode(int index)
 {
-    layoutInit();
+    NodeItem *nodeItem = _nodeItems.at(index);
+    if(nodeItem == 0)
+        return;
 
-    ogdf::CircularLayout circular;
-    circular.minDistCircle(50.0);
-    circular.minDistLevel(50.0);
-    circular.minDistSibling(35.0);
-    circular.minDistCC(50.0);
+    _nodeItems[index] = 0;
+    _materialisedNodes.remove(index);
 
-    circular.call(_ga);
+    nodeItem->setSelected(false);
+    removeItem(nodeItem);
+    _nodes.remove(nodeItem->id());
+    syncVirtualNode(index);
 
-    layoutApply();
+    if(_spareNodes.count() < _virtualItemLimit)
+        _spareNodes.append(nodeItem);
+    else
+        delete nodeItem;
 }
 
-void GraphScene::layoutSpring()
+void GraphScene::releaseEdge(int index)
 {
-    layoutInit();
+    EdgeItem *edgeItem = _edgeItems.at(index);
+    if(edgeItem == 0)
+        return;
 
-    ogdf::SpringEmbedderFR spring;
-    spring.minDistCC(40.0);
-    spring.scaleFunctionFactor(5.0);
+    _edgeItems[index] = 0;
+    _materialisedEdges.remove(index);
 
-    spring.call(_ga);
+    edgeItem->setSelected(false);
+    removeItem(edgeItem);
+    _edges.remove(edgeItem->id());
+    removeFromEdgeGroup(edgeItem);
+    edgeItem->detach();
 
-    layoutApply();
+    if(_spareEdges.count() < _virtualItemLimit)
+        _spareEdges.append(edgeItem);
+    else
+        delete edgeItem;
 }
 
-void GraphScene::layoutDavidsonHarel()
+void GraphScene::viewportChanged()
 {
-    layoutInit();
+    if(!_virtualized || _virtualUpdatePending)
+        return;
 
-    ogdf::DavidsonHarelLayout dh;
+    _virtualUpdatePending = true;
+    QTimer::singleShot(0, this, SLOT(updateVirtualItems()));
+}
 
-    dh.call(_ga);
+void GraphScene::updateVirtualItems()
+{
+    _virtualUpdatePending = false;
+
+    // Items being dragged must not be taken away, try again once they stop
+    if(!_virtualized || _movingItems)
+        return;
 
-    layoutApply();
+    QRectF visible;
+    QList<QGraphicsView *> viewList = views();
+    for(QList<QGraphicsView *>::iterator iter = viewList.begin();
+        iter != viewList.end(); ++iter)
+    {
+        QGraphicsView *view = *iter;
+        QRectF viewRect = view->mapToScene(view->viewport()->rect()
+                                           ).boundingRect();
+        visible = visible.isNull() ? viewRect : visible.united(viewRect);
+    }
+
+    if(visible.isNull())
+        return;
+
+    // Extend past the views so that short pans find their items ready
+    qreal dx = visible.width() * _virtualMargin;
+    qreal dy = visible.height() * _virtualMargin;
+    QRectF area = visible.adjusted(-dx, -dy, dx, dy);
+
+    QVector<int> nodes = _nodeGrid.query(area);
+    QVector<int> edges = _edgeGrid.query(area);
+
+    // With more than the limit in the area the background draws everything,
+    // and no items are wanted at all
+    QSet<int> wantedNodes;
+    QSet<int> wantedEdges;
+    if(nodes.count() + edges.count() <= _virtualItemLimit)
+    {
+        for(int i = 0; i < nodes.count(); ++i)
+            wantedNodes.insert(nodes.at(i));
+
+        for(int i = 0; i < edges.count(); ++i)
+        {
+            const QPair<int, int> &ends = _virtualEdgeEnds.at(edges.at(i));
+            wantedEdges.insert(edges.at(i));
+            wantedNodes.insert(ends.first);
+            wantedNodes.insert(ends.second);
+        }
+    }
+
+    beginBulkUpdate();
+
+    // Edges are released before their nodes and materialised after them
+    QList<int> materialised = _materialisedEdges.toList();
+    for(QList<int>::iterator iter = materialised.begin();
+        iter != materialised.end(); ++iter)
+    {
+        if(!wantedEdges.contains(*iter))
+            releaseEdge(*iter);
+    }
+
+    materialised = _materialisedNodes.toList();
+    for(QList<int>::iterator iter = materialised.begin();
+        iter != materialised.end(); ++iter)
+    {
+        if(!wantedNodes.contains(*iter))
+            releaseNode(*iter);
+    }
+
+    for(QSet<int>::const_iterator iter = wantedNodes.begin();
+        iter != wantedNodes.end(); ++iter)
+    {
+        if(_nodeItems.at(*iter) == 0)
+            materialiseNode(*iter);
+    }
+
+    for(QSet<int>::const_iterator iter = wantedEdges.begin();
+        iter != wantedEdges.end(); ++iter)
+    {
+        if(_edgeItems.at(*iter) == 0)
+            materialiseEdge(*iter);
+    }
+
+    endBulkUpdate();
 }
 
-void GraphScene::layoutFMMM()
+void GraphScene::drawBackground(QPainter *painter, const QRectF &rect)
 {
-    layoutInit();
+    QGraphicsScene::drawBackground(painter, rect);
 
-    ogdf::FMMMLayout fmmm;
+    if(!_virtualized)
+        return;
+
+    // Elements without items are drawn as items are when zoomed right out,
+    // see RenderStyle::outlineDetail()
+    const RenderStyle *style = RenderStyle::instance();
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing, false);
 
-    fmmm.call(_ga);
+    QVector<int> edges = _edgeGrid.query(rect);
+    QColor lineColour;
+    for(int i = 0; i < edges.count(); ++i)
+    {
+        int index = edges.at(i);
+        const QPair<int, int> &ends = _virtualEdgeEnds.at(index);
+        // Loops are lost inside their node
+        if(_edgeItems.at(index) != 0 || ends.first == ends.second)
+            continue;
 
-    layoutApply();
+        const QColor &colour = style->edgeColour(_virtualEdges.at(index)->mark());
+        if(colour != lineColour)
+        {
+            lineColour = colour;
+            painter->setPen(QPen(lineColour, 0));
+        }
+        painter->drawLine(virtualNodeCenter(ends.first),
+                          virtualNodeCenter(ends.second));
+    }
+
+    QVector<int> nodes = _nodeGrid.query(rect);
+    qreal idHeight = 1 + style->nodeMetrics().height() + 1;
+    for(int i = 0; i < nodes.count(); ++i)
+    {
+        int index = nodes.at(i);
+        if(_nodeItems.at(index) != 0)
+            continue;
+
+        Node *node = _virtualNodes.at(index);
+        QRectF nodeRect = _nodeGrid.rect(index);
+        nodeRect.setHeight(nodeRect.height() - idHeight);
+
+        // As NodeItem::borderColor() would colour it
+        QColor colour = style->nodeBackground(node->mark()).darker(120);
+        if(node->isRoot())
+            colour = colour.darker(110);
+        painter->fillRect(nodeRect, colour);
+    }
+
+    painter->restore();
 }
 
-void GraphScene::layoutGEM()
+NodeItem *GraphScene::nodeAt(const QPointF &pos) const
 {
-    layoutInit();
+    // items() tests each item's shape and is served by the index if there is
+    // one, the topmost node wins
+    QList<QGraphicsItem *> atPoint = items(pos);
+    for(int i = 0; i < atPoint.count(); ++i)
+    {
+        QGraphicsObject *object = atPoint.at(i)->toGraphicsObject();
+        NodeItem *node = qobject_cast<NodeItem *>(object);
+        if(node != 0)
+            return node;
+    }
 
-    ogdf::GEMLayout gem;
+    return 0;
+}
 
-    gem.call(_ga);
-    gem.desiredLength(20.0);
-    gem.minDistCC(50.0);
+EdgeItem *GraphScene::edgeAt(const QPointF &pos) const
+{
+    QList<QGraphicsItem *> atPoint = items(pos);
+    for(int i = 0; i < atPoint.count(); ++i)
+    {
+        QGraphicsObject *object = atPoint.at(i)->toGraphicsObject();
+        EdgeItem *edge = qobject_cast<EdgeItem *>(object);
+        // Only the area around the line itself counts, not the whole curve
+        if(edge != 0 && edge->edgePolygon().containsPoint(pos, Qt::OddEvenFill))
+            return edge;
+    }
 
-    layoutApply();
+    return 0;
 }
 
-void GraphScene::layoutApply()
+LayoutJob *GraphScene::createLayoutJob(LayoutJob::Algorithm algorithm) const
 {
-    for(nodeIter iter = _nodes.begin(); iter != _nodes.end(); ++iter)
+    LayoutJob *job = new LayoutJob(algorithm);
+
+    if(_virtualized)
+    {
+        // Most of the graph has no items, take the snapshot from the model.
+        // The job's indices are the same as the grids'.
+        qreal idHeight = 1 + RenderStyle::instance()->nodeMetrics().height() + 1;
+        for(int i = 0; i < _virtualNodes.count(); ++i)
+        {
+            Node *node = _virtualNodes.at(i);
+            QRectF rect = _nodeGrid.rect(i);
+            job->addNode(node->id(), node->pos(),
+                         QSizeF(rect.width(), rect.height() - idHeight));
+        }
+
+        for(int i = 0; i < _virtualEdgeEnds.count(); ++i)
+            job->addEdge(_virtualEdgeEnds.at(i).first,
+                         _virtualEdgeEnds.at(i).second);
+
+        return job;
+    }
+
+    QHash<QString, int> indices;
+    for(nodeConstIter iter = _nodes.begin(); iter != _nodes.end(); ++iter)
     {
         NodeItem *node = *iter;
-        QPointF newPosition;
-        newPosition.setX(_ga.x(_nodeMap[node->id()]));
-        newPosition.setY(_ga.y(_nodeMap[node->id()]));
-        node->setPos(newPosition);
+        int index = job->addNode(node->id(), node->pos(),
+                                 node->shape().boundingRect().size());
+        indices.insert(node->id(), index);
+    }
+
+    for(edgeConstIter iter = _edges.begin(); iter != _edges.end(); ++iter)
+    {
+        EdgeItem *edge = *iter;
+        Q_ASSERT(indices.contains(edge->from()->id()));
+        Q_ASSERT(indices.contains(edge->to()->id()));
+        job->addEdge(indices.value(edge->from()->id()),
+                     indices.value(edge->to()->id()));
+    }
+
+    return job;
+}
+
+LayoutJob *GraphScene::createIncrementalJob() const
+{
+    LayoutJob *job = new LayoutJob(LayoutJob::Algorithm_Incremental);
+    QHash<Node *, int> indices;
+
+    // The new nodes go in first, so they are not taken for fixed neighbours
+    for(QSet<Node *>::const_iterator iter = _unplacedNodes.begin();
+        iter != _unplacedNodes.end(); ++iter)
+    {
+        Node *node = *iter;
+        // A node put somewhere on its own was put there on purpose
+        if(node->edges().empty()
+                && (node->pos().x() != 0 || node->pos().y() != 0))
+            continue;
+
+        addIncrementalNode(job, node, false, &indices);
+    }
+
+    if(indices.isEmpty())
+    {
+        delete job;
+        return 0;
+    }
+
+    QList<Node *> freeNodes = indices.keys();
+    QList<Node *> anchors;
+    for(QList<Node *>::iterator iter = freeNodes.begin();
+        iter != freeNodes.end(); ++iter)
+    {
+        Node *node = *iter;
+        std::vector<Edge *> edges = node->edges();
+        for(std::vector<Edge *>::iterator edgeIter = edges.begin();
+            edgeIter != edges.end(); ++edgeIter)
+        {
+            Edge *e = *edgeIter;
+            Node *other = (e->from() == node) ? e->to() : e->from();
+
+            // An edge between two new nodes is added from its source only
+            bool otherFree = indices.contains(other)
+                    && !job->isFixed(indices.value(other));
+            if(otherFree && e->from() != node)
+                continue;
+
+            if(!otherFree && !indices.contains(other))
+                anchors.append(other);
+
+            int from = indices.value(node);
+            int to = addIncrementalNode(job, other, !otherFree, &indices);
+            job->addEdge(from, to);
+        }
     }
 
+    // The new nodes will go around their fixed neighbours, about a length away,
+    // and push on anything within reach of where they land, so the nodes near
+    // those must be in the snapshot as well
+    qreal reach = LayoutJob::incrementalLength()
+            + LayoutJob::incrementalReach();
+    for(QList<Node *>::iterator iter = anchors.begin(); iter != anchors.end();
+        ++iter)
+    {
+        QPointF pos = (*iter)->pos();
+        QRectF area(pos.x() - reach, pos.y() - reach, 2*reach, 2*reach);
+
+        if(_virtualized)
+        {
+            QVector<int> near = _nodeGrid.query(area);
+            for(int i = 0; i < near.count(); ++i)
+                addIncrementalNode(job, _virtualNodes.at(near.at(i)), true,
+                                   &indices);
+            continue;
+        }
+
+        QList<QGraphicsItem *> near = items(area);
+        for(int i = 0; i < near.count(); ++i)
+        {
+            QGraphicsObject *object = near.at(i)->toGraphicsObject();
+            NodeItem *nodeItem = qobject_cast<NodeItem *>(object);
+            if(nodeItem != 0)
+                addIncrementalNode(job, nodeItem->node(), true, &indices);
+        }
+    }
+
+    // New nodes joined to nothing already placed go beside the whole graph,
+    // not just beside the part of it in the snapshot
+    QRectF scene = sceneRect();
+    job->setRowOrigin(QPointF(scene.right() + LayoutJob::incrementalLength(),
+                              scene.top()));
+
+    return job;
+}
+
+int GraphScene::addIncrementalNode(LayoutJob *job, Node *node, bool fixed,
+                                   QHash<Node *, int> *indices) const
+{
+    QHash<Node *, int>::const_iterator iter = indices->find(node);
+    if(iter != indices->end())
+        return iter.value();
+
+    // Sized as createLayoutJob() sizes them, from the item if there is one
+    QPointF pos = node->pos();
+    QSizeF size;
+    NodeItem *nodeItem = _nodes.value(node->id(), 0);
+    if(nodeItem != 0)
+    {
+        pos = nodeItem->pos();
+        size = nodeItem->shape().boundingRect().size();
+    }
+    else
+    {
+        qreal idHeight = 1 + RenderStyle::instance()->nodeMetrics().height()
+                + 1;
+        QRectF rect = NodeItem::boundingRectFor(node->label(), node->isRoot());
+        size = QSizeF(rect.width(), rect.height() - idHeight);
+    }
+
+    int index = job->addNode(node->id(), pos, size, fixed);
+    indices->insert(node, index);
+    return index;
+}
+
+void GraphScene::startLayout(LayoutJob *job)
+{
+    cancelLayout();
+
+    _layoutJob = job;
+    connect(job, SIGNAL(finished()), this, SLOT(layoutJobFinished()));
+    connect(job, SIGNAL(finished()), job, SLOT(deleteLater()));
+
+    emit layoutStarted();
+    job->start(QThread::LowPriority);
+}
+
+void GraphScene::layoutNow(LayoutJob::Algorithm algorithm)
+{
+    LayoutJob *job = createLayoutJob(algorithm);
+    job->compute();
+
+    if(job->succeeded())
+        applyLayout(job, false);
+    else
+        qDebug() << "GraphScene: Layout failed: " << job->errorMessage();
+
+    delete job;
+}
+
+bool GraphScene::isLayoutRunning() const
+{
+    return _layoutJob != 0;
+}
+
+void GraphScene::cancelLayout()
+{
+    if(_layoutJob == 0)
+        return;
+
+    // The thread finishes in its own time and deletes itself, its positions
+    // are never applied
+    _layoutJob->cancel();
+    _layoutJob = 0;
+    emit layoutFinished(false);
+}
+
+void GraphScene::layoutJobFinished()
+{
+    LayoutJob *job = qobject_cast<LayoutJob *>(sender());
+    // Ignore jobs which have been cancelled or replaced
+    if(job == 0 || job != _layoutJob)
+        return;
+
+    _layoutJob = 0;
+
+    if(!job->succeeded())
+    {
+        emit layoutFailed(job->errorMessage());
+        emit layoutFinished(false);
+        return;
+    }
+
+    applyLayout(job, _animateLayouts);
+    emit layoutFinished(true);
+}
+
+void GraphScene::applyLayout(LayoutJob *job, bool animate)
+{
+    stopLayoutAnimation();
+
+    bool incremental = (job->algorithm() == LayoutJob::Algorithm_Incremental);
+    if(!incremental)
+        _unplacedNodes.clear();
+
+    if(_virtualized && incremental)
+    {
+        // Only a few nodes move, update their rectangles in place
+        for(int i = 0; i < job->nodeCount(); ++i)
+        {
+            int index = _virtualNodeIndex.value(job->nodeId(i), -1);
+            if(job->isFixed(i) || index < 0)
+                continue;
+
+            Node *node = _virtualNodes.at(index);
+            _unplacedNodes.remove(node);
+
+            NodeItem *nodeItem = _nodeItems.at(index);
+            if(nodeItem != 0)
+                nodeItem->setPos(job->position(i));
+            else
+                node->setPos(job->position(i));
+            syncVirtualNode(index);
+        }
+
+        resizeToContents();
+        viewportChanged();
+        return;
+    }
+
+    if(_virtualized)
+    {
+        for(int i = 0; i < job->nodeCount(); ++i)
+        {
+            int index = _virtualNodeIndex.value(job->nodeId(i), -1);
+            if(index >= 0)
+                _virtualNodes.at(index)->setPos(job->position(i));
+        }
+
+        // Every rectangle in the grids has moved, build them again
+        buildVirtualGraph();
+        resizeToContents();
+        viewportChanged();
+        return;
+    }
+
+    // Every node moves, so the index is rebuilt once rather than per node.
+    // An animation keeps it suspended until it stops.
+    beginBulkUpdate();
+
+    for(int i = 0; i < job->nodeCount(); ++i)
+    {
+        // Nodes may have been deleted whilst the layout was computed
+        NodeItem *node = _nodes.value(job->nodeId(i), 0);
+        if(node == 0 || job->isFixed(i))
+            continue;
+
+        if(incremental)
+            _unplacedNodes.remove(node->node());
+
+        if(animate)
+        {
+            _animatedNodes.append(node);
+            _animationStart.append(node->pos());
+            _animationEnd.append(job->position(i));
+        }
+        else
+            node->setPos(job->position(i));
+    }
+
+    if(animate && !_animatedNodes.isEmpty()
+            && _animatedNodes.count() <= _animationLimit)
+    {
+        _layoutTimeLine->start();
+        return;
+    }
+
+    // Too many nodes to animate smoothly, move them straight there
+    for(int i = 0; i < _animatedNodes.count(); ++i)
+        _animatedNodes.at(i)->setPos(_animationEnd.at(i));
+    _animatedNodes.clear();
+    _animationStart.clear();
+    _animationEnd.clear();
+
+    endBulkUpdate();
     resizeToContents();
 }
 
+void GraphScene::animateLayout(qreal value)
+{
+    for(int i = 0; i < _animatedNodes.count(); ++i)
+    {
+        QPointF start = _animationStart.at(i);
+        _animatedNodes.at(i)->setPos(start + (_animationEnd.at(i) - start)*value);
+    }
+}
+
+void GraphScene::layoutAnimationFinished()
+{
+    if(_animatedNodes.isEmpty())
+        return;
+
+    stopLayoutAnimation();
+    resizeToContents();
+}
+
+void GraphScene::stopLayoutAnimation()
+{
+    if(_animatedNodes.isEmpty())
+        return;
+
+    _layoutTimeLine->stop();
+
+    // Put every node where the layout meant it to be
+    for(int i = 0; i < _animatedNodes.count(); ++i)
+        _animatedNodes.at(i)->setPos(_animationEnd.at(i));
+
+    _animatedNodes.clear();
+    _animationStart.clear();
+    _animationEnd.clear();
+
+    // Ends the bulk update begun by applyLayout()
+    endBulkUpdate();
+}
+
+void GraphScene::layoutTree(LayoutDirections direction)
+{
+    LayoutJob *job = createLayoutJob(LayoutJob::Algorithm_Tree);
+    job->setDirection(direction);
+    startLayout(job);
+}
+
+void GraphScene::layoutSugiyama()
+{
+    startLayout(createLayoutJob(LayoutJob::Algorithm_Sugiyama));
+}
+
+void GraphScene::layoutRadialTree()
+{
+    startLayout(createLayoutJob(LayoutJob::Algorithm_RadialTree));
+}
+
+void GraphScene::layoutFPP()
+{
+    startLayout(createLayoutJob(LayoutJob::Algorithm_FPP));
+}
+
+void GraphScene::layoutPlanarDraw()
+{
+    startLayout(createLayoutJob(LayoutJob::Algorithm_PlanarDraw));
+}
+
+void GraphScene::layoutPlanarStraight()
+{
+    startLayout(createLayoutJob(LayoutJob::Algorithm_PlanarStraight));
+}
+
+void GraphScene::layoutSchnyder()
+{
+    startLayout(createLayoutJob(LayoutJob::Algorithm_Schnyder));
+}
+
+void GraphScene::layoutPlanarizationGrid()
+{
+    startLayout(createLayoutJob(LayoutJob::Algorithm_PlanarizationGrid));
+}
+
+void GraphScene::layoutCircular()
+{
+    startLayout(createLayoutJob(LayoutJob::Algorithm_Circular));
+}
+
+void GraphScene::layoutSpring()
+{
+    startLayout(createLayoutJob(LayoutJob::Algorithm_Spring));
+}
+
+void GraphScene::layoutDavidsonHarel()
+{
+    startLayout(createLayoutJob(LayoutJob::Algorithm_DavidsonHarel));
+}
+
+void GraphScene::layoutFMMM()
+{
+    startLayout(createLayoutJob(LayoutJob::Algorithm_FMMM));
+}
+
+void GraphScene::layoutGEM()
+{
+    startLayout(createLayoutJob(LayoutJob::Algorithm_GEM));
+}
+
+void GraphScene::layoutIncremental()
+{
+    LayoutJob *job = createIncrementalJob();
+    if(job == 0)
+    {
+        qDebug() << "GraphScene: No new nodes to place";
+        return;
+    }
+
+    startLayout(job);
+}
+
 void GraphScene::resizeToContents()
 {
     QRectF boundingRect = itemsBoundingRect();
+    if(_virtualized)
+        boundingRect = boundingRect.united(_nodeGrid.bounds());
     QPointF topLeft = boundingRect.topLeft();
     QPointF bottomRight = boundingRect.bottomRight();
 
@@ -603,6 +1482,7 @@ void GraphScene::addNode(const QPointF &position, bool automatic)
                       position.y() - boundingRect.height()/2
                       );
     addNodeItem(nodeItem, centerPos);
+    _unplacedNodes.insert(n);
 }
 
 void GraphScene::addNode(qreal x, qreal y)
@@ -620,14 +1500,33 @@ void GraphScene::nodeIdChanged(QString oldId, QString newId)
     }
 }
 
+QRectF GraphScene::selectionRect() const
+{
+    // Pad for the one pixel border
+    return QRectF(_mouseInitialPos, _mousePos).normalized().adjusted(-1, -1,
+                                                                     1, 1);
+}
+
+QRectF GraphScene::drawingEdgeRect() const
+{
+    if(!_drawingEdge || _fromNode == 0)
+        return QRectF();
+
+    // The line starts at the node's outline, which the line from its centre
+    // covers, and the arrowhead may stick out sideways at the far end
+    const RenderStyle *style = RenderStyle::instance();
+    qreal margin = style->edgeArrowSize() + style->edgeLineWidth();
+    return QRectF(_fromNode->centerPos(), _mousePos).normalized().adjusted(
+                -margin, -margin, margin, margin);
+}
+
 void GraphScene::drawForeground(QPainter *painter, const QRectF &rect)
 {
     Q_UNUSED(rect)
-    QSettings settings;
-    qreal arrowSize = settings.value("GraphView/Edges/ArrowSize", 9).toDouble();
-    qreal lineWidth = settings.value("GraphView/Edges/LineWidth", 1.5).toDouble();
-    QColor lineColour  = settings.value("GraphView/Edges/LineColour",
-                                        QColor(0x33,0x33,0x33)).value<QColor>();
+    const RenderStyle *style = RenderStyle::instance();
+    qreal arrowSize = style->edgeArrowSize();
+    qreal lineWidth = style->edgeLineWidth();
+    QColor lineColour = style->edgeDrawingColour();
     lineColour.setAlpha(100);
 
     if(_drawingEdge)
@@ -702,11 +1601,6 @@ void GraphScene::drawForeground(QPainter *painter, const QRectF &rect)
         painter->setBrush(selectionColour);
 
         painter->drawRect(QRectF(_mouseInitialPos, _mousePos));
-
-        QPainterPath path;
-        path.addRect(QRectF(_mouseInitialPos, _mousePos));
-
-        setSelectionArea(path);
     }
 }
 
@@ -762,7 +1656,9 @@ void GraphScene::removeEdge(EdgeItem *edge)
 
     removeItem(edge);
     _edges.remove(iter.key());
+    removeFromEdgeGroup(edge);
     delete edge;
+    updateIndexMethod();
 }
 
 void GraphScene::removeNode(NodeItem *node)
@@ -800,9 +1696,17 @@ void GraphScene::removeNode(NodeItem *node)
         return;
     }
 
+    // The animation must not be left holding the deleted item
+    stopLayoutAnimation();
+    _unplacedNodes.remove(node->node());
+    // Nor the drag, if the node was the one grabbed
+    if(mouseGrabberItem() == node)
+        endMovingItems();
+
     removeItem(node);
     _nodes.remove(iter.key());
     delete node;
+    updateIndexMethod();
 
     if(!_graph->removeNode(node->id()))
         return;
@@ -832,6 +1736,8 @@ void GraphScene::linkedGraphAddedNode(Node *nodeItem)
         NodeItem *nItem = new NodeItem(n);
         nItem->setItemState(GraphItem::GraphItem_Deleted);
         addNodeItem(nItem, n->pos());
+        if(n->pos().x() == 0 && n->pos().y() == 0)
+            _unplacedNodes.insert(n);
     }
     else
     {
@@ -980,6 +1886,10 @@ void GraphScene::keyPressEvent(QKeyEvent *event)
 
 void GraphScene::mousePressEvent(QGraphicsSceneMouseEvent *event)
 {
+    // A drag whose grab was lost never saw its release
+    if(_movingItems && mouseGrabberItem() == 0)
+        endMovingItems();
+
     if(event->button() == Qt::RightButton)
     {
         // This should only work when the view is editable
@@ -990,25 +1900,19 @@ void GraphScene::mousePressEvent(QGraphicsSceneMouseEvent *event)
         }
 
         // Are we over a node?
-        for(nodeIter iter = _nodes.begin(); iter != _nodes.end(); ++iter)
+        NodeItem *node = nodeAt(event->scenePos());
+        if(node != 0)
         {
-            NodeItem *node = *iter;
-
             // Don't draw edges from phantoms
             if(node->node()->isPhantomNode())
                 return;
 
-            QPainterPath path = node->shape();
-            path.translate(node->scenePos());
-            if(path.contains(event->scenePos()))
-            {
-                _drawingEdge = true;
-                _selecting = false;
-                _fromNode = node;
-                _mousePos = event->scenePos();
-                update();
-                return;
-            }
+            _drawingEdge = true;
+            _selecting = false;
+            _fromNode = node;
+            _mousePos = event->scenePos();
+            invalidate(drawingEdgeRect(), ForegroundLayer);
+            return;
         }
     }
     else if(event->button() == Qt::LeftButton)
@@ -1032,18 +1936,63 @@ void GraphScene::mousePressEvent(QGraphicsSceneMouseEvent *event)
 
 void GraphScene::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
 {
+    QRectF oldSelection = selectionRect();
+    QRectF oldEdge = drawingEdgeRect();
     _mousePos = event->scenePos();
+
+    if(_movingItems && mouseGrabberItem() == 0)
+        endMovingItems();
+
+    // Dragging nodes moves their edges too, leave reindexing them until the
+    // drag is over. A virtualised scene also keeps its items until then.
+    if(!_movingItems && !_selecting && !_drawingEdge
+            && (isIndexed() || _virtualized)
+            && (event->buttons() & Qt::LeftButton)
+            && mouseGrabberItem() != 0)
+    {
+        _movingItems = true;
+        beginBulkUpdate();
+    }
+
     QGraphicsScene::mouseMoveEvent(event);
 
+    if(_selecting)
+    {
+        // Select from the index here rather than whilst painting, and only
+        // repaint where the band was and where it is now. Items whose
+        // selection changes repaint themselves.
+        QPainterPath path;
+        path.addRect(QRectF(_mouseInitialPos, _mousePos));
+        setSelectionArea(path);
+
+        invalidate(oldSelection.united(selectionRect()), ForegroundLayer);
+        return;
+    }
+
+    if(_drawingEdge)
+    {
+        invalidate(oldEdge.united(drawingEdgeRect()), ForegroundLayer);
+        return;
+    }
+
+    // Nothing is hovered while nodes are dragged, Qt sends the moves to the
+    // grabber alone. Looking items up here would also search every one of
+    // them, the index being suspended until the drag is over.
+    if(_movingItems)
+        return;
+
+    // Qt only sends hover events to the topmost item, pass them on to the
+    // items beneath it so that an edge under a node's bounding rectangle can
+    // still be hovered. Each item repaints itself if its hover state changes.
     QList<QGraphicsItem *> atPoint = items(event->scenePos());
     for(int i = 1; i < atPoint.length(); ++i)
     {
-        QGraphicsSceneHoverEvent *hoverEvent = new QGraphicsSceneHoverEvent(
-                    QEvent::GraphicsSceneHoverMove);
-        hoverEvent->setScenePos(event->scenePos());
-        sendEvent(atPoint.at(i), hoverEvent);
+        QGraphicsSceneHoverEvent hoverEvent(QEvent::GraphicsSceneHoverMove);
+        hoverEvent.setScenePos(event->scenePos());
+        hoverEvent.setLastScenePos(event->lastScenePos());
+        hoverEvent.setModifiers(event->modifiers());
+        sendEvent(atPoint.at(i), &hoverEvent);
     }
-    update();
 }
 
 void GraphScene::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
@@ -1053,61 +2002,57 @@ void GraphScene::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
         if(event->button() != Qt::RightButton)
             return;
 
+        invalidate(drawingEdgeRect(), ForegroundLayer);
         _drawingEdge = false;
         // Are we above a node at this point? If yes we need to add an edge
-        for(nodeIter iter = _nodes.begin(); iter != _nodes.end(); ++iter)
+        NodeItem *node = nodeAt(event->scenePos());
+        if(node != 0)
         {
-            NodeItem *node = *iter;
-            QPainterPath path = node->shape();
-            path.translate(node->scenePos());
-            if(path.contains(event->scenePos()))
+//            QString fromLabel = _fromNode->label();
+//            QString toLabel = node->label();
+
+//            bool leftnonempty = false;
+//            if (QString::compare(fromLabel, QString("")) != 0)
+//            {
+//                leftnonempty = true;
+//            }
+
+//            bool rightnonempty = false;
+//            if (QString::compare(toLabel, QString("")) != 0)
+//            {
+//                rightnonempty = true;
+//            }
+
+//            QString newLabel = leftnonempty ?
+//                        rightnonempty ? ( fromLabel + ":" + toLabel ) : fromLabel
+//                                      : rightnonempty ? toLabel : QString("");
+
+            Node *from = _graph->node(_fromNode->id());
+            Node *to = _graph->node(node->id());
+            if(from == 0 || to == 0)
             {
-//                QString fromLabel = _fromNode->label();
-//                QString toLabel = node->label();
-
-//                bool leftnonempty = false;
-//                if (QString::compare(fromLabel, QString("")) != 0)
-//                {
-//                    leftnonempty = true;
-//                }
-
-//                bool rightnonempty = false;
-//                if (QString::compare(toLabel, QString("")) != 0)
-//                {
-//                    rightnonempty = true;
-//                }
-
-//                QString newLabel = leftnonempty ?
-//                            rightnonempty ? ( fromLabel + ":" + toLabel ) : fromLabel
-//                                          : rightnonempty ? toLabel : QString("");
-
-                Node *from = _graph->node(_fromNode->id());
-                Node *to = _graph->node(node->id());
-                if(from == 0 || to == 0)
-                {
-                    qDebug() << "Edge creation failed to find nodes.";
-                    return;
-                }
+                qDebug() << "Edge creation failed to find nodes.";
+                return;
+            }
 
-                QString id = _graph->newEdgeId();
+            QString id = _graph->newEdgeId();
 
-                Edge *e = _graph->addEdge( id ,from, to, QString(""));
-                EdgeItem *edgeItem = new EdgeItem(e, _fromNode, node);
+            Edge *e = _graph->addEdge( id ,from, to, QString(""));
+            EdgeItem *edgeItem = new EdgeItem(e, _fromNode, node);
 
-                if(_linkedGraph != 0)
+            if(_linkedGraph != 0)
+            {
+                if(!_linkedGraph->contains(e->id()))
                 {
-                    if(!_linkedGraph->contains(e->id()))
-                    {
-                        edgeItem->setItemState(GraphItem::GraphItem_New);
-                    }
-                    else if(_linkedGraph->containsNode(e->id()))
-                    {
-                        edgeItem->setItemState(GraphItem::GraphItem_Invalid);
-                    }
+                    edgeItem->setItemState(GraphItem::GraphItem_New);
+                }
+                else if(_linkedGraph->containsNode(e->id()))
+                {
+                    edgeItem->setItemState(GraphItem::GraphItem_Invalid);
                 }
-                addEdgeItem(edgeItem);
-                return;
             }
+            addEdgeItem(edgeItem);
+            return;
         }
     }
 
@@ -1117,10 +2062,34 @@ void GraphScene::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
             return;
 
         _selecting = false;
+        invalidate(selectionRect(), ForegroundLayer);
     }
 
     QGraphicsScene::mouseReleaseEvent(event);
-    update();
+
+    if(_movingItems && event->buttons() == Qt::NoButton)
+        endMovingItems();
+}
+
+void GraphScene::endMovingItems()
+{
+    if(!_movingItems)
+        return;
+
+    _movingItems = false;
+
+    // Dragged items have moved their nodes, the grids have to follow before
+    // they are queried again
+    if(_virtualized)
+    {
+        for(QSet<int>::const_iterator iter = _materialisedNodes.constBegin();
+            iter != _materialisedNodes.constEnd(); ++iter)
+            syncVirtualNode(*iter);
+    }
+
+    endBulkUpdate();
+    // Updating the items waits for drags to finish
+    viewportChanged();
 }
 
 void GraphScene::mouseDoubleClickEvent(QGraphicsSceneMouseEvent *event)
@@ -1134,47 +2103,39 @@ void GraphScene::mouseDoubleClickEvent(QGraphicsSceneMouseEvent *event)
 
     // If we're over a node then don't add a new node, instead pass the event on
     // to trigger an EditNodeDialog
-    for(nodeIter iter = _nodes.begin(); iter != _nodes.end(); ++iter)
+    NodeItem *node = nodeAt(event->scenePos());
+    if(node != 0)
     {
-        NodeItem *node = *iter;
-        QPainterPath path = node->shape();
-        path.translate(node->scenePos());
-        if(path.contains(event->scenePos()))
+        if(_linkedGraph != 0)
         {
-            if(_linkedGraph != 0)
+            if(node->itemState() == GraphItem::GraphItem_Deleted)
             {
-                if(node->itemState() == GraphItem::GraphItem_Deleted)
-                {
-                    node->preserveNode();
-                    node->setSelected(false);
-                }
-
-                return;
+                node->preserveNode();
+                node->setSelected(false);
             }
-            QGraphicsScene::mouseDoubleClickEvent(event);
+
             return;
         }
+        QGraphicsScene::mouseDoubleClickEvent(event);
+        return;
     }
 
     // And the same for edges
-    for(edgeIter iter = _edges.begin(); iter != _edges.end(); ++iter)
+    EdgeItem *edge = edgeAt(event->scenePos());
+    if(edge != 0)
     {
-        EdgeItem *edge = *iter;
-        if(edge->edgePolygon().containsPoint(event->scenePos(), Qt::OddEvenFill))
+        if(_linkedGraph != 0)
         {
-            if(_linkedGraph != 0)
+            if(edge->itemState() == GraphItem::GraphItem_Deleted)
             {
-                if(edge->itemState() == GraphItem::GraphItem_Deleted)
-                {
-                    edge->preserveEdge();
-                    edge->setSelected(false);
-                }
-
-                return;
+                edge->preserveEdge();
+                edge->setSelected(false);
             }
-            QGraphicsScene::mouseDoubleClickEvent(event);
+
             return;
         }
+        QGraphicsScene::mouseDoubleClickEvent(event);
+        return;
     }
 
     event->accept();
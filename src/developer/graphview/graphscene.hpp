@@ -5,23 +5,75 @@
 #define GRAPHSCENE_HPP
 
 #include <QGraphicsScene>
+#include <QHash>
+#include <QMap>
+#include <QPair>
+#include <QSet>
+#include <QVector>
 
-#include <ogdf/basic/Graph.h>
-#include <ogdf/basic/GraphAttributes.h>
-
+#include "graphview/spatialgrid.hpp"
+#include "graphview/layoutjob.hpp"
 // Implicitly brings in nodeitem.hpp
 #include "graphview/edgeitem.hpp"
 #include "graph.hpp"
 #include "global.hpp"
 
+class QTimeLine;
+
 namespace Developer {
 
+/*!
+ * \brief Scene holding the NodeItem and EdgeItem objects of one Graph
+ *
+ * The scene keeps its items in step with the Graph model, handles the mouse
+ * and keyboard interaction used to edit it, and lays it out. Large graphs are
+ * indexed or virtualised so that finding and drawing items stays cheap, and
+ * layouts are computed off the GUI thread.
+ */
 class GraphScene : public QGraphicsScene
 {
     Q_OBJECT
 
 public:
+    /*!
+     * \brief How items are found by position
+     *
+     * Without an index hover, selection and painting search every item. Small
+     * graphs are still fastest that way, so by default Qt's BSP index is only
+     * used for larger scenes.
+     */
+    enum IndexMode
+    {
+        //! Index the scene once it holds indexThreshold() items
+        Index_Automatic,
+        //! Never index the scene
+        Index_None,
+        //! Always index the scene
+        Index_Bsp
+    };
+
+    /*!
+     * \brief When a graph's items are only created around the views
+     *
+     * A virtualised graph has a SpatialGrid built over the positions held by
+     * the model instead of an item for every element. Items are created for
+     * the elements around what the views show, and reused as the views pan.
+     * Everything else is drawn in the background straight from the grid. A
+     * virtualised scene is always read only, though nodes in view may still
+     * be dragged, and is never used for a graph with a linked graph.
+     */
+    enum VirtualMode
+    {
+        //! Virtualise graphs with virtualThreshold() or more elements
+        Virtual_Automatic,
+        //! Always create every item
+        Virtual_Never,
+        //! Virtualise every graph without a linked graph
+        Virtual_Always
+    };
+
     explicit GraphScene(QObject *parent = 0);
+    ~GraphScene();
 
     Graph *graph() const;
     void setGraph(Graph *newGraph);
@@ -36,6 +88,44 @@ public:
     void addNodeItem(NodeItem *nodeItem, const QPointF &position);
     void addEdgeItem(EdgeItem *edgeItem);
 
+    IndexMode indexMode() const;
+    void setIndexMode(IndexMode mode);
+    //! Number of nodes and edges at which Index_Automatic starts indexing
+    int indexThreshold() const;
+    void setIndexThreshold(int items);
+    bool isIndexed() const;
+
+    /*!
+     * \brief Stop maintaining the index while many items change
+     *
+     * Keeping the index up to date as items move costs more than it saves
+     * when many move at once, as in layouts and node drags. Calls may be
+     * nested, the index is rebuilt when the outermost endBulkUpdate() is
+     * reached.
+     */
+    void beginBulkUpdate();
+    void endBulkUpdate();
+
+    /*!
+     * \brief Get how graphs are virtualised
+     *
+     * A change of mode takes effect the next time a graph is set.
+     */
+    VirtualMode virtualMode() const;
+    void setVirtualMode(VirtualMode mode);
+    //! Number of nodes and edges at which Virtual_Automatic virtualises
+    int virtualThreshold() const;
+    void setVirtualThreshold(int elements);
+    /*!
+     * \brief Get the number of items created at most
+     *
+     * When so much of a virtualised graph is in view that creating items
+     * would not pay, the background draws all of it instead.
+     */
+    int virtualItemLimit() const;
+    void setVirtualItemLimit(int items);
+    bool isVirtualized() const;
+
     void layoutTree(LayoutDirections direction = DEFAULT_LAYOUT_DIRECTION);
     void layoutSugiyama();
     void layoutRadialTree();
@@ -49,6 +139,21 @@ public:
     void layoutDavidsonHarel();
     void layoutFMMM();
     void layoutGEM();
+    /*!
+     * \brief Place the nodes added since the last layout, leaving the rest
+     *
+     * The new nodes are those added since the last full layout or loaded
+     * without a position. They are placed among the nodes they are joined to.
+     * Nodes without edges which were given a position when they were added
+     * stay where they are. Does nothing if there are no new nodes.
+     *
+     * The layout's snapshot holds just the new nodes, their neighbours and
+     * the nodes around them, so its cost follows the number of new nodes.
+     */
+    void layoutIncremental();
+
+    //! True from layoutStarted() until layoutFinished()
+    bool isLayoutRunning() const;
 
     void resizeToContents();
 
@@ -61,18 +166,98 @@ public slots:
 
     void nodeIdChanged(QString oldId, QString newId);
 
+    /*!
+     * \brief Tell the scene that a view has scrolled, zoomed or resized
+     *
+     * A virtualised scene updates its items once control returns to the event
+     * loop, however many times this was called. Otherwise this does nothing.
+     */
+    void viewportChanged();
+
+    /*!
+     * \brief Abandon the layout being computed, leaving the nodes where they
+     *  are
+     */
+    void cancelLayout();
+
 signals:
     void nodeAdded(NodeItem *nodeItem);
     void edgeAdded(EdgeItem *edgeItem);
 
+    void layoutStarted();
+    /*!
+     * \brief Emitted once a layout is over, for whatever reason
+     * \param applied True if the nodes were given their new positions
+     */
+    void layoutFinished(bool applied);
+    void layoutFailed(QString message);
+
 protected slots:
     void linkedGraphAddedNode(Node *nodeItem);
     void linkedGraphAddedEdge(Edge *edgeItem);
+    void updateVirtualItems();
+    void layoutJobFinished();
+    void animateLayout(qreal value);
+    void layoutAnimationFinished();
 
 protected:
-    void layoutInit();
-    void layoutApply();
+    LayoutJob *createLayoutJob(LayoutJob::Algorithm algorithm) const;
+    //! Snapshot for Algorithm_Incremental, 0 if there is nothing to place
+    LayoutJob *createIncrementalJob() const;
+    int addIncrementalNode(LayoutJob *job, Node *node, bool fixed,
+                           QHash<Node *, int> *indices) const;
+    /*!
+     * \brief Compute a layout on a worker thread from a snapshot of the
+     *  nodes and edges
+     *
+     * The editor stays responsive meanwhile. The new positions are applied
+     * all at once, and animated into place unless there are too many nodes.
+     */
+    void startLayout(LayoutJob *job);
+    //! Compute a layout on this thread, for placing a graph as it is loaded
+    void layoutNow(LayoutJob::Algorithm algorithm);
+    void applyLayout(LayoutJob *job, bool animate);
+    void stopLayoutAnimation();
+    void updateIndexMethod();
+
+    NodeItem *nodeAt(const QPointF &pos) const;
+    EdgeItem *edgeAt(const QPointF &pos) const;
+
+    // Edges are grouped by the pair of nodes they join, whichever way round,
+    // so an edge finds its parallel and opposite edges without a graph search
+    typedef QPair<NodeItem *, NodeItem *> NodePair;
+    static NodePair edgeGroupKey(EdgeItem *edgeItem);
+    void addToEdgeGroup(EdgeItem *edgeItem);
+    void removeFromEdgeGroup(EdgeItem *edgeItem);
+    void updateEdgeGroup(const NodePair &key);
 
+    // Virtualised graphs, elements are identified by their position in
+    // _virtualNodes and _virtualEdges, which is also their id in the grids
+    bool shouldVirtualize() const;
+    void setVirtualGraph();
+    void buildVirtualGraph();
+    void clearVirtualGraph();
+    QRectF virtualNodeRect(Node *node) const;
+    QRectF virtualEdgeRect(int index) const;
+    QPointF virtualNodeCenter(int index) const;
+    void syncVirtualNode(int index);
+    void materialiseNode(int index);
+    void materialiseEdge(int index);
+    void releaseNode(int index);
+    void releaseEdge(int index);
+
+    void drawBackground(QPainter *painter, const QRectF &rect);
+
+    //! Area of the scene covered by the rubber band
+    QRectF selectionRect() const;
+    //! Area of the scene covered by the edge being drawn, and its arrowhead
+    QRectF drawingEdgeRect() const;
+    /*!
+     * \brief Paint the rubber band and the edge being drawn
+     *
+     * Mouse moves only repaint the area these cover before and after the
+     * move. The rubber band's selection is made as the mouse moves, not here.
+     */
     void drawForeground(QPainter *painter, const QRectF &rect);
 
     void keyPressEvent(QKeyEvent *event);
@@ -81,6 +266,13 @@ protected:
     void mouseMoveEvent(QGraphicsSceneMouseEvent *event);
     void mouseReleaseEvent(QGraphicsSceneMouseEvent *event);
     void mouseDoubleClickEvent(QGraphicsSceneMouseEvent *event);
+    /*!
+     * \brief End the bulk update begun when a node drag started
+     *
+     * Normally called on the release, but also wherever the grab may have
+     * been lost without one. Does nothing if no drag is in progress.
+     */
+    void endMovingItems();
 
     Graph *_graph;
     Graph *_linkedGraph;
@@ -92,13 +284,48 @@ protected:
     NodeItem *_fromNode;
     QPointF _mouseInitialPos;
     QPointF _mousePos;
+    bool _movingItems;
+
+    IndexMode _indexMode;
+    int _indexThreshold;
+    int _bulkUpdates;
+
+    VirtualMode _virtualMode;
+    int _virtualThreshold;
+    int _virtualItemLimit;
+    qreal _virtualMargin;
+    bool _virtualized;
+    bool _virtualUpdatePending;
+    QVector<Node *> _virtualNodes;
+    QVector<Edge *> _virtualEdges;
+    QVector<QPair<int, int> > _virtualEdgeEnds;
+    // By ID, which cannot change while the scene is read only
+    QHash<QString, int> _virtualNodeIndex;
+    QHash<Edge *, int> _virtualEdgeIndex;
+    SpatialGrid _nodeGrid;
+    SpatialGrid _edgeGrid;
+    // The item showing each element, 0 where there is none
+    QVector<NodeItem *> _nodeItems;
+    QVector<EdgeItem *> _edgeItems;
+    QSet<int> _materialisedNodes;
+    QSet<int> _materialisedEdges;
+    // Items out of the scene waiting to be reused
+    QList<NodeItem *> _spareNodes;
+    QList<EdgeItem *> _spareEdges;
 
     QMap<QString, EdgeItem*> _edges;
     QMap<QString, NodeItem*> _nodes;
+    QHash<NodePair, QList<EdgeItem *> > _edgeGroups;
+    // Nodes for layoutIncremental() to place
+    QSet<Node *> _unplacedNodes;
 
-    ogdf::Graph _g;
-    ogdf::GraphAttributes _ga;
-    QMap<QString, ogdf::node> _nodeMap;
+    LayoutJob *_layoutJob;
+    bool _animateLayouts;
+    int _animationLimit;
+    QTimeLine *_layoutTimeLine;
+    QVector<NodeItem *> _animatedNodes;
+    QVector<QPointF> _animationStart;
+    QVector<QPointF> _animationEnd;
 
     typedef QMap<QString, EdgeItem*>::iterator edgeIter;
     typedef QMap<QString, NodeItem*>::iterator nodeIter;
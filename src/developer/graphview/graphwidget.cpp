@@ -8,6 +8,9 @@
 #include <QMouseEvent>
 #include <QKeyEvent>
 #include <QWheelEvent>
+#include <QResizeEvent>
+#include <QProgressDialog>
+#include <QMessageBox>
 #include <QFocusEvent>
 #include <cmath>
 
@@ -15,8 +18,13 @@ namespace Developer {
 
 GraphWidget::GraphWidget(QWidget *parent)
     : QGraphicsView(parent)
+    , _layoutProgress(0)
 {
     _scene = new GraphScene(this);
+    connect(_scene, SIGNAL(layoutStarted()), this, SLOT(layoutStarted()));
+    connect(_scene, SIGNAL(layoutFinished(bool)), this, SLOT(layoutFinished()));
+    connect(_scene, SIGNAL(layoutFailed(QString)),
+            this, SLOT(layoutFailed(QString)));
 
     QRect rect = geometry();
     QRectF sceneRect(rect);
@@ -115,6 +123,46 @@ void GraphWidget::layoutGEM()
     _scene->layoutGEM();
 }
 
+void GraphWidget::layoutIncremental()
+{
+    _scene->layoutIncremental();
+}
+
+void GraphWidget::layoutStarted()
+{
+    if(_layoutProgress != 0)
+        return;
+
+    // OGDF does not report its progress, so the bar only shows that the
+    // layout is still going
+    _layoutProgress = new QProgressDialog(tr("Laying out the graph..."),
+                                          tr("Cancel"), 0, 0, this);
+    _layoutProgress->setWindowTitle(tr("Layout"));
+    _layoutProgress->setWindowModality(Qt::WindowModal);
+    // Most layouts are over before the dialog would be seen
+    _layoutProgress->setMinimumDuration(500);
+    _layoutProgress->setValue(0);
+    connect(_layoutProgress, SIGNAL(canceled()), _scene, SLOT(cancelLayout()));
+}
+
+void GraphWidget::layoutFinished()
+{
+    if(_layoutProgress == 0)
+        return;
+
+    // Closing the dialog would otherwise report a cancellation
+    disconnect(_layoutProgress, SIGNAL(canceled()),
+               _scene, SLOT(cancelLayout()));
+    _layoutProgress->hide();
+    _layoutProgress->deleteLater();
+    _layoutProgress = 0;
+}
+
+void GraphWidget::layoutFailed(QString message)
+{
+    QMessageBox::information(this, tr("Layout Failed"), message);
+}
+
 void GraphWidget::mouseMoveEvent(QMouseEvent *event)
 {
     if(event->modifiers() & Qt::SHIFT)
@@ -136,15 +184,24 @@ void GraphWidget::keyPressEvent(QKeyEvent *event)
     {
     case Qt::Key_0:
         if(event->modifiers() & Qt::CTRL)
+        {
             setTransform(QTransform());
+            _scene->viewportChanged();
+        }
         break;
     case Qt::Key_Plus:
         if(event->modifiers() & Qt::CTRL)
+        {
             scale(1.2,1.2);
+            _scene->viewportChanged();
+        }
         break;
     case Qt::Key_Minus:
         if(event->modifiers() & Qt::CTRL)
+        {
             scale(1/1.2, 1/1.2);
+            _scene->viewportChanged();
+        }
         break;
     default:
         QGraphicsView::keyPressEvent(event);
@@ -175,6 +232,19 @@ void GraphWidget::scaleView(qreal scaleFactor)
 
     scale(scaleFactor, scaleFactor);
     _scene->resizeToContents();
+    _scene->viewportChanged();
+}
+
+void GraphWidget::scrollContentsBy(int dx, int dy)
+{
+    QGraphicsView::scrollContentsBy(dx, dy);
+    _scene->viewportChanged();
+}
+
+void GraphWidget::resizeEvent(QResizeEvent *event)
+{
+    QGraphicsView::resizeEvent(event);
+    _scene->viewportChanged();
 }
 
 void GraphWidget::focusInEvent(QFocusEvent *event)
@@ -8,6 +8,8 @@
 
 #include "global.hpp"
 
+class QProgressDialog;
+
 namespace Developer {
 
 class Graph;
@@ -19,6 +21,9 @@ class GraphScene;
  * This widget provides a wrapper around the graph visualisation code in GP
  * Developer. It contains a graphics view with NodeItem and EdgeItem objects
  * tied to the Graph passed to the widget.
+ *
+ * Layouts are computed in the background. Should one take a while the widget
+ * shows a progress dialog from which it may be cancelled.
  */
 class GraphWidget : public QGraphicsView
 {
@@ -44,6 +49,7 @@ public:
     void layoutDavidsonHarel();
     void layoutFMMM();
     void layoutGEM();
+    void layoutIncremental();
 
 protected:
     void mouseMoveEvent(QMouseEvent *event);
@@ -51,16 +57,25 @@ protected:
     void keyReleaseEvent(QKeyEvent *event);
     void wheelEvent(QWheelEvent *event);
     void scaleView(qreal scaleFactor);
+    // Let a virtualised scene know which part of it is shown
+    void scrollContentsBy(int dx, int dy);
+    void resizeEvent(QResizeEvent *event);
 
     void focusInEvent(QFocusEvent *event);
     void focusOutEvent(QFocusEvent *event);
 
+protected slots:
+    void layoutStarted();
+    void layoutFinished();
+    void layoutFailed(QString message);
+
 signals:
     void graphHasFocus(GraphWidget *graphWidget);
     void graphLostFocus(GraphWidget *graphWidget);
 
 private:
     GraphScene *_scene;
+    QProgressDialog *_layoutProgress;
 };
 
 }
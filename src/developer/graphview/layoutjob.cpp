@@ -0,0 +1,569 @@
+/*!
+ * \file
+ */
+#include "layoutjob.hpp"
+
+#include <ogdf/basic/basic.h>
+#include <ogdf/basic/Graph.h>
+#include <ogdf/basic/GraphAttributes.h>
+#include <ogdf/tree/TreeLayout.h>
+#include <ogdf/layered/SugiyamaLayout.h>
+#include <ogdf/tree/RadialTreeLayout.h>
+#include <ogdf/planarlayout/FPPLayout.h>
+#include <ogdf/planarlayout/PlanarDrawLayout.h>
+#include <ogdf/planarlayout/PlanarStraightLayout.h>
+#include <ogdf/planarlayout/SchnyderLayout.h>
+#include <ogdf/planarity/PlanarizationGridLayout.h>
+#include <ogdf/layered/FastHierarchyLayout.h>
+#include <ogdf/misclayout/CircularLayout.h>
+#include <ogdf/energybased/SpringEmbedderFR.h>
+#include <ogdf/energybased/DavidsonHarelLayout.h>
+#include <ogdf/energybased/FMMMLayout.h>
+#include <ogdf/energybased/GEMLayout.h>
+
+#include "spatialgrid.hpp"
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QQueue>
+#include <QSet>
+#include <QDebug>
+#include <qmath.h>
+
+namespace Developer {
+
+using ogdf::GraphAttributes;
+
+namespace {
+
+// OGDF's memory pools and static state are not safe to use from several
+// threads at once
+QMutex ogdfMutex;
+
+// Every job which has not been deleted yet, for LayoutJob::waitForAll()
+QSet<LayoutJob *> liveJobs;
+
+// Preferred distance between the centres of joined nodes in an incremental
+// layout, how far apart nodes must be before they stop repelling each other,
+// and how many times the free nodes are moved
+const qreal IncrementalLength = 80.0;
+const qreal IncrementalReach = 2*IncrementalLength;
+const int IncrementalIterations = 50;
+// Successive nodes seeded around the same neighbours are turned by this many
+// radians, so they do not land on top of one another
+const qreal GoldenAngle = 2.39996323;
+
+void callLayout(LayoutJob::Algorithm algorithm, LayoutDirections direction,
+                GraphAttributes &ga)
+{
+    switch(algorithm)
+    {
+    case LayoutJob::Algorithm_Tree:
+    {
+        ogdf::TreeLayout tree;
+        tree.siblingDistance(40.0);
+        tree.subtreeDistance(30.0);
+        tree.levelDistance(60.0);
+        tree.treeDistance(60.0);
+
+        switch(direction)
+        {
+        case Layout_RightToLeft:
+            tree.orientation(ogdf::rightToLeft);
+            break;
+        case Layout_BottomToTop:
+            tree.orientation(ogdf::bottomToTop);
+            break;
+        case Layout_LeftToRight:
+            tree.orientation(ogdf::leftToRight);
+            break;
+        case Layout_TopToBottom:
+        default:
+            tree.orientation(ogdf::topToBottom);
+            break;
+        }
+
+        tree.call(ga);
+        break;
+    }
+    case LayoutJob::Algorithm_Sugiyama:
+    {
+        ogdf::SugiyamaLayout sugiyama;
+
+        ogdf::FastHierarchyLayout *fhl = new ogdf::FastHierarchyLayout;
+        fhl->layerDistance(45.0);
+        fhl->nodeDistance(30.0);
+        sugiyama.setLayout(fhl);
+
+        sugiyama.call(ga);
+        break;
+    }
+    case LayoutJob::Algorithm_RadialTree:
+    {
+        ogdf::RadialTreeLayout radialTree;
+        radialTree.levelDistance(60.0);
+        radialTree.connectedComponentDistance(60.0);
+
+        radialTree.call(ga);
+        break;
+    }
+    case LayoutJob::Algorithm_FPP:
+    {
+        ogdf::FPPLayout fpp;
+        fpp.call(ga);
+        break;
+    }
+    case LayoutJob::Algorithm_PlanarDraw:
+    {
+        ogdf::PlanarDrawLayout planarDraw;
+        planarDraw.call(ga);
+        break;
+    }
+    case LayoutJob::Algorithm_PlanarStraight:
+    {
+        ogdf::PlanarStraightLayout planarStraight;
+        planarStraight.call(ga);
+        break;
+    }
+    case LayoutJob::Algorithm_Schnyder:
+    {
+        ogdf::SchnyderLayout schnyder;
+        schnyder.call(ga);
+        break;
+    }
+    case LayoutJob::Algorithm_PlanarizationGrid:
+    {
+        ogdf::PlanarizationGridLayout planarGrid;
+        planarGrid.separation(50.0);
+
+        planarGrid.call(ga);
+        break;
+    }
+    case LayoutJob::Algorithm_Circular:
+    {
+        ogdf::CircularLayout circular;
+        circular.minDistCircle(50.0);
+        circular.minDistLevel(50.0);
+        circular.minDistSibling(35.0);
+        circular.minDistCC(50.0);
+
+        circular.call(ga);
+        break;
+    }
+    case LayoutJob::Algorithm_Spring:
+    {
+        ogdf::SpringEmbedderFR spring;
+        spring.minDistCC(40.0);
+        spring.scaleFunctionFactor(5.0);
+
+        spring.call(ga);
+        break;
+    }
+    case LayoutJob::Algorithm_DavidsonHarel:
+    {
+        ogdf::DavidsonHarelLayout dh;
+        dh.call(ga);
+        break;
+    }
+    case LayoutJob::Algorithm_FMMM:
+    {
+        ogdf::FMMMLayout fmmm;
+        fmmm.call(ga);
+        break;
+    }
+    case LayoutJob::Algorithm_GEM:
+    {
+        ogdf::GEMLayout gem;
+        gem.call(ga);
+        break;
+    }
+    default:
+        qDebug() << "LayoutJob: Unknown algorithm" << algorithm;
+        break;
+    }
+}
+
+}
+
+LayoutJob::LayoutJob(Algorithm algorithm, QObject *parent)
+    : QThread(parent)
+    , _algorithm(algorithm)
+    , _direction(DEFAULT_LAYOUT_DIRECTION)
+    , _rowOriginSet(false)
+    , _succeeded(false)
+    , _cancelled(false)
+{
+    liveJobs.insert(this);
+}
+
+LayoutJob::~LayoutJob()
+{
+    liveJobs.remove(this);
+}
+
+LayoutJob::Algorithm LayoutJob::algorithm() const
+{
+    return _algorithm;
+}
+
+qreal LayoutJob::incrementalLength()
+{
+    return IncrementalLength;
+}
+
+qreal LayoutJob::incrementalReach()
+{
+    return IncrementalReach;
+}
+
+void LayoutJob::setDirection(LayoutDirections direction)
+{
+    _direction = direction;
+}
+
+int LayoutJob::addNode(const QString &id, const QPointF &pos,
+                       const QSizeF &size, bool fixed)
+{
+    _ids.append(id);
+    _positions.append(pos);
+    _sizes.append(size);
+    _fixed.append(fixed);
+    return _ids.count() - 1;
+}
+
+void LayoutJob::addEdge(int from, int to)
+{
+    _edges.append(QPair<int, int>(from, to));
+}
+
+void LayoutJob::setRowOrigin(const QPointF &origin)
+{
+    _rowOrigin = origin;
+    _rowOriginSet = true;
+}
+
+int LayoutJob::nodeCount() const
+{
+    return _ids.count();
+}
+
+QString LayoutJob::nodeId(int index) const
+{
+    return _ids.at(index);
+}
+
+bool LayoutJob::isFixed(int index) const
+{
+    return _fixed.at(index);
+}
+
+QPointF LayoutJob::position(int index) const
+{
+    return _positions.at(index);
+}
+
+void LayoutJob::compute()
+{
+    // Does not touch OGDF, so need not wait for other layouts
+    if(_algorithm == Algorithm_Incremental)
+    {
+        if(!_cancelled)
+            computeIncremental();
+        return;
+    }
+
+    QMutexLocker locker(&ogdfMutex);
+
+    // Abandoned whilst waiting for another layout
+    if(_cancelled)
+        return;
+
+    ogdf::Graph g;
+    GraphAttributes ga(g, GraphAttributes::nodeGraphics
+                       | GraphAttributes::edgeGraphics);
+
+    QVector<ogdf::node> nodes(_ids.count());
+    for(int i = 0; i < _ids.count(); ++i)
+    {
+        ogdf::node ogdfNode = g.newNode();
+        ga.x(ogdfNode) = _positions.at(i).x();
+        ga.y(ogdfNode) = _positions.at(i).y();
+        ga.width(ogdfNode) = _sizes.at(i).width();
+        ga.height(ogdfNode) = _sizes.at(i).height();
+        nodes[i] = ogdfNode;
+    }
+
+    for(int i = 0; i < _edges.count(); ++i)
+        g.newEdge(nodes.at(_edges.at(i).first), nodes.at(_edges.at(i).second));
+
+    try
+    {
+        callLayout(_algorithm, _direction, ga);
+    }
+    catch(ogdf::Exception e)
+    {
+        Q_UNUSED(e)
+        _errorMessage = tr("The layout mechanism failed with a precondition "
+                           "error. Ensure that the layout mechanism selected "
+                           "is appropriate for the provided graph.");
+        return;
+    }
+
+    if(_cancelled)
+        return;
+
+    for(int i = 0; i < nodes.count(); ++i)
+        _positions[i] = QPointF(ga.x(nodes.at(i)), ga.y(nodes.at(i)));
+
+    _succeeded = true;
+}
+
+void LayoutJob::computeIncremental()
+{
+    int count = _ids.count();
+    QVector<QPointF> centres(count);
+    QVector<QSizeF> halves(count);
+    QVector<QVector<int> > neighbours(count);
+    QVector<int> free;
+    QRectF fixedBounds;
+
+    for(int i = 0; i < count; ++i)
+    {
+        halves[i] = _sizes.at(i) / 2;
+        centres[i] = _positions.at(i) + QPointF(halves.at(i).width(),
+                                                halves.at(i).height());
+        if(_fixed.at(i))
+        {
+            QRectF rect(_positions.at(i), _sizes.at(i));
+            fixedBounds = fixedBounds.isNull() ? rect : fixedBounds.united(rect);
+        }
+        else
+            free.append(i);
+    }
+
+    for(int i = 0; i < _edges.count(); ++i)
+    {
+        int from = _edges.at(i).first;
+        int to = _edges.at(i).second;
+        // Loops do not pull a node anywhere
+        if(from == to)
+            continue;
+
+        neighbours[from].append(to);
+        neighbours[to].append(from);
+    }
+
+    // Seed each free node among its placed neighbours, working outwards from
+    // the fixed nodes so that chains of new nodes follow on from one another
+    QVector<bool> placed(_fixed);
+    QVector<bool> queued(count, false);
+    QQueue<int> queue;
+    for(int i = 0; i < free.count(); ++i)
+    {
+        int node = free.at(i);
+        const QVector<int> &adjacent = neighbours.at(node);
+        for(int j = 0; j < adjacent.count(); ++j)
+        {
+            if(_fixed.at(adjacent.at(j)))
+            {
+                queue.enqueue(node);
+                queued[node] = true;
+                break;
+            }
+        }
+    }
+
+    // Nodes with no path to a fixed node are put in a row beside the graph,
+    // one component after another
+    QPointF slot;
+    if(_rowOriginSet)
+        slot = _rowOrigin;
+    else if(!fixedBounds.isNull())
+        slot = QPointF(fixedBounds.right() + IncrementalLength,
+                       fixedBounds.top());
+    bool inRow = false;
+    int seeded = 0;
+    int next = 0;
+
+    forever
+    {
+        while(!queue.isEmpty())
+        {
+            int node = queue.dequeue();
+            const QVector<int> &adjacent = neighbours.at(node);
+
+            QPointF barycentre;
+            int anchors = 0;
+            for(int j = 0; j < adjacent.count(); ++j)
+            {
+                if(placed.at(adjacent.at(j)))
+                {
+                    barycentre += centres.at(adjacent.at(j));
+                    ++anchors;
+                }
+            }
+
+            qreal angle = GoldenAngle * seeded++;
+            centres[node] = barycentre / anchors
+                    + QPointF(qCos(angle), qSin(angle)) * IncrementalLength;
+            placed[node] = true;
+
+            if(inRow)
+                slot.setX(qMax(slot.x(), centres.at(node).x()
+                               + halves.at(node).width() + IncrementalLength));
+
+            for(int j = 0; j < adjacent.count(); ++j)
+            {
+                int neighbour = adjacent.at(j);
+                if(!placed.at(neighbour) && !queued.at(neighbour))
+                {
+                    queue.enqueue(neighbour);
+                    queued[neighbour] = true;
+                }
+            }
+        }
+
+        while(next < free.count() && placed.at(free.at(next)))
+            ++next;
+        if(next == free.count())
+            break;
+
+        int node = free.at(next);
+        centres[node] = slot + QPointF(halves.at(node).width(),
+                                       halves.at(node).height());
+        placed[node] = true;
+        queued[node] = true;
+        inRow = true;
+        slot.setX(slot.x() + 2*halves.at(node).width() + IncrementalLength);
+
+        const QVector<int> &adjacent = neighbours.at(node);
+        for(int j = 0; j < adjacent.count(); ++j)
+        {
+            if(!queued.at(adjacent.at(j)))
+            {
+                queue.enqueue(adjacent.at(j));
+                queued[adjacent.at(j)] = true;
+            }
+        }
+    }
+
+    // Relax the free nodes: joined nodes attract, and every node within reach
+    // repels, found through a grid so the cost does not depend on the size of
+    // the graph. The fixed nodes are never moved.
+    SpatialGrid grid(IncrementalReach);
+    for(int i = 0; i < count; ++i)
+        grid.insert(i, QRectF(centres.at(i).x() - halves.at(i).width(),
+                              centres.at(i).y() - halves.at(i).height(),
+                              _sizes.at(i).width(), _sizes.at(i).height()));
+
+    qreal reach = IncrementalReach;
+    for(int iteration = 0; iteration < IncrementalIterations; ++iteration)
+    {
+        if(_cancelled)
+            return;
+
+        // Cool down, so the nodes settle rather than oscillate
+        qreal temperature = IncrementalLength/2
+                * (IncrementalIterations - iteration) / IncrementalIterations;
+
+        for(int i = 0; i < free.count(); ++i)
+        {
+            int node = free.at(i);
+            QPointF centre = centres.at(node);
+            QPointF force;
+
+            const QVector<int> &adjacent = neighbours.at(node);
+            for(int j = 0; j < adjacent.count(); ++j)
+            {
+                QPointF delta = centres.at(adjacent.at(j)) - centre;
+                qreal length = qSqrt(delta.x()*delta.x() + delta.y()*delta.y());
+                force += delta * (length / IncrementalLength);
+            }
+
+            QVector<int> near = grid.query(QRectF(centre.x() - reach,
+                                                  centre.y() - reach,
+                                                  2*reach, 2*reach));
+            for(int j = 0; j < near.count(); ++j)
+            {
+                if(near.at(j) == node)
+                    continue;
+
+                QPointF delta = centre - centres.at(near.at(j));
+                qreal length = qSqrt(delta.x()*delta.x() + delta.y()*delta.y());
+                if(length < 0.01)
+                {
+                    // Coincident, push apart in a direction particular to the
+                    // pair
+                    delta = QPointF(qCos(node + near.at(j)),
+                                    qSin(node + near.at(j)));
+                    length = 1;
+                }
+                force += delta * (IncrementalLength * IncrementalLength
+                                  / (length * length));
+            }
+
+            qreal length = qSqrt(force.x()*force.x() + force.y()*force.y());
+            if(length > temperature)
+                force *= temperature / length;
+
+            centres[node] = centre + force;
+            grid.move(node, QRectF(centres.at(node).x()
+                                   - halves.at(node).width(),
+                                   centres.at(node).y()
+                                   - halves.at(node).height(),
+                                   _sizes.at(node).width(),
+                                   _sizes.at(node).height()));
+        }
+    }
+
+    for(int i = 0; i < free.count(); ++i)
+    {
+        int node = free.at(i);
+        _positions[node] = centres.at(node) - QPointF(halves.at(node).width(),
+                                                      halves.at(node).height());
+    }
+
+    _succeeded = true;
+}
+
+bool LayoutJob::succeeded() const
+{
+    return _succeeded && !_cancelled;
+}
+
+QString LayoutJob::errorMessage() const
+{
+    return _errorMessage;
+}
+
+void LayoutJob::cancel()
+{
+    _cancelled = true;
+}
+
+bool LayoutJob::isCancelled() const
+{
+    return _cancelled;
+}
+
+void LayoutJob::waitForAll()
+{
+    for(QSet<LayoutJob *>::const_iterator iter = liveJobs.constBegin();
+        iter != liveJobs.constEnd(); ++iter)
+    {
+        LayoutJob *job = *iter;
+        if(!job->isRunning())
+            continue;
+
+        qDebug() << "Waiting for a layout to finish before exiting";
+        job->cancel();
+        job->wait();
+    }
+}
+
+void LayoutJob::run()
+{
+    compute();
+}
+
+}
@@ -0,0 +1,152 @@
+/*!
+ * \file
+ */
+#ifndef LAYOUTJOB_HPP
+#define LAYOUTJOB_HPP
+
+#include <QThread>
+#include <QVector>
+#include <QPair>
+#include <QPointF>
+#include <QSizeF>
+#include <QStringList>
+
+#include "global.hpp"
+
+namespace Developer {
+
+/*!
+ * \brief Runs one of the OGDF layouts, or an incremental layout, on a snapshot
+ *  of a graph
+ *
+ * GraphScene copies the ID, position and size of each node and the ends of
+ * each edge into the job, so the layout can be computed on another thread
+ * while the user carries on with the editor. Once the thread has finished the
+ * new positions are read back with nodeId() and position(), in the order the
+ * nodes were added.
+ *
+ * OGDF cannot be interrupted part way through a layout, so cancel() only marks
+ * the job as abandoned. The owner should stop waiting for it, a cancelled job
+ * does not produce positions. Only one OGDF layout is computed at a time
+ * across the whole application, later jobs wait for earlier ones to finish.
+ *
+ * Algorithm_Incremental does not use OGDF. It only moves the nodes which are
+ * not fixed, first putting each one among the nodes it is joined to and then
+ * relaxing them with a force model in which the fixed nodes attract their
+ * neighbours and repel anything close by. Its cost depends on the number of
+ * nodes which move and on how many nodes are near them, so the snapshot need
+ * only hold the free nodes, their neighbours and the nodes around them.
+ */
+class LayoutJob : public QThread
+{
+    Q_OBJECT
+
+public:
+    enum Algorithm
+    {
+        Algorithm_Tree,
+        Algorithm_Sugiyama,
+        Algorithm_RadialTree,
+        Algorithm_FPP,
+        Algorithm_PlanarDraw,
+        Algorithm_PlanarStraight,
+        Algorithm_Schnyder,
+        Algorithm_PlanarizationGrid,
+        Algorithm_Circular,
+        Algorithm_Spring,
+        Algorithm_DavidsonHarel,
+        Algorithm_FMMM,
+        Algorithm_GEM,
+        Algorithm_Incremental
+    };
+
+    explicit LayoutJob(Algorithm algorithm, QObject *parent = 0);
+    ~LayoutJob();
+
+    Algorithm algorithm() const;
+    //! Direction of Algorithm_Tree, ignored by the others
+    void setDirection(LayoutDirections direction);
+
+    /*!
+     * \brief Add a node to the snapshot
+     * \param pos   Top left corner of the node
+     * \param size  Size of the node's shape
+     * \param fixed True if Algorithm_Incremental must leave the node where it
+     *  is, the other algorithms move every node
+     * \return The node's index, for addEdge()
+     */
+    int addNode(const QString &id, const QPointF &pos, const QSizeF &size,
+                bool fixed = false);
+    void addEdge(int from, int to);
+    /*!
+     * \brief Set where Algorithm_Incremental starts the row of free nodes
+     *  which are not joined to any fixed node
+     *
+     * By default the row starts just right of the fixed nodes.
+     */
+    void setRowOrigin(const QPointF &origin);
+
+    //! Preferred distance between the centres of joined nodes in
+    //! Algorithm_Incremental
+    static qreal incrementalLength();
+    //! Distance within which Algorithm_Incremental pushes nodes apart
+    static qreal incrementalReach();
+
+    int nodeCount() const;
+    QString nodeId(int index) const;
+    bool isFixed(int index) const;
+    //! The node's position after the layout, or before it if it failed
+    QPointF position(int index) const;
+
+    /*!
+     * \brief Compute the layout on the calling thread
+     *
+     * run() calls this, it may also be called directly to lay out a graph
+     * without starting a thread.
+     */
+    void compute();
+
+    //! True if the layout was computed and not cancelled
+    bool succeeded() const;
+    //! Explanation suitable for showing to the user if the layout failed
+    QString errorMessage() const;
+
+    void cancel();
+    bool isCancelled() const;
+
+    /*!
+     * \brief Wait for every job which is still running to finish
+     *
+     * Nothing waits for a cancelled job, it runs until OGDF returns. This must
+     * be called before the application exits and OGDF's static state is torn
+     * down under it, main() connects it to QCoreApplication::aboutToQuit().
+     * Jobs are only created and destroyed on the GUI thread, which is the only
+     * thread this may be called from.
+     */
+    static void waitForAll();
+
+protected:
+    void run();
+
+private:
+    void computeIncremental();
+
+    Algorithm _algorithm;
+    LayoutDirections _direction;
+    QPointF _rowOrigin;
+    bool _rowOriginSet;
+
+    QStringList _ids;
+    QVector<QPointF> _positions;
+    QVector<QSizeF> _sizes;
+    QVector<bool> _fixed;
+    QVector<QPair<int, int> > _edges;
+
+    bool _succeeded;
+    QString _errorMessage;
+    volatile bool _cancelled;
+};
+
+}
+
+#endif // LAYOUTJOB_HPP
@@ -4,17 +4,19 @@
 #include "nodeitem.hpp"
 #include "node.hpp"
 #include "editnodedialog.hpp"
+#include "renderstyle.hpp"
 
 #include "graph.hpp"
 
 #include <QApplication>
 #include <QPainter>
 #include <QStyleOptionGraphicsItem>
-#include <QSettings>
 #include <QGraphicsSceneMouseEvent>
 #include <QGraphicsSceneHoverEvent>
 #include <QGraphicsScene>
 #include <QDebug>
+#include <QtAlgorithms>
+#include <qmath.h>
 
 namespace Developer {
 
@@ -32,10 +34,13 @@ NodeItem::NodeItem(Node *node, QGraphicsItem *parent)
 
     setAcceptHoverEvents(true);
 
-    setFlags(QGraphicsItem::ItemIsMovable | QGraphicsItem::ItemIsSelectable);
+    setFlags(QGraphicsItem::ItemIsMovable | QGraphicsItem::ItemIsSelectable
+             | QGraphicsItem::ItemSendsGeometryChanges);
 
-    connect(this, SIGNAL(xChanged()), this, SLOT(positionChanged()));
-    connect(this, SIGNAL(yChanged()), this, SLOT(positionChanged()));
+    connect(RenderStyle::instance(), SIGNAL(changed()),
+            this, SLOT(styleChanged()));
+
+    recalculate();
 
     if(node->isPhantomNode())
         setItemState(GraphItem_Deleted);
@@ -54,26 +59,25 @@ NodeItem::NodeItem(const QString &nodeId, const QString &nodeLabel, const QStrin
 
     setAcceptHoverEvents(true);
 
-    setFlags(QGraphicsItem::ItemIsMovable | QGraphicsItem::ItemIsSelectable);
+    setFlags(QGraphicsItem::ItemIsMovable | QGraphicsItem::ItemIsSelectable
+             | QGraphicsItem::ItemSendsGeometryChanges);
 
-    connect(this, SIGNAL(xChanged()), this, SLOT(positionChanged()));
-    connect(this, SIGNAL(yChanged()), this, SLOT(positionChanged()));
+    connect(RenderStyle::instance(), SIGNAL(changed()),
+            this, SLOT(styleChanged()));
+
+    recalculate();
 }
 
 void NodeItem::recalculate()
 {
-    _shape = QPainterPath();
-    _shape = shape();
+    prepareGeometryChange();
     _boundingRect = QRectF();
     _boundingRect = boundingRect();
+    _shape = QPainterPath();
+    _shape = shape();
     emit shapeChanged();
 }
 
-void NodeItem::addedEdge()
-{
-    emit edgeAdded();
-}
-
 bool NodeItem::isRoot() const
 {
     return _isRoot;
@@ -94,6 +98,22 @@ Node *NodeItem::node() const
     return _node;
 }
 
+void NodeItem::setNode(Node *node)
+{
+    // Set the fields directly, the setters would write them back to the node
+    _node = node;
+    _id = node->id();
+    _label = node->label();
+    _isRoot = node->isRoot();
+    _isInterface = node->isInterface();
+    _mark = node->mark();
+    _hover = false;
+    setItemState(node->isPhantomNode() ? GraphItem_Deleted : GraphItem_Normal);
+
+    recalculate();
+    update();
+}
+
 void NodeItem::setId(const QString &itemId)
 {
     GraphItem::setId(itemId);
@@ -159,15 +179,7 @@ QPainterPath NodeItem::shape() const
     if(!_shape.isEmpty())
         return _shape;
 
-    QSettings settings;
-    QFont font = settings.value("GraphView/Nodes/Font", qApp->font()
-                                ).value<QFont>();
-
-    QFontMetrics metrics(font);
-
-    QRectF rect = boundingRect();
-    // Leave space for the ID underneath
-    rect.setHeight(rect.height()-(1+metrics.height()+1));
+    QRectF rect = shapeRect();
     QPainterPath path;
     switch(_nodeShape)
     {
@@ -189,8 +201,7 @@ QPainterPath NodeItem::shape() const
 
     case RoundedRectangle:
     {
-        qreal radius = settings.value("GraphView/Nodes/CornerRadius", 6
-                                      ).toDouble();
+        qreal radius = RenderStyle::instance()->nodeCornerRadius();
         path.addRoundedRect(rect, radius, radius);
     }
         break;
@@ -199,84 +210,204 @@ QPainterPath NodeItem::shape() const
     return path;
 }
 
-QList<QPointF> NodeItem::intersection(QLineF line) const
+namespace {
+
+// A point where a line crosses a node's outline, t is how far along the line
+// it lies from 0 at p1 to 1 at p2
+struct Crossing
 {
-    QList<QPointF> intersectionPoints;
-    QPainterPath path = shape();
-    path.translate(scenePos());
-    QPolygonF polygon = path.toFillPolygon();
-    if(polygon.size() < 3)
+    qreal t;
+    QPointF point;
+};
+
+bool crossingBefore(const Crossing &a, const Crossing &b)
+{
+    return a.t < b.t;
+}
+
+void addCrossing(const QLineF &line, qreal t, QList<Crossing> *crossings)
+{
+    if(t < 0.0 || t > 1.0)
+        return;
+
+    Crossing crossing;
+    crossing.t = t;
+    crossing.point = line.pointAt(t);
+    *crossings << crossing;
+}
+
+// Solve for the points of the line on the ellipse with the given centre and
+// radii, keeping only those in the quarter given by xSign and ySign when they
+// are not 0
+void crossEllipse(const QLineF &line, const QPointF &centre, qreal rx, qreal ry,
+                  int xSign, int ySign, QList<Crossing> *crossings)
+{
+    if(rx <= 0.0 || ry <= 0.0)
+        return;
+
+    // Scale the ellipse to a unit circle about the origin
+    qreal x0 = (line.x1() - centre.x()) / rx;
+    qreal y0 = (line.y1() - centre.y()) / ry;
+    qreal dx = line.dx() / rx;
+    qreal dy = line.dy() / ry;
+
+    qreal a = dx*dx + dy*dy;
+    qreal b = 2 * (x0*dx + y0*dy);
+    qreal c = x0*x0 + y0*y0 - 1;
+    qreal discriminant = b*b - 4*a*c;
+    if(a == 0.0 || discriminant < 0.0)
+        return;
+
+    qreal root = qSqrt(discriminant);
+    qreal ts[2] = { (-b - root) / (2*a), (-b + root) / (2*a) };
+    for(int i = 0; i < (root == 0.0 ? 1 : 2); ++i)
     {
-        qDebug() << QString("Polygon is not two dimensional, only contains %1 "
-                            "points.").arg(polygon.size());
-        return intersectionPoints;
+        QPointF point = line.pointAt(ts[i]);
+        if(xSign != 0 && (point.x() - centre.x()) * xSign < 0)
+            continue;
+        if(ySign != 0 && (point.y() - centre.y()) * ySign < 0)
+            continue;
+        addCrossing(line, ts[i], crossings);
     }
+}
+
+// Crossings of a horizontal (or, with vertical set, vertical) side of a
+// rectangle at the given position, spanning from to to along the other axis
+void crossSide(const QLineF &line, qreal position, qreal from, qreal to,
+               bool vertical, QList<Crossing> *crossings)
+{
+    qreal start = vertical ? line.x1() : line.y1();
+    qreal delta = vertical ? line.dx() : line.dy();
+    if(delta == 0.0 || from > to)
+        return;
+
+    qreal t = (position - start) / delta;
+    if(t < 0.0 || t > 1.0)
+        return;
+
+    QPointF point = line.pointAt(t);
+    qreal along = vertical ? point.y() : point.x();
+    if(along >= from && along <= to)
+        addCrossing(line, t, crossings);
+}
+
+void crossRoundedRect(const QLineF &line, const QRectF &rect, qreal radius,
+                      QList<Crossing> *crossings)
+{
+    qreal r = qMax(qreal(0.0), qMin(radius,
+                                     qMin(rect.width(), rect.height()) / 2));
+
+    crossSide(line, rect.top(), rect.left() + r, rect.right() - r, false,
+              crossings);
+    crossSide(line, rect.bottom(), rect.left() + r, rect.right() - r, false,
+              crossings);
+    crossSide(line, rect.left(), rect.top() + r, rect.bottom() - r, true,
+              crossings);
+    crossSide(line, rect.right(), rect.top() + r, rect.bottom() - r, true,
+              crossings);
+
+    if(r <= 0.0)
+        return;
+
+    crossEllipse(line, QPointF(rect.left() + r, rect.top() + r), r, r, -1, -1,
+                 crossings);
+    crossEllipse(line, QPointF(rect.right() - r, rect.top() + r), r, r, 1, -1,
+                 crossings);
+    crossEllipse(line, QPointF(rect.left() + r, rect.bottom() - r), r, r, -1, 1,
+                 crossings);
+    crossEllipse(line, QPointF(rect.right() - r, rect.bottom() - r), r, r, 1, 1,
+                 crossings);
+}
+
+}
+
+QList<QPointF> NodeItem::intersection(QLineF line) const
+{
+    // The outline is solved for directly rather than flattened to a polygon,
+    // in the item's own coordinates where the shape is defined
+    QPointF offset = scenePos();
+    QLineF local = line.translated(-offset);
+    QRectF rect = shapeRect();
 
-    for(int i = 0; i < polygon.size(); ++i)
+    QList<Crossing> crossings;
+    switch(_nodeShape)
+    {
+    case Circle:
     {
-        QPointF p1 = polygon.at(i);
-        QPointF p2;
-        if(i == (polygon.size()-1))
-            p2 = polygon.at(0);
-        else
-            p2 = polygon.at(i+1);
-
-        QLineF shapeEdge = QLineF(p1, p2);
-
-        QPointF intersectPoint;
-        if(line.intersect(shapeEdge, &intersectPoint)
-                == QLineF::BoundedIntersection)
-            intersectionPoints << intersectPoint;
+        qreal radius = qMin(rect.width(), rect.height()) / 2;
+        crossEllipse(local, QPointF(radius, radius), radius, radius, 0, 0,
+                     &crossings);
     }
+        break;
+
+    case Ellipse:
+        crossEllipse(local, rect.center(), rect.width()/2, rect.height()/2,
+                     0, 0, &crossings);
+        break;
+
+    case Rectangle:
+        crossRoundedRect(local, rect, 0.0, &crossings);
+        break;
+
+    case RoundedRectangle:
+        crossRoundedRect(local, rect,
+                         RenderStyle::instance()->nodeCornerRadius(),
+                         &crossings);
+        break;
+    }
+
+    // Nearest the start of the line first
+    qSort(crossings.begin(), crossings.end(), crossingBefore);
+
+    QList<QPointF> intersectionPoints;
+    for(int i = 0; i < crossings.count(); ++i)
+        intersectionPoints << crossings.at(i).point + offset;
 
     return intersectionPoints;
 }
 
 QPointF NodeItem::centerPos() const
 {
-    QSettings settings;
-    QFont font = settings.value("GraphView/Nodes/Font", qApp->font()
-                                ).value<QFont>();
-
-    QFontMetrics metrics(font);
-
-    QRectF rect = boundingRect();
-    // Leave space for the ID underneath
-    rect.setHeight(rect.height()-(1+metrics.height()+1));
+    QRectF rect = shapeRect();
     QPointF tmp = pos();
 
     return QPointF(tmp.x() + rect.width()/2,
                    tmp.y() + rect.height()/2);
 }
 
+QRectF NodeItem::shapeRect() const
+{
+    QRectF rect = boundingRect();
+    // Leave space for the ID underneath
+    rect.setHeight(rect.height()
+                   - (1+RenderStyle::instance()->nodeMetrics().height()+1));
+    return rect;
+}
+
 QRectF NodeItem::boundingRect() const
 {
     if(!_boundingRect.isEmpty())
         return _boundingRect;
 
-    QSettings settings;
-    qreal topPadding    = settings.value("GraphView/Nodes/Padding/Top", 6
-                                         ).toDouble();
-    qreal rightPadding  = settings.value("GraphView/Nodes/Padding/Right", 8
-                                         ).toDouble();
-    qreal bottomPadding = settings.value("GraphView/Nodes/Padding/Bottom", 6
-                                         ).toDouble();
-    qreal leftPadding   = settings.value("GraphView/Nodes/Padding/Left", 8
-                                         ).toDouble();
-    qreal borderWidth = settings.value("GraphView/Nodes/Borders/Width", 2
-                                       ).toDouble();
-    QFont font = settings.value("GraphView/Nodes/Font", qApp->font()
-                                ).value<QFont>();
-
-    QFontMetrics metrics(font);
+    return boundingRectFor(label(), _isRoot);
+}
 
-    if(_isRoot)
+QRectF NodeItem::boundingRectFor(const QString &label, bool root)
+{
+    const RenderStyle *style = RenderStyle::instance();
+    const QFontMetrics &metrics = style->nodeMetrics();
+    qreal borderWidth = style->nodeBorderWidth();
+
+    if(root)
         borderWidth *= 1.5;
 
-    qreal width  = borderWidth + leftPadding + metrics.width( (label() != "" )? label() : QString("a"))     // Minimum label width is 1
-            + rightPadding + borderWidth;
-    qreal height = borderWidth + topPadding + metrics.height() + bottomPadding
-            + borderWidth + 1 + metrics.height() + 1;
+    qreal labelWidth = RenderStyle::instance()->textCache()->width(
+                style->nodeFont(), (label != "" )? label : QString("a"));    // Minimum label width is 1
+    qreal width  = borderWidth + style->nodeLeftPadding() + labelWidth
+            + style->nodeRightPadding() + borderWidth;
+    qreal height = borderWidth + style->nodeTopPadding() + metrics.height()
+            + style->nodeBottomPadding() + borderWidth + 1 + metrics.height()
+            + 1;
 
     return QRectF(0, 0, width, height);
 }
@@ -285,31 +416,31 @@ void NodeItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
                      QWidget *widget)
 {
     Q_UNUSED(widget);
-    QSettings settings;
-
-    qreal topPadding    = settings.value("GraphView/Nodes/Padding/Top", 6
-                                         ).toDouble();
-    qreal leftPadding   = settings.value("GraphView/Nodes/Padding/Left", 8
-                                         ).toDouble();
-    QFont font = settings.value("GraphView/Nodes/Font", qApp->font()
-                                ).value<QFont>();
-    QColor textColour = settings.value("GraphView/Nodes/TextColour",
-                                       QColor(0x11,0x11,0x11)
-                                         ).value<QColor>();
-    qreal borderWidth = settings.value("GraphView/Nodes/Borders/Width", 2
-                                       ).toDouble();
+    const RenderStyle *style = RenderStyle::instance();
+
+    qreal topPadding    = style->nodeTopPadding();
+    qreal leftPadding   = style->nodeLeftPadding();
+    QFont font = style->nodeFont();
+    QColor textColour = style->nodeTextColour();
+    qreal borderWidth = style->nodeBorderWidth();
 
     // Aha, switch to British English and now this symbols is not already
     // assigned, man, the UK is just better isn't it?
     QColor borderColour = borderColor(option);
     QColor bgColour = backgroundColor(option);
 
-    QFontMetrics metrics(font);
+    qreal detail = option->levelOfDetailFromTransform(painter->worldTransform());
+    if(detail < style->outlineDetail())
+    {
+        // The node is only a few pixels across, a box of its colour will do
+        painter->fillRect(shape().boundingRect(), borderColour);
+        return;
+    }
+
+    const QFontMetrics &metrics = style->nodeMetrics();
 
     if(_isRoot)
         borderWidth *= 1.5;
-    qreal textWidth  = metrics.width(label());
-    qreal textHeight = metrics.height();
 
     painter->setBrush(bgColour);
     QPen pen(borderColour);
@@ -333,12 +464,18 @@ void NodeItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
                       "is not permitted."));
     }
 
+    // Text too small to read is not worth laying out
+    if(detail < style->textDetail())
+        return;
+
+    // Labels are laid out once per font and text, and shared between items
+    TextCache *texts = RenderStyle::instance()->textCache();
+
     painter->setPen(textColour);
     painter->setFont(font);
-    painter->drawText(QRectF(leftPadding+borderWidth, topPadding+borderWidth,
-                             textWidth, textHeight),
-                      Qt::AlignCenter,
-                      label());
+    painter->drawStaticText(QPointF(leftPadding+borderWidth,
+                                    topPadding+borderWidth),
+                            texts->entry(font, label()).text);
 
     // Draw the node ID
     // ONLY IF RULE GRAPH
@@ -356,55 +493,28 @@ void NodeItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
         font.setWeight(QFont::Light);
     }
 
+    TextCache::Entry idText = texts->entry(font, id());
     painter->setPen(idColour);
     painter->setFont(font);
-    qreal xOffset = (pathRect.width()/2)-metrics.width(id())/2;
+    qreal xOffset = (pathRect.width()/2)-idText.width/2;
+    // The ID's baseline sits just below the node
     qreal yOffset = pathRect.height() + metrics.height() + 1;
-    painter->drawText(QPointF(xOffset, yOffset), id());
+    painter->drawStaticText(QPointF(xOffset, yOffset - idText.ascent),
+                            idText.text);
 }
 
 QColor NodeItem::backgroundColor(const QStyleOptionGraphicsItem *option) const
 {
-    QSettings settings;
+    const RenderStyle *style = RenderStyle::instance();
     QColor ret;
 
     if(option->state & QStyle::State_Selected)
     {
-        ret = settings.value("GraphView/Nodes/SelectedBackground",
-                              QColor(0xff,0xff,0xcc) // light yellow
-                              ).value<QColor>();
+        ret = style->nodeSelectedBackground();
     }
     else
     {
-        // default
-        ret = settings.value("GraphView/Nodes/Background",
-                             QColor(0xe9,0xe9,0xff) // light gray-ish
-                             ).value<QColor>();
-
-        if (_mark == "red")
-            ret = settings.value("GraphView/Nodes/Borders/ColourRed",
-                                 QColor(0xff,0x88,0x88) // light red
-                                 ).value<QColor>();
-
-        if (_mark == "green")
-            ret = settings.value("GraphView/Nodes/Borders/ColourGreen",
-                                 QColor(0x70,0xdb,0x70) // green
-                                 ).value<QColor>();
-
-        if (_mark == "blue")
-            ret = settings.value("GraphView/Nodes/Borders/ColourBlue",
-                                 QColor(0x33,0x85,0xff) // light blue
-                                 ).value<QColor>();
-
-        if (_mark == "grey")
-            ret = settings.value("GraphView/Nodes/Borders/ColourShaded",
-                                 QColor(0xb2,0xb2,0xb2) // light gray
-                                 ).value<QColor>();
-
-        if (_mark == "any")
-            ret = settings.value("GraphView/Nodes/Borders/ColourAny",
-                                 QColor(0xee,0x82,0xee) // purple-ish
-                                 ).value<QColor>();
+        ret = style->nodeBackground(_mark);
 
         if (_hover)
         {
@@ -432,41 +542,53 @@ QColor NodeItem::borderColor(const QStyleOptionGraphicsItem *option) const
 
 }
 
-void NodeItem::positionChanged()
+void NodeItem::styleChanged()
 {
-    if(_node != 0)
-        _node->setPos(pos());
+    recalculate();
+    update();
+}
+
+QVariant NodeItem::itemChange(GraphicsItemChange change, const QVariant &value)
+{
+    // Sent once per move however many coordinates changed, unlike xChanged()
+    // and yChanged()
+    if(change == ItemPositionHasChanged)
+    {
+        if(_node != 0)
+            _node->setPos(pos());
+        emit moved();
+    }
+
+    return GraphItem::itemChange(change, value);
 }
 
 void NodeItem::hoverEnterEvent(QGraphicsSceneHoverEvent *event)
 {
     QPainterPath path = shape();
     path.translate(scenePos());
-    if(path.contains(event->scenePos()))
-        _hover = true;
-    else
-        _hover = false;
-
-    update();
+    setHover(path.contains(event->scenePos()));
 }
 
 void NodeItem::hoverMoveEvent(QGraphicsSceneHoverEvent *event)
 {
     QPainterPath path = shape();
     path.translate(scenePos());
-    if(path.contains(event->scenePos()))
-        _hover = true;
-    else
-        _hover = false;
-
-    update();
+    setHover(path.contains(event->scenePos()));
 }
 
 void NodeItem::hoverLeaveEvent(QGraphicsSceneHoverEvent *event)
 {
     event->accept();
-    _hover = false;
+    setHover(false);
+}
+
+void NodeItem::setHover(bool hover)
+{
+    // Hover events arrive on every mouse move, only repaint on a change
+    if(hover == _hover)
+        return;
 
+    _hover = hover;
     update();
 }
 
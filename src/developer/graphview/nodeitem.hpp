@@ -36,6 +36,13 @@ public:
     bool isInterface() const;
     QString mark() const;
     Node *node() const;
+    /*!
+     * \brief Show a different node with this item
+     *
+     * Lets GraphScene reuse items rather than create new ones. The item should
+     * not be in a scene, and no edge should still be attached to it.
+     */
+    void setNode(Node *node);
 
     void setId(const QString &itemId);
     void setLabel(const QString &itemLabel);
@@ -47,27 +54,38 @@ public:
     void deleteNode();
 
     QPainterPath shape() const;
+    /*!
+     * \brief Find where a line crosses the outline of this node
+     * \param line  The line, in scene coordinates
+     * \return The crossing points in scene coordinates, nearest to the start
+     *  of the line first
+     */
     QList<QPointF> intersection(QLineF line) const;
 
     QPointF centerPos() const;
     QRectF boundingRect() const;
+    /*!
+     * \brief Get the bounding rectangle a node with this label would have,
+     *  without creating an item for it
+     */
+    static QRectF boundingRectFor(const QString &label, bool root = false);
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
                QWidget *widget);
 
     QColor backgroundColor(const QStyleOptionGraphicsItem *option) const;
     QColor borderColor(const QStyleOptionGraphicsItem *option) const;
 
-public slots:
-    void addedEdge();
-
 protected slots:
-    void positionChanged();
+    void styleChanged();
 
 signals:
-    void edgeAdded();
     void shapeChanged();
+    //! Emitted once each time the node is moved
+    void moved();
 
 protected:
+    QVariant itemChange(GraphicsItemChange change, const QVariant &value);
+
     // Handle hover events
     void hoverEnterEvent(QGraphicsSceneHoverEvent *event);
     void hoverMoveEvent(QGraphicsSceneHoverEvent *event);
@@ -77,6 +95,10 @@ protected:
     void mouseDoubleClickEvent(QGraphicsSceneMouseEvent *event);
 
 private:
+    //! The area of the node's shape, which leaves room for its ID underneath
+    QRectF shapeRect() const;
+    void setHover(bool hover);
+
     Node *_node;
     NodeShapes _nodeShape;
     bool _isRoot;
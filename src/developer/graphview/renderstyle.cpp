@@ -0,0 +1,258 @@
+/*!
+ * \file
+ */
+#include "renderstyle.hpp"
+
+#include <QApplication>
+#include <QSettings>
+
+namespace Developer {
+
+RenderStyle::RenderStyle(QObject *parent)
+    : QObject(parent)
+    , _nodeMetrics(qApp->font())
+    , _edgeMetrics(qApp->font())
+{
+    load();
+}
+
+RenderStyle *RenderStyle::instance()
+{
+    // Owned by the application so it outlives every graph view
+    static RenderStyle *style = 0;
+    if(style == 0)
+        style = new RenderStyle(qApp);
+
+    return style;
+}
+
+void RenderStyle::reload()
+{
+    QFont nodeFont = _nodeFont;
+    QFont edgeFont = _edgeFont;
+    load();
+
+    // Text is laid out per font, colours and sizes do not affect it
+    if(_nodeFont != nodeFont || _edgeFont != edgeFont)
+        _textCache.clear();
+
+    emit changed();
+}
+
+void RenderStyle::load()
+{
+    QSettings settings;
+
+    _nodeFont = settings.value("GraphView/Nodes/Font", qApp->font()
+                               ).value<QFont>();
+    _nodeMetrics = QFontMetrics(_nodeFont);
+    _nodeTopPadding = settings.value("GraphView/Nodes/Padding/Top", 6
+                                     ).toDouble();
+    _nodeRightPadding = settings.value("GraphView/Nodes/Padding/Right", 8
+                                       ).toDouble();
+    _nodeBottomPadding = settings.value("GraphView/Nodes/Padding/Bottom", 6
+                                        ).toDouble();
+    _nodeLeftPadding = settings.value("GraphView/Nodes/Padding/Left", 8
+                                      ).toDouble();
+    _nodeBorderWidth = settings.value("GraphView/Nodes/Borders/Width", 2
+                                      ).toDouble();
+    _nodeCornerRadius = settings.value("GraphView/Nodes/CornerRadius", 6
+                                       ).toDouble();
+    _nodeTextColour = settings.value("GraphView/Nodes/TextColour",
+                                     QColor(0x11,0x11,0x11)
+                                     ).value<QColor>();
+    _nodeSelectedBackground = settings.value(
+                "GraphView/Nodes/SelectedBackground",
+                QColor(0xff,0xff,0xcc) // light yellow
+                ).value<QColor>();
+    _nodeBackground = settings.value("GraphView/Nodes/Background",
+                                     QColor(0xe9,0xe9,0xff) // light gray-ish
+                                     ).value<QColor>();
+    _nodeRed = settings.value("GraphView/Nodes/Borders/ColourRed",
+                              QColor(0xff,0x88,0x88) // light red
+                              ).value<QColor>();
+    _nodeGreen = settings.value("GraphView/Nodes/Borders/ColourGreen",
+                                QColor(0x70,0xdb,0x70) // green
+                                ).value<QColor>();
+    _nodeBlue = settings.value("GraphView/Nodes/Borders/ColourBlue",
+                               QColor(0x33,0x85,0xff) // light blue
+                               ).value<QColor>();
+    _nodeGrey = settings.value("GraphView/Nodes/Borders/ColourShaded",
+                               QColor(0xb2,0xb2,0xb2) // light gray
+                               ).value<QColor>();
+    _nodeAny = settings.value("GraphView/Nodes/Borders/ColourAny",
+                              QColor(0xee,0x82,0xee) // purple-ish
+                              ).value<QColor>();
+
+    _edgeFont = settings.value("GraphView/Edges/Font", qApp->font()
+                               ).value<QFont>();
+    _edgeMetrics = QFontMetrics(_edgeFont);
+    _edgeArrowSize = settings.value("GraphView/Edges/ArrowSize", 9).toDouble();
+    _edgeLineWidth = settings.value("GraphView/Edges/LineWidth", 1.5
+                                    ).toDouble();
+    _edgeTextColour = settings.value("GraphView/Edges/TextColour",
+                                     QColor(0x33, 0x33, 0x33)).value<QColor>();
+    _edgeSelectedColour = settings.value("GraphView/Edges/SelectedColour",
+                                         QColor(0xcc,0xcc,0x33)
+                                         ).value<QColor>();
+    _edgeColour = settings.value("GraphView/Edges/Background",
+                                 QColor(0x11,0x11,0x11) // black
+                                 ).value<QColor>();
+    _edgeRed = settings.value("GraphView/Edges/ColourRed",
+                              QColor(0xee,0x77,0x77) // light red
+                              ).value<QColor>();
+    _edgeGreen = settings.value("GraphView/Edges/ColourGreen",
+                                QColor(0x60,0xcb,0x60) // green
+                                ).value<QColor>();
+    _edgeBlue = settings.value("GraphView/Edges/ColourBlue",
+                               QColor(0x22,0x70,0xee) // blue
+                               ).value<QColor>();
+    _edgeAny = settings.value("GraphView/Edges/ColourAny",
+                              QColor(0xee,0x82,0xee) // purple-ish
+                              ).value<QColor>();
+    _edgeDrawingColour = settings.value("GraphView/Edges/LineColour",
+                                        QColor(0x33,0x33,0x33)
+                                        ).value<QColor>();
+
+    _textDetail = settings.value("GraphView/Detail/Text", 0.5).toDouble();
+    _arrowDetail = settings.value("GraphView/Detail/Arrows", 0.3).toDouble();
+    _outlineDetail = settings.value("GraphView/Detail/Outline", 0.15
+                                    ).toDouble();
+}
+
+const QFont &RenderStyle::nodeFont() const
+{
+    return _nodeFont;
+}
+
+const QFontMetrics &RenderStyle::nodeMetrics() const
+{
+    return _nodeMetrics;
+}
+
+qreal RenderStyle::nodeTopPadding() const
+{
+    return _nodeTopPadding;
+}
+
+qreal RenderStyle::nodeRightPadding() const
+{
+    return _nodeRightPadding;
+}
+
+qreal RenderStyle::nodeBottomPadding() const
+{
+    return _nodeBottomPadding;
+}
+
+qreal RenderStyle::nodeLeftPadding() const
+{
+    return _nodeLeftPadding;
+}
+
+qreal RenderStyle::nodeBorderWidth() const
+{
+    return _nodeBorderWidth;
+}
+
+qreal RenderStyle::nodeCornerRadius() const
+{
+    return _nodeCornerRadius;
+}
+
+const QColor &RenderStyle::nodeTextColour() const
+{
+    return _nodeTextColour;
+}
+
+const QColor &RenderStyle::nodeSelectedBackground() const
+{
+    return _nodeSelectedBackground;
+}
+
+const QColor &RenderStyle::nodeBackground(const QString &mark) const
+{
+    if(mark == "red")
+        return _nodeRed;
+    if(mark == "green")
+        return _nodeGreen;
+    if(mark == "blue")
+        return _nodeBlue;
+    if(mark == "grey")
+        return _nodeGrey;
+    if(mark == "any")
+        return _nodeAny;
+
+    return _nodeBackground;
+}
+
+const QFont &RenderStyle::edgeFont() const
+{
+    return _edgeFont;
+}
+
+const QFontMetrics &RenderStyle::edgeMetrics() const
+{
+    return _edgeMetrics;
+}
+
+qreal RenderStyle::edgeArrowSize() const
+{
+    return _edgeArrowSize;
+}
+
+qreal RenderStyle::edgeLineWidth() const
+{
+    return _edgeLineWidth;
+}
+
+const QColor &RenderStyle::edgeTextColour() const
+{
+    return _edgeTextColour;
+}
+
+const QColor &RenderStyle::edgeSelectedColour() const
+{
+    return _edgeSelectedColour;
+}
+
+const QColor &RenderStyle::edgeColour(const QString &mark) const
+{
+    if(mark == "red")
+        return _edgeRed;
+    if(mark == "green")
+        return _edgeGreen;
+    if(mark == "blue")
+        return _edgeBlue;
+    if(mark == "any")
+        return _edgeAny;
+
+    return _edgeColour;
+}
+
+const QColor &RenderStyle::edgeDrawingColour() const
+{
+    return _edgeDrawingColour;
+}
+
+qreal RenderStyle::textDetail() const
+{
+    return _textDetail;
+}
+
+qreal RenderStyle::arrowDetail() const
+{
+    return _arrowDetail;
+}
+
+qreal RenderStyle::outlineDetail() const
+{
+    return _outlineDetail;
+}
+
+TextCache *RenderStyle::textCache()
+{
+    return &_textCache;
+}
+
+}
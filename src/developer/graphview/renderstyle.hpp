@@ -0,0 +1,139 @@
+/*!
+ * \file
+ */
+#ifndef RENDERSTYLE_HPP
+#define RENDERSTYLE_HPP
+
+#include "textcache.hpp"
+
+#include <QObject>
+#include <QFont>
+#include <QFontMetrics>
+#include <QColor>
+#include <QString>
+
+namespace Developer {
+
+/*!
+ * \brief Fonts, colours and sizes used to draw graphs, read from the settings
+ *
+ * NodeItem, EdgeItem and GraphScene consult the style whenever they measure
+ * or paint themselves, which for a large graph is many thousands of times per
+ * frame. Rather than each of those calls reading QSettings the values are read
+ * once into the shared instance() and only read again by reload(), which the
+ * appearance preferences call when they are applied. Items which cache their
+ * geometry listen to changed() to recalculate it.
+ *
+ * The style must only be used from the GUI thread.
+ */
+class RenderStyle : public QObject
+{
+    Q_OBJECT
+
+public:
+    static RenderStyle *instance();
+
+    const QFont &nodeFont() const;
+    const QFontMetrics &nodeMetrics() const;
+    qreal nodeTopPadding() const;
+    qreal nodeRightPadding() const;
+    qreal nodeBottomPadding() const;
+    qreal nodeLeftPadding() const;
+    qreal nodeBorderWidth() const;
+    qreal nodeCornerRadius() const;
+    const QColor &nodeTextColour() const;
+    const QColor &nodeSelectedBackground() const;
+    /*!
+     * \brief Get the background of a node with the given mark
+     * \param mark  The node's mark, eg. "red", or "none"
+     */
+    const QColor &nodeBackground(const QString &mark) const;
+
+    const QFont &edgeFont() const;
+    const QFontMetrics &edgeMetrics() const;
+    qreal edgeArrowSize() const;
+    qreal edgeLineWidth() const;
+    const QColor &edgeTextColour() const;
+    const QColor &edgeSelectedColour() const;
+    /*!
+     * \brief Get the line colour of an edge with the given mark
+     * \param mark  The edge's mark, eg. "red", or "none"
+     */
+    const QColor &edgeColour(const QString &mark) const;
+    //! Colour of the edge the user is drawing, before it is made translucent
+    const QColor &edgeDrawingColour() const;
+
+    /*!
+     * \brief Scale below which labels and IDs are not drawn
+     *
+     * The detail thresholds are compared with the level of detail of the
+     * painter, which is 1 at 100% zoom. Each one should be lower than the
+     * last: first text is dropped, then arrowheads, then below
+     * outlineDetail() nodes become plain boxes and edges straight hairlines.
+     */
+    qreal textDetail() const;
+    //! Scale below which edges are drawn without arrowheads
+    qreal arrowDetail() const;
+    //! Scale below which nodes and edges are drawn as simply as possible
+    qreal outlineDetail() const;
+
+    /*!
+     * \brief Get the layouts of label text in the node and edge fonts
+     *
+     * Emptied by reload() if either font has changed.
+     */
+    TextCache *textCache();
+
+public slots:
+    /*!
+     * \brief Read every value from the settings again and emit changed()
+     */
+    void reload();
+
+signals:
+    void changed();
+
+private:
+    explicit RenderStyle(QObject *parent = 0);
+    void load();
+
+    QFont _nodeFont;
+    QFontMetrics _nodeMetrics;
+    qreal _nodeTopPadding;
+    qreal _nodeRightPadding;
+    qreal _nodeBottomPadding;
+    qreal _nodeLeftPadding;
+    qreal _nodeBorderWidth;
+    qreal _nodeCornerRadius;
+    QColor _nodeTextColour;
+    QColor _nodeSelectedBackground;
+    QColor _nodeBackground;
+    QColor _nodeRed;
+    QColor _nodeGreen;
+    QColor _nodeBlue;
+    QColor _nodeGrey;
+    QColor _nodeAny;
+
+    QFont _edgeFont;
+    QFontMetrics _edgeMetrics;
+    qreal _edgeArrowSize;
+    qreal _edgeLineWidth;
+    QColor _edgeTextColour;
+    QColor _edgeSelectedColour;
+    QColor _edgeColour;
+    QColor _edgeRed;
+    QColor _edgeGreen;
+    QColor _edgeBlue;
+    QColor _edgeAny;
+    QColor _edgeDrawingColour;
+
+    qreal _textDetail;
+    qreal _arrowDetail;
+    qreal _outlineDetail;
+
+    TextCache _textCache;
+};
+
+}
+
+#endif // RENDERSTYLE_HPP
@@ -0,0 +1,208 @@
+/*!
+ * \file
+ */
+#include "spatialgrid.hpp"
+
+#include <qmath.h>
+
+namespace Developer {
+
+SpatialGrid::SpatialGrid(qreal cellSize)
+    : _cellSize(qMax(cellSize, qreal(1)))
+    , _stamp(0)
+{
+}
+
+qreal SpatialGrid::cellSize() const
+{
+    return _cellSize;
+}
+
+int SpatialGrid::count() const
+{
+    return _rects.count();
+}
+
+QRectF SpatialGrid::bounds() const
+{
+    return _bounds;
+}
+
+void SpatialGrid::clear(qreal cellSize)
+{
+    if(cellSize > 0)
+        _cellSize = qMax(cellSize, qreal(1));
+
+    _cells.clear();
+    _rects.clear();
+    _large.clear();
+    _bounds = QRectF();
+    _stamps.clear();
+    _stamp = 0;
+}
+
+void SpatialGrid::insert(int id, const QRectF &rect)
+{
+    Q_ASSERT(id >= 0);
+
+    if(id >= _rects.count())
+    {
+        _rects.resize(id + 1);
+        _stamps.resize(id + 1);
+    }
+    else if(!_rects.at(id).isNull())
+        unfile(id, _rects.at(id));
+
+    _rects[id] = rect;
+    file(id, rect);
+}
+
+void SpatialGrid::move(int id, const QRectF &rect)
+{
+    if(id < 0 || id >= _rects.count())
+        return;
+
+    insert(id, rect);
+}
+
+QRectF SpatialGrid::rect(int id) const
+{
+    if(id < 0 || id >= _rects.count())
+        return QRectF();
+
+    return _rects.at(id);
+}
+
+QVector<int> SpatialGrid::query(const QRectF &area) const
+{
+    QVector<int> result;
+    if(area.isEmpty() || _rects.isEmpty())
+        return result;
+
+    // Start a new query, wrapping around only means old stamps must go
+    if(++_stamp == 0)
+    {
+        _stamps.fill(0);
+        _stamp = 1;
+    }
+
+    collect(_large, area, &result);
+
+    int left = column(area.left());
+    int right = column(area.right());
+    int top = row(area.top());
+    int bottom = row(area.bottom());
+
+    // When zoomed out the area may span far more cells than are occupied,
+    // visit the occupied ones instead
+    qreal spanned = qreal(right - left + 1) * qreal(bottom - top + 1);
+    if(spanned > _cells.count())
+    {
+        for(QHash<Cell, QVector<int> >::const_iterator iter = _cells.begin();
+            iter != _cells.end(); ++iter)
+        {
+            const Cell &cell = iter.key();
+            if(cell.first >= left && cell.first <= right
+                    && cell.second >= top && cell.second <= bottom)
+                collect(iter.value(), area, &result);
+        }
+
+        return result;
+    }
+
+    for(int y = top; y <= bottom; ++y)
+    {
+        for(int x = left; x <= right; ++x)
+        {
+            QHash<Cell, QVector<int> >::const_iterator iter =
+                    _cells.find(Cell(x, y));
+            if(iter != _cells.end())
+                collect(iter.value(), area, &result);
+        }
+    }
+
+    return result;
+}
+
+int SpatialGrid::column(qreal x) const
+{
+    return qFloor(x / _cellSize);
+}
+
+int SpatialGrid::row(qreal y) const
+{
+    return qFloor(y / _cellSize);
+}
+
+bool SpatialGrid::isLarge(const QRectF &rect) const
+{
+    qreal columns = qreal(column(rect.right()) - column(rect.left()) + 1);
+    qreal rows = qreal(row(rect.bottom()) - row(rect.top()) + 1);
+    return columns * rows > MaxCells;
+}
+
+void SpatialGrid::file(int id, const QRectF &rect)
+{
+    if(rect.isNull())
+        return;
+
+    _bounds = _bounds.isNull() ? rect : _bounds.united(rect);
+
+    if(isLarge(rect))
+    {
+        _large.append(id);
+        return;
+    }
+
+    int right = column(rect.right());
+    int bottom = row(rect.bottom());
+    for(int y = row(rect.top()); y <= bottom; ++y)
+        for(int x = column(rect.left()); x <= right; ++x)
+            _cells[Cell(x, y)].append(id);
+}
+
+void SpatialGrid::unfile(int id, const QRectF &rect)
+{
+    if(isLarge(rect))
+    {
+        int index = _large.indexOf(id);
+        if(index >= 0)
+            _large.remove(index);
+        return;
+    }
+
+    int right = column(rect.right());
+    int bottom = row(rect.bottom());
+    for(int y = row(rect.top()); y <= bottom; ++y)
+    {
+        for(int x = column(rect.left()); x <= right; ++x)
+        {
+            QHash<Cell, QVector<int> >::iterator iter = _cells.find(Cell(x, y));
+            if(iter == _cells.end())
+                continue;
+
+            int index = iter->indexOf(id);
+            if(index >= 0)
+                iter->remove(index);
+            if(iter->isEmpty())
+                _cells.erase(iter);
+        }
+    }
+}
+
+void SpatialGrid::collect(const QVector<int> &ids, const QRectF &area,
+                          QVector<int> *result) const
+{
+    for(int i = 0; i < ids.count(); ++i)
+    {
+        int id = ids.at(i);
+        if(_stamps.at(id) == _stamp)
+            continue;
+
+        _stamps[id] = _stamp;
+        if(_rects.at(id).intersects(area))
+            result->append(id);
+    }
+}
+
+}
@@ -0,0 +1,86 @@
+/*!
+ * \file
+ */
+#ifndef SPATIALGRID_HPP
+#define SPATIALGRID_HPP
+
+#include <QHash>
+#include <QPair>
+#include <QRectF>
+#include <QVector>
+
+namespace Developer {
+
+/*!
+ * \brief Uniform grid of rectangles, for finding the elements of a graph which
+ *  lie in some area without any graphics items
+ *
+ * Each rectangle is identified by a non-negative integer id, normally its
+ * element's position in a vector kept by the caller, and is filed under every
+ * cell it covers. Rectangles covering more than MaxCells cells, such as long
+ * edges, are kept in a separate list which every query checks. Only occupied
+ * cells are stored, so the grid costs memory in proportion to the number of
+ * rectangles however far apart they are.
+ */
+class SpatialGrid
+{
+public:
+    //! Default width and height of a cell, in scene coordinates
+    static const int DefaultCellSize = 256;
+    //! Cells a rectangle may cover before it is treated as large
+    static const int MaxCells = 64;
+
+    explicit SpatialGrid(qreal cellSize = DefaultCellSize);
+
+    qreal cellSize() const;
+    //! Number of ids, one more than the highest inserted
+    int count() const;
+    /*!
+     * \brief Get the area covering every rectangle
+     *
+     * The bounds only ever grow, moving a rectangle inwards leaves them as
+     * they were until the grid is cleared.
+     */
+    QRectF bounds() const;
+
+    /*!
+     * \brief Empty the grid
+     * \param cellSize  Cell size to use from now on, 0 to keep the current one
+     */
+    void clear(qreal cellSize = 0);
+    void insert(int id, const QRectF &rect);
+    void move(int id, const QRectF &rect);
+    QRectF rect(int id) const;
+
+    /*!
+     * \brief Find the rectangles which intersect an area
+     * \return The ids of the rectangles, each once, in no particular order
+     */
+    QVector<int> query(const QRectF &area) const;
+
+private:
+    typedef QPair<int, int> Cell;
+
+    int column(qreal x) const;
+    int row(qreal y) const;
+    bool isLarge(const QRectF &rect) const;
+    void file(int id, const QRectF &rect);
+    void unfile(int id, const QRectF &rect);
+    void collect(const QVector<int> &ids, const QRectF &area,
+                 QVector<int> *result) const;
+
+    qreal _cellSize;
+    QHash<Cell, QVector<int> > _cells;
+    QVector<QRectF> _rects;
+    QVector<int> _large;
+    QRectF _bounds;
+
+    // Each query stamps the ids it has returned, so an id filed under several
+    // cells is only returned once without building a set
+    mutable QVector<quint32> _stamps;
+    mutable quint32 _stamp;
+};
+
+}
+
+#endif // SPATIALGRID_HPP
@@ -0,0 +1,60 @@
+/*!
+ * \file
+ */
+#include "textcache.hpp"
+
+#include <QFontMetricsF>
+#include <QTransform>
+
+namespace Developer {
+
+TextCache::TextCache(int capacity)
+    : _entries(capacity)
+{
+}
+
+int TextCache::capacity() const
+{
+    return _entries.maxCost();
+}
+
+void TextCache::setCapacity(int capacity)
+{
+    _entries.setMaxCost(qMax(capacity, 1));
+}
+
+TextCache::Entry TextCache::entry(const QFont &font, const QString &text)
+{
+    // QFont::key() identifies the font completely, the separator cannot occur
+    // in it
+    QString key = font.key() + QChar('\0') + text;
+    Entry *cached = _entries.object(key);
+    if(cached != 0)
+        return *cached;
+
+    QFontMetricsF metrics(font);
+    Entry *created = new Entry;
+    created->width = metrics.width(text);
+    created->height = metrics.height();
+    created->ascent = metrics.ascent();
+    created->text = QStaticText(text);
+    created->text.setTextFormat(Qt::PlainText);
+    created->text.setPerformanceHint(QStaticText::AggressiveCaching);
+    created->text.prepare(QTransform(), font);
+
+    Entry result = *created;
+    _entries.insert(key, created);
+    return result;
+}
+
+qreal TextCache::width(const QFont &font, const QString &text)
+{
+    return entry(font, text).width;
+}
+
+void TextCache::clear()
+{
+    _entries.clear();
+}
+
+}
@@ -0,0 +1,62 @@
+/*!
+ * \file
+ */
+#ifndef TEXTCACHE_HPP
+#define TEXTCACHE_HPP
+
+#include <QCache>
+#include <QFont>
+#include <QStaticText>
+#include <QString>
+
+namespace Developer {
+
+/*!
+ * \brief Measured and laid out label text, shared by every graph item
+ *
+ * Graphs tend to repeat the same few labels many times, and every item
+ * measures its text whenever its geometry is needed and lays it out again
+ * whenever it is painted. The cache keeps both per font and text, so each
+ * distinct label is only measured and laid out once. At most capacity()
+ * entries are kept, the least recently used are dropped first.
+ *
+ * The cache belongs to RenderStyle, which clears it when the fonts change.
+ */
+class TextCache
+{
+public:
+    /*!
+     * \brief A piece of text ready to be drawn in a particular font
+     */
+    struct Entry
+    {
+        qreal width;
+        qreal height;
+        //! Distance from the top of the text to its baseline
+        qreal ascent;
+        QStaticText text;
+    };
+
+    //! Default number of entries kept
+    static const int DefaultCapacity = 20000;
+
+    explicit TextCache(int capacity = DefaultCapacity);
+
+    int capacity() const;
+    void setCapacity(int capacity);
+
+    /*!
+     * \brief Get the layout of some text, measuring it if it is not cached
+     */
+    Entry entry(const QFont &font, const QString &text);
+    qreal width(const QFont &font, const QString &text);
+
+    void clear();
+
+private:
+    QCache<QString, Entry> _entries;
+};
+
+}
+
+#endif // TEXTCACHE_HPP
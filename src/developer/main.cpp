@@ -3,15 +3,25 @@
  */
 #include <QApplication>
 #include "mainwindow.hpp"
+#include "runprocess.hpp"
+#include "graphview/layoutjob.hpp"
 
 int main(int argc, char *argv[])
 {
+    // Commands of a run are started through the editor itself, see RunProcess
+    if(argc > 1 && qstrcmp(argv[1], Developer::RunProcess::WrapperOption) == 0)
+        return Developer::RunProcess::wrapperMain(argc, argv);
+
     QApplication a(argc, argv);
 
     a.setOrganizationName("UoYCS");
     a.setOrganizationDomain("www.cs.york.ac.uk");
     a.setApplicationName("GP Developer");
 
+    // OGDF must not be torn down under a layout still running
+    QObject::connect(&a, &QCoreApplication::aboutToQuit,
+                     &Developer::LayoutJob::waitForAll);
+
     qDebug () << "Starting application.";
 
     Developer::MainWindow w;
@@ -4,9 +4,6 @@
 #include "mainwindow.hpp"
 #include "ui_mainwindow.h"
 
-// We need OGDF's exceptions header to catch precondition errors
-#include <ogdf/basic/basic.h>
-
 // Include main page elements
 #include "welcome.hpp"
 #include "edit.hpp"
@@ -89,6 +86,16 @@ MainWindow::MainWindow(QWidget *parent)
                            );
 
     connect( _run , SIGNAL(obtainedResultGraph(QString, RunConfig*)), _results , SLOT(addResultGraph(QString, RunConfig*))  );
+    connect( _run,
+             SIGNAL(obtainedBatchResult(QString, QString, QString, int, qint64, RunConfig*)),
+             _results,
+             SLOT(addBatchResult(QString, QString, QString, int, qint64, RunConfig*)) );
+    connect( _ui->quickRunWidget, SIGNAL(runRequested(QString)),
+             _run, SLOT(queueRun(QString)) );
+    connect( _run,
+             SIGNAL(runStopped(QString, QString, RunConfig*)),
+             _results,
+             SLOT(addStoppedRun(QString, QString, RunConfig*)) );
 
 
     // No open project by default, so set that state
@@ -253,15 +260,15 @@ void MainWindow::setProject(Project *project)
     _edit->setProject(project);
     _run->setProject(project);
     _results->setProject(project);
-    //_ui->quickRunWidget->setProject(project);
+    _ui->quickRunWidget->setProject(project);
 }
 
 void MainWindow::setProjectActive(bool state)
 {
     if(state)
     {
-        // Hide the quick run widget
-        _ui->quickRunWidget->setVisible(false);
+        // Runs can be started from anywhere once a project is open
+        _ui->quickRunWidget->setVisible(true);
 
         // Enable all tabs
         _ui->tabWidget->setTabEnabled("default", 1, true);
@@ -535,20 +542,7 @@ void MainWindow::layoutTreeTopToBottom()
     if(_currentGraph == 0)
         return;
 
-    try
-    {
-        _currentGraph->layoutTree(Layout_TopToBottom);
-    }
-    catch(ogdf::Exception e)
-    {
-        Q_UNUSED(e)
-        QMessageBox::information(
-                    this,
-                    tr("Layout Failed"),
-                    tr("The layout mechanism failed with a precondition error. "
-                       "Ensure that the layout mechanism selected is "
-                       "appropriate for the provided graph."));
-    }
+    _currentGraph->layoutTree(Layout_TopToBottom);
 }
 
 void MainWindow::layoutTreeRightToLeft()
@@ -556,20 +550,7 @@ void MainWindow::layoutTreeRightToLeft()
     if(_currentGraph == 0)
         return;
 
-    try
-    {
-        _currentGraph->layoutTree(Layout_RightToLeft);
-    }
-    catch(ogdf::Exception e)
-    {
-        Q_UNUSED(e)
-        QMessageBox::information(
-                    this,
-                    tr("Layout Failed"),
-                    tr("The layout mechanism failed with a precondition error. "
-                       "Ensure that the layout mechanism selected is "
-                       "appropriate for the provided graph."));
-    }
+    _currentGraph->layoutTree(Layout_RightToLeft);
 }
 
 void MainWindow::layoutTreeBottomToTop()
@@ -577,20 +558,7 @@ void MainWindow::layoutTreeBottomToTop()
     if(_currentGraph == 0)
         return;
 
-    try
-    {
-        _currentGraph->layoutTree(Layout_BottomToTop);
-    }
-    catch(ogdf::Exception e)
-    {
-        Q_UNUSED(e)
-        QMessageBox::information(
-                    this,
-                    tr("Layout Failed"),
-                    tr("The layout mechanism failed with a precondition error. "
-                       "Ensure that the layout mechanism selected is "
-                       "appropriate for the provided graph."));
-    }
+    _currentGraph->layoutTree(Layout_BottomToTop);
 }
 
 void MainWindow::layoutTreeLeftToRight()
@@ -598,20 +566,7 @@ void MainWindow::layoutTreeLeftToRight()
     if(_currentGraph == 0)
         return;
 
-    try
-    {
-        _currentGraph->layoutTree(Layout_LeftToRight);
-    }
-    catch(ogdf::Exception e)
-    {
-        Q_UNUSED(e)
-        QMessageBox::information(
-                    this,
-                    tr("Layout Failed"),
-                    tr("The layout mechanism failed with a precondition error. "
-                       "Ensure that the layout mechanism selected is "
-                       "appropriate for the provided graph."));
-    }
+    _currentGraph->layoutTree(Layout_LeftToRight);
 }
 
 void MainWindow::layoutRadialTree()
@@ -619,20 +574,7 @@ void MainWindow::layoutRadialTree()
     if(_currentGraph == 0)
         return;
 
-    try
-    {
-        _currentGraph->layoutRadialTree();
-    }
-    catch(ogdf::Exception e)
-    {
-        Q_UNUSED(e)
-        QMessageBox::information(
-                    this,
-                    tr("Layout Failed"),
-                    tr("The layout mechanism failed with a precondition error. "
-                       "Ensure that the layout mechanism selected is "
-                       "appropriate for the provided graph."));
-    }
+    _currentGraph->layoutRadialTree();
 }
 
 void MainWindow::layoutSugiyama()
@@ -640,20 +582,7 @@ void MainWindow::layoutSugiyama()
     if(_currentGraph == 0)
         return;
 
-    try
-    {
-        _currentGraph->layoutSugiyama();
-    }
-    catch(ogdf::Exception e)
-    {
-        Q_UNUSED(e)
-        QMessageBox::information(
-                    this,
-                    tr("Layout Failed"),
-                    tr("The layout mechanism failed with a precondition error. "
-                       "Ensure that the layout mechanism selected is "
-                       "appropriate for the provided graph."));
-    }
+    _currentGraph->layoutSugiyama();
 }
 
 void MainWindow::layoutFPP()
@@ -661,20 +590,7 @@ void MainWindow::layoutFPP()
     if(_currentGraph == 0)
         return;
 
-    try
-    {
-        _currentGraph->layoutFPP();
-    }
-    catch(ogdf::Exception e)
-    {
-        Q_UNUSED(e)
-        QMessageBox::information(
-                    this,
-                    tr("Layout Failed"),
-                    tr("The layout mechanism failed with a precondition error. "
-                       "Ensure that the layout mechanism selected is "
-                       "appropriate for the provided graph."));
-    }
+    _currentGraph->layoutFPP();
 }
 
 void MainWindow::layoutPlanarDraw()
@@ -682,20 +598,7 @@ void MainWindow::layoutPlanarDraw()
     if(_currentGraph == 0)
         return;
 
-    try
-    {
-        _currentGraph->layoutPlanarDraw();
-    }
-    catch(ogdf::Exception e)
-    {
-        Q_UNUSED(e)
-        QMessageBox::information(
-                    this,
-                    tr("Layout Failed"),
-                    tr("The layout mechanism failed with a precondition error. "
-                       "Ensure that the layout mechanism selected is "
-                       "appropriate for the provided graph."));
-    }
+    _currentGraph->layoutPlanarDraw();
 }
 
 void MainWindow::layoutPlanarStraight()
@@ -703,20 +606,7 @@ void MainWindow::layoutPlanarStraight()
     if(_currentGraph == 0)
         return;
 
-    try
-    {
-        _currentGraph->layoutPlanarStraight();
-    }
-    catch(ogdf::Exception e)
-    {
-        Q_UNUSED(e)
-        QMessageBox::information(
-                    this,
-                    tr("Layout Failed"),
-                    tr("The layout mechanism failed with a precondition error. "
-                       "Ensure that the layout mechanism selected is "
-                       "appropriate for the provided graph."));
-    }
+    _currentGraph->layoutPlanarStraight();
 }
 
 void MainWindow::layoutSchnyder()
@@ -724,20 +614,7 @@ void MainWindow::layoutSchnyder()
     if(_currentGraph == 0)
         return;
 
-    try
-    {
-        _currentGraph->layoutSchnyder();
-    }
-    catch(ogdf::Exception e)
-    {
-        Q_UNUSED(e)
-        QMessageBox::information(
-                    this,
-                    tr("Layout Failed"),
-                    tr("The layout mechanism failed with a precondition error. "
-                       "Ensure that the layout mechanism selected is "
-                       "appropriate for the provided graph."));
-    }
+    _currentGraph->layoutSchnyder();
 }
 
 void MainWindow::layoutPlanarizationGrid()
@@ -745,20 +622,7 @@ void MainWindow::layoutPlanarizationGrid()
     if(_currentGraph == 0)
         return;
 
-    try
-    {
-        _currentGraph->layoutPlanarizationGrid();
-    }
-    catch(ogdf::Exception e)
-    {
-        Q_UNUSED(e)
-        QMessageBox::information(
-                    this,
-                    tr("Layout Failed"),
-                    tr("The layout mechanism failed with a precondition error. "
-                       "Ensure that the layout mechanism selected is "
-                       "appropriate for the provided graph."));
-    }
+    _currentGraph->layoutPlanarizationGrid();
 }
 
 void MainWindow::layoutCircular()
@@ -766,20 +630,7 @@ void MainWindow::layoutCircular()
     if(_currentGraph == 0)
         return;
 
-    try
-    {
-        _currentGraph->layoutCircular();
-    }
-    catch(ogdf::Exception e)
-    {
-        Q_UNUSED(e)
-        QMessageBox::information(
-                    this,
-                    tr("Layout Failed"),
-                    tr("The layout mechanism failed with a precondition error. "
-                       "Ensure that the layout mechanism selected is "
-                       "appropriate for the provided graph."));
-    }
+    _currentGraph->layoutCircular();
 }
 
 void MainWindow::layoutSpring()
@@ -787,20 +638,7 @@ void MainWindow::layoutSpring()
     if(_currentGraph == 0)
         return;
 
-    try
-    {
-        _currentGraph->layoutSpring();
-    }
-    catch(ogdf::Exception e)
-    {
-        Q_UNUSED(e)
-        QMessageBox::information(
-                    this,
-                    tr("Layout Failed"),
-                    tr("The layout mechanism failed with a precondition error. "
-                       "Ensure that the layout mechanism selected is "
-                       "appropriate for the provided graph."));
-    }
+    _currentGraph->layoutSpring();
 }
 
 void MainWindow::layoutDavidsonHarel()
@@ -808,20 +646,7 @@ void MainWindow::layoutDavidsonHarel()
     if(_currentGraph == 0)
         return;
 
-    try
-    {
-        _currentGraph->layoutDavidsonHarel();
-    }
-    catch(ogdf::Exception e)
-    {
-        Q_UNUSED(e)
-        QMessageBox::information(
-                    this,
-                    tr("Layout Failed"),
-                    tr("The layout mechanism failed with a precondition error. "
-                       "Ensure that the layout mechanism selected is "
-                       "appropriate for the provided graph."));
-    }
+    _currentGraph->layoutDavidsonHarel();
 }
 
 void MainWindow::layoutFMMM()
@@ -829,20 +654,7 @@ void MainWindow::layoutFMMM()
     if(_currentGraph == 0)
         return;
 
-    try
-    {
-        _currentGraph->layoutFMMM();
-    }
-    catch(ogdf::Exception e)
-    {
-        Q_UNUSED(e)
-        QMessageBox::information(
-                    this,
-                    tr("Layout Failed"),
-                    tr("The layout mechanism failed with a precondition error. "
-                       "Ensure that the layout mechanism selected is "
-                       "appropriate for the provided graph."));
-    }
+    _currentGraph->layoutFMMM();
 }
 
 void MainWindow::layoutGEM()
@@ -850,20 +662,15 @@ void MainWindow::layoutGEM()
     if(_currentGraph == 0)
         return;
 
-    try
-    {
-        _currentGraph->layoutGEM();
-    }
-    catch(ogdf::Exception e)
-    {
-        Q_UNUSED(e)
-        QMessageBox::information(
-                    this,
-                    tr("Layout Failed"),
-                    tr("The layout mechanism failed with a precondition error. "
-                       "Ensure that the layout mechanism selected is "
-                       "appropriate for the provided graph."));
-    }
+    _currentGraph->layoutGEM();
+}
+
+void MainWindow::layoutIncremental()
+{
+    if(_currentGraph == 0)
+        return;
+
+    _currentGraph->layoutIncremental();
 }
 
 void MainWindow::exportGraphToPng()
@@ -211,6 +211,7 @@ public slots:
     void layoutDavidsonHarel();
     void layoutFMMM();
     void layoutGEM();
+    void layoutIncremental();
 
     void exportGraphToPng();
     void exportGraphToSvg();
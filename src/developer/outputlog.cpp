@@ -0,0 +1,139 @@
+/*!
+ * \file
+ */
+#include "outputlog.hpp"
+
+#include <QStringList>
+#include <QDebug>
+
+#include <string.h>
+
+namespace Developer {
+
+OutputLog::OutputLog(int capacity)
+    : _start(0)
+    , _length(0)
+    , _size(0)
+{
+    setCapacity(capacity);
+}
+
+OutputLog::~OutputLog()
+{
+    close();
+}
+
+int OutputLog::capacity() const
+{
+    return _buffer.size();
+}
+
+void OutputLog::setCapacity(int capacity)
+{
+    capacity = qMax(capacity, 1);
+
+    // Keep as much of the existing output as still fits
+    QByteArray kept = tail().right(capacity);
+    _buffer = QByteArray(capacity, '\0');
+    memcpy(_buffer.data(), kept.constData(), kept.size());
+    _start = 0;
+    _length = kept.size();
+}
+
+bool OutputLog::open(const QString &filePath)
+{
+    close();
+    if(filePath.isEmpty())
+        return false;
+
+    _file.setFileName(filePath);
+    if(!_file.open(QFile::WriteOnly | QFile::Truncate))
+    {
+        qDebug() << "    Could not open output log for writing: " << filePath;
+        return false;
+    }
+
+    return true;
+}
+
+void OutputLog::close()
+{
+    if(_file.isOpen())
+        _file.close();
+}
+
+QString OutputLog::filePath() const
+{
+    return _file.fileName();
+}
+
+void OutputLog::append(const QByteArray &data)
+{
+    if(data.isEmpty())
+        return;
+
+    _size += data.size();
+    if(_file.isOpen())
+        _file.write(data);
+
+    // Anything longer than the buffer would only overwrite itself
+    int capacity = _buffer.size();
+    const char *source = data.constData();
+    int count = data.size();
+    if(count >= capacity)
+    {
+        source += count - capacity;
+        count = capacity;
+        _start = 0;
+        _length = 0;
+    }
+
+    int end = (_start + _length) % capacity;
+    int first = qMin(count, capacity - end);
+    memcpy(_buffer.data() + end, source, first);
+    memcpy(_buffer.data(), source + first, count - first);
+
+    _length += count;
+    if(_length > capacity)
+    {
+        _start = (_start + _length - capacity) % capacity;
+        _length = capacity;
+    }
+}
+
+void OutputLog::clear()
+{
+    _start = 0;
+    _length = 0;
+    _size = 0;
+}
+
+QByteArray OutputLog::tail() const
+{
+    int capacity = _buffer.size();
+    if(_start + _length <= capacity)
+        return _buffer.mid(_start, _length);
+
+    return _buffer.mid(_start) + _buffer.left(_start + _length - capacity);
+}
+
+QString OutputLog::lastLines(int lines) const
+{
+    QStringList all = QString::fromLocal8Bit(tail()).split('\n');
+    while(!all.isEmpty() && all.last().trimmed().isEmpty())
+        all.removeLast();
+
+    return QStringList(all.mid(qMax(0, all.count() - lines))).join("\n");
+}
+
+qint64 OutputLog::size() const
+{
+    return _size;
+}
+
+bool OutputLog::isTruncated() const
+{
+    return _size > _length;
+}
+
+}
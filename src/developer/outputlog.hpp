@@ -0,0 +1,75 @@
+/*!
+ * \file
+ */
+#ifndef OUTPUTLOG_HPP
+#define OUTPUTLOG_HPP
+
+#include <QByteArray>
+#include <QString>
+#include <QFile>
+
+namespace Developer {
+
+/*!
+ * \brief Record of process output which holds only a bounded amount in memory
+ *
+ * Programs run by the pipeline may produce any amount of output. Everything
+ * appended is written straight through to the log file, if one is open, while
+ * only the most recent capacity() bytes are kept in a ring buffer for display.
+ */
+class OutputLog
+{
+public:
+    //! Default number of bytes kept in memory
+    static const int DefaultCapacity = 256 * 1024;
+
+    explicit OutputLog(int capacity = DefaultCapacity);
+    ~OutputLog();
+
+    int capacity() const;
+    void setCapacity(int capacity);
+
+    /*!
+     * \brief Start writing everything appended to a file
+     *
+     * Any existing file at the path is replaced. Only output appended after
+     * this call is written.
+     *
+     * \param filePath  The log file, or an empty string to only keep output in
+     *  memory
+     * \return True if the file could be opened
+     */
+    bool open(const QString &filePath);
+    void close();
+    QString filePath() const;
+
+    void append(const QByteArray &data);
+    void clear();
+
+    /*!
+     * \brief Get the output still held in memory, oldest first
+     */
+    QByteArray tail() const;
+
+    /*!
+     * \brief Get the last few lines held in memory
+     * \param lines Maximum number of lines to return
+     */
+    QString lastLines(int lines) const;
+
+    //! Total number of bytes appended since the log was last cleared
+    qint64 size() const;
+    //! True if older output has been dropped from memory
+    bool isTruncated() const;
+
+private:
+    QByteArray _buffer;
+    int _start;
+    int _length;
+    qint64 _size;
+    QFile _file;
+};
+
+}
+
+#endif // OUTPUTLOG_HPP
@@ -9,6 +9,7 @@
 
 #include "programhighlighter.hpp"
 #include "graph.hpp"
+#include "graphview/renderstyle.hpp"
 
 namespace Developer {
 
@@ -148,6 +149,9 @@ void AppearancePreferences::reset()
 void AppearancePreferences::apply()
 {
     QSettings settings;
+
+    // Open graphs pick up any change to the graph appearance settings
+    RenderStyle::instance()->reload();
 }
 
 }
@@ -4,6 +4,11 @@
 #include "toolchainpreferences.hpp"
 #include "ui_toolchainpreferences.h"
 
+#include "runpipeline.hpp"
+
+#include <QDir>
+#include <QFileDialog>
+
 namespace Developer {
 
 ToolchainPreferences::ToolchainPreferences(QWidget *parent)
@@ -11,6 +16,8 @@ ToolchainPreferences::ToolchainPreferences(QWidget *parent)
     , _ui(new Ui::ToolchainPreferences)
 {
     _ui->setupUi(this);
+
+    reset();
 }
 
 ToolchainPreferences::~ToolchainPreferences()
@@ -20,12 +27,52 @@ ToolchainPreferences::~ToolchainPreferences()
 
 void ToolchainPreferences::reset()
 {
-    QSettings settings;
+    _ui->buildRootEdit->setText(
+                QDir::toNativeSeparators(
+                    _settings.value(
+                        "Run/BuildDirectoryRoot",
+                        RunPipeline::defaultBuildRoot()
+                        ).toString()
+                    )
+                );
+
+    // The combo box lists the policies in the order they are declared
+    _ui->buildCleanupCombo->setCurrentIndex(
+                _settings.value(
+                    "Run/BuildDirectoryCleanup",
+                    RunPipeline::Cleanup_OnSuccess
+                    ).toInt()
+                );
+
+    _ui->externalValidationCheckBox->setChecked(
+                _settings.value("Run/ExternalValidation", true).toBool());
 }
 
 void ToolchainPreferences::apply()
 {
-    QSettings settings;
+    QString root = _ui->buildRootEdit->text().trimmed();
+    if(root.isEmpty())
+        root = RunPipeline::defaultBuildRoot();
+
+    // The directory doesn't need to exist yet, each run creates it if needed
+    _settings.setValue("Run/BuildDirectoryRoot", QDir::fromNativeSeparators(root));
+    _settings.setValue("Run/BuildDirectoryCleanup",
+                       _ui->buildCleanupCombo->currentIndex());
+    _settings.setValue("Run/ExternalValidation",
+                       _ui->externalValidationCheckBox->isChecked());
+}
+
+void ToolchainPreferences::selectBuildRoot()
+{
+    QString dir = QFileDialog::getExistingDirectory(
+                this,
+                tr("Select Build Location"),
+                _ui->buildRootEdit->text()
+                );
+    dir = QDir::toNativeSeparators(dir);
+
+    if(!dir.isEmpty())
+        _ui->buildRootEdit->setText(dir);
 }
 
 }
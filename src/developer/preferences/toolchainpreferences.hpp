@@ -22,6 +22,9 @@ public:
 
     void reset();
     void apply();
+
+public slots:
+    void selectBuildRoot();
     
 private:
     Ui::ToolchainPreferences *_ui;
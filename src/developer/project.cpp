@@ -2,6 +2,8 @@
  * \file
  */
 #include "project.hpp"
+#include "validationcache.hpp"
+#include "runcache.hpp"
 
 #include <QMessageBox>
 #include <QDateTime>
@@ -20,6 +22,8 @@ Project::Project(const QString &projectPath, bool autoInitialise, QObject *paren
     , _nodeCount(0)
     , _edgeCount(0)
     , _error("")
+    , _validationCache(0)
+    , _runCache(0)
 {
     if(!projectPath.isEmpty() && autoInitialise)
        if  (!open(projectPath))
@@ -52,6 +56,18 @@ Project::~Project()
     for(runConfigIter iter = _runConfigurations.begin(); iter != _runConfigurations.end(); ++iter)
         delete *iter;
 
+    if(_validationCache != 0)
+    {
+        _validationCache->save();
+        delete _validationCache;
+    }
+
+    if(_runCache != 0)
+    {
+        _runCache->save();
+        delete _runCache;
+    }
+
 //    if (_currentFile != 0)
 //        delete _currentFile;
 }
@@ -306,6 +322,29 @@ QVector<RunConfig *> Project::runConfigurations() const
     return _runConfigurations;
 }
 
+ValidationCache *Project::validationCache()
+{
+    if(_validationCache == 0)
+    {
+        _validationCache = new ValidationCache(
+                    resultsDir().filePath("validation.cache"));
+        _validationCache->load();
+    }
+
+    return _validationCache;
+}
+
+RunCache *Project::runCache()
+{
+    if(_runCache == 0)
+    {
+        _runCache = new RunCache(resultsDir().filePath("runs.cache"));
+        _runCache->load();
+    }
+
+    return _runCache;
+}
+
 bool Project::hasUnsavedChanges() const
 {
     for(ruleConstIter iter = _rules.begin(); iter != _rules.end(); ++iter)
@@ -419,6 +458,10 @@ bool Project::open(const QString &projectPath)
                  << ", that might be bad!";
     }
 
+    // A missing or stale index only costs a full parse of every file
+    _index.setProjectPath(projectPath);
+    _index.load();
+
     //! \todo read in list of files (graphs, rules, programs, run configs)
     nodes = projectElement.childNodes();
     for(int i = 0; i < nodes.count(); ++i)
@@ -462,6 +505,19 @@ bool Project::open(const QString &projectPath)
     emit fileListChanged();
     emit runConfigurationListChanged();
 
+    // Drop entries for files no longer in the project and write back anything
+    // which had to be parsed
+    QStringList trackedFiles;
+    for(ruleConstIter iter = _rules.begin(); iter != _rules.end(); ++iter)
+        trackedFiles << (*iter)->absolutePath();
+    for(programConstIter iter = _programs.begin(); iter != _programs.end();
+        ++iter)
+        trackedFiles << (*iter)->absolutePath();
+    for(graphConstIter iter = _graphs.begin(); iter != _graphs.end(); ++iter)
+        trackedFiles << (*iter)->absolutePath();
+    _index.retain(trackedFiles);
+    _index.save();
+
     _null = false;
     _error = "";
     _status = GPFile::Normal;
@@ -493,7 +549,21 @@ bool Project::readRules(QDomNode &node)
             return false;
         }
 
-        Rule *r = new Rule(path);
+        // Rules whose fingerprint matches the index are listed straight away
+        // and parsed on first use
+        Rule *r = 0;
+        const ProjectIndex::Entry *cached = _index.entry(path);
+        if(cached != 0 && cached->type == "rule" && _index.isCurrent(path))
+        {
+            r = new Rule(path, 0, false);
+            r->setIndexedName(cached->name);
+        }
+        else
+        {
+            r = new Rule(path);
+            _index.updateRule(r);
+        }
+
         connect(r, SIGNAL(statusChanged(FileStatus)),
                 this, SLOT(trackRuleStatusChange(FileStatus))
                 );
@@ -528,6 +598,7 @@ bool Project::readPrograms(QDomNode &node)
         }
 
         Program *p = new Program(path);
+
         connect(p, SIGNAL(statusChanged(FileStatus)),
                 this, SLOT(trackProgramStatusChange(FileStatus))
                 );
@@ -565,9 +636,24 @@ bool Project::readGraphs(QDomNode &node)
         connect(g, SIGNAL(statusChanged(FileStatus)),
                 this, SLOT(trackGraphStatusChange(FileStatus))
                 );
-        connect(g, SIGNAL(nodeAdded(Node*)), this, SLOT(incrementNodeCount()));
-        connect(g, SIGNAL(edgeAdded(Edge*)), this, SLOT(incrementEdgeCount()));
-        g->open();
+
+        // Unchanged graphs are left unparsed until they are opened in an
+        // editor, the index supplies the counts for the progress dialog
+        const ProjectIndex::Entry *cached = _index.entry(path);
+        if(cached != 0 && cached->type == "graph" && _index.isCurrent(path))
+        {
+            _nodeCount += cached->nodeCount;
+            _edgeCount += cached->edgeCount;
+            emit nodeCountChanged(_nodeCount);
+            emit edgeCountChanged(_edgeCount);
+        }
+        else
+        {
+            connect(g, SIGNAL(nodeAdded(Node*)), this, SLOT(incrementNodeCount()));
+            connect(g, SIGNAL(edgeAdded(Edge*)), this, SLOT(incrementEdgeCount()));
+            g->open();
+            _index.updateGraph(g);
+        }
         _graphs.push_back(g);
         emit graphListChanged();
         emit fileListChanged();
@@ -618,6 +704,10 @@ bool Project::readRunConfigs(QDomNode &node)
 
         RunConfig *config = new RunConfig(this, name, program, graph);
 
+        // Optional, the host graphs used when the configuration is run as a
+        // batch
+        config->setBatchGraphs(elem.attribute("batch"));
+
         readRunConfigOptions(n, config);
         _runConfigurations.push_back(config);
         // emit runConfigurationListChanged();
@@ -635,10 +725,28 @@ void Project::readRunConfigOptions(QDomNode &node, RunConfig* config)
         QDomNode n = nodes.at(i);
         QDomElement elem = n.toElement();
 
+        // Resource limits on the executed program, missing means unlimited
+        if(elem.tagName() == "limits")
+        {
+            config->setTimeLimit(elem.attribute("time", "0").toInt());
+            config->setCpuLimit(elem.attribute("cpu", "0").toInt());
+            config->setMemoryLimit(elem.attribute("memory", "0").toInt());
+            continue;
+        }
+
+        // Repeated, measured executions instead of a single run
+        if(elem.tagName() == "benchmark")
+        {
+            config->setBenchmarkRuns(elem.attribute("runs", "0").toInt());
+            config->setWarmupRuns(elem.attribute("warmup", "0").toInt());
+            continue;
+        }
+
         if(elem.tagName() != "options")
         {
             qDebug() << "Ignoring unexpected tag: " << elem.tagName();
-            qDebug() << "GP Developer was expecting a: <options>";
+            qDebug() << "GP Developer was expecting a: <options>, <limits> or "
+                        "<benchmark>";
             continue;
         }
 
@@ -1287,6 +1395,25 @@ bool Project::save()
         configTag.setAttribute("name", config->name());
         configTag.setAttribute("program", config->program());
         configTag.setAttribute("graph", config->graph());
+        if (!config->batchGraphs().isEmpty())
+            configTag.setAttribute("batch", config->batchGraphs());
+
+        if (config->hasLimits())
+        {
+            QDomElement limits = doc.createElement("limits");
+            limits.setAttribute("time", config->timeLimit());
+            limits.setAttribute("cpu", config->cpuLimit());
+            limits.setAttribute("memory", config->memoryLimit());
+            configTag.appendChild(limits);
+        }
+
+        if (config->isBenchmark())
+        {
+            QDomElement benchmark = doc.createElement("benchmark");
+            benchmark.setAttribute("runs", config->benchmarkRuns());
+            benchmark.setAttribute("warmup", config->warmupRuns());
+            configTag.appendChild(benchmark);
+        }
 
         /*
         QDomElement configOptions = doc.createElement("options");
@@ -1447,8 +1574,13 @@ void Project::fileModified(QString filePath)
 
 void Project::trackRuleStatusChange(FileStatus status)
 {
-    Q_UNUSED(status)
     Rule *rule = static_cast<Rule *>(sender());
+    if(status == Normal && rule->isParsed())
+    {
+        _index.updateRule(rule);
+        _index.save();
+    }
+
     emit ruleStatusChanged(rule->path(), rule->status());
     emit fileStatusChanged(rule->absolutePath(), rule->status());
 }
@@ -1463,8 +1595,15 @@ void Project::trackProgramStatusChange(FileStatus status)
 
 void Project::trackGraphStatusChange(FileStatus status)
 {
-    Q_UNUSED(status)
     Graph *graph = static_cast<Graph *>(sender());
+    // Graph::open() reports the file as Normal before reading it, an unread
+    // graph would be indexed as empty
+    if(status == Normal && graph->isOpened())
+    {
+        _index.updateGraph(graph);
+        _index.save();
+    }
+
     emit graphStatusChanged(graph->path(), graph->status());
     emit fileStatusChanged(graph->absolutePath(), graph->status());
 }
@@ -8,6 +8,7 @@
 #include "program.hpp"
 #include "rule.hpp"
 #include "runconfig.hpp"
+#include "projectindex.hpp"
 
 #include <QVector>
 #include <QDebug>
@@ -16,6 +17,8 @@
 namespace Developer {
 
 class OpenThread;
+class ValidationCache;
+class RunCache;
 
 /*!
  * \brief Container type for GP projects, allowing for monitoring and updating
@@ -58,10 +61,23 @@ class OpenThread;
  *      </graphs>
  *      <runconfigurations>
  *          <runconfiguration name="run1" program="program1" graph="graph1.gxl" />
+ *          <runconfiguration name="run2" program="program1" graph="graph2.gv"
+ *                            batch="graphs/grid-*.host">
+ *              <limits time="60" cpu="30" memory="1024" />
+ *              <benchmark runs="10" warmup="2" />
+ *          </runconfiguration>
  *      </runconfigurations>
  *  </project>
  * \endcode
  *
+ * The optional limits of a run configuration are in seconds of wall clock
+ * time, seconds of CPU time and megabytes of address space, 0 or a missing
+ * attribute means no limit.
+ *
+ * A run configuration with a benchmark element compiles its program once and
+ * then executes it the given number of times, after the warm-up executions
+ * whose figures are discarded.
+ *
  * The Project class does not expect the user to manually save the file at any
  * point, and therefore is handled differently than other GPFile derived
  * classes. The file's status, and the statusChanged signals are largely unused,
@@ -281,6 +297,26 @@ public:
      */
     QVector<RunConfig *> runConfigurations() const;
 
+    /*!
+     * \brief Get the record of files which have passed validation
+     *
+     * The cache is stored in the results directory and loaded the first time
+     * it is requested.
+     *
+     * \return The project's validation cache
+     */
+    ValidationCache *validationCache();
+
+    /*!
+     * \brief Get the record of results produced by earlier runs
+     *
+     * Like the validation cache this is stored in the results directory and
+     * loaded the first time it is requested.
+     *
+     * \return The project's run cache
+     */
+    RunCache *runCache();
+
     /*!
      * \brief Checks if the project has any unsaved changes stored
      * \return True if there are unsaved changes, false otherwise
@@ -616,6 +652,10 @@ private:
     QVector<Program *> _programs;
     QVector<RunConfig *> _runConfigurations;
 
+    ProjectIndex _index;
+    ValidationCache *_validationCache;
+    RunCache *_runCache;
+
     // Set of convenience typedefs (don't want to rely on auto just yet)
     typedef QVector<Rule *>::iterator ruleIter;
     typedef QVector<Graph *>::iterator graphIter;
@@ -0,0 +1,271 @@
+/*!
+ * \file
+ */
+#include "projectindex.hpp"
+
+#include "rule.hpp"
+#include "graph.hpp"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDomDocument>
+#include <QCryptographicHash>
+#include <QSet>
+#include <QDebug>
+
+//! Extension appended to the project file path to locate its index
+#define GP_PROJECT_INDEX_EXTENSION ".index"
+//! Version of the index format, entries from other versions are discarded
+#define GP_PROJECT_INDEX_VERSION 2
+
+namespace Developer {
+
+ProjectIndex::Entry::Entry()
+    : size(-1)
+    , nodeCount(0)
+    , edgeCount(0)
+{
+}
+
+ProjectIndex::ProjectIndex(const QString &projectPath)
+    : _projectPath(projectPath)
+    , _modified(false)
+{
+}
+
+QString ProjectIndex::indexPath() const
+{
+    if(_projectPath.isEmpty())
+        return QString();
+
+    return QFileInfo(_projectPath).absoluteFilePath()
+            + GP_PROJECT_INDEX_EXTENSION;
+}
+
+void ProjectIndex::setProjectPath(const QString &projectPath)
+{
+    if(projectPath == _projectPath)
+        return;
+
+    _projectPath = projectPath;
+    _entries.clear();
+    _modified = false;
+}
+
+bool ProjectIndex::load()
+{
+    _entries.clear();
+    _modified = false;
+
+    QFile file(indexPath());
+    if(indexPath().isEmpty() || !file.exists())
+        return false;
+
+    if(!file.open(QFile::ReadOnly))
+    {
+        qDebug() << "    Could not open project index: " << file.fileName();
+        return false;
+    }
+
+    QDomDocument document("index");
+    if(!document.setContent(&file))
+    {
+        qDebug() << "    Project index could not be parsed, ignoring it.";
+        return false;
+    }
+
+    QDomElement root = document.documentElement();
+    if(root.tagName() != "index"
+            || root.attribute("version").toInt() != GP_PROJECT_INDEX_VERSION)
+    {
+        qDebug() << "    Project index is from a different version, ignoring it.";
+        _modified = true;
+        return false;
+    }
+
+    QDomNodeList files = root.elementsByTagName("file");
+    for(int i = 0; i < files.count(); ++i)
+    {
+        QDomElement elem = files.at(i).toElement();
+
+        Entry e;
+        e.type = elem.attribute("type");
+        e.path = elem.attribute("path");
+        e.size = elem.attribute("size", "-1").toLongLong();
+        e.modified = QDateTime::fromString(elem.attribute("modified"),
+                                           Qt::ISODate);
+        e.hash = QByteArray::fromHex(elem.attribute("hash").toLatin1());
+        e.name = elem.attribute("name");
+        e.nodeCount = elem.attribute("nodes", "0").toInt();
+        e.edgeCount = elem.attribute("edges", "0").toInt();
+
+        if(e.path.isEmpty())
+            continue;
+
+        _entries.insert(e.path, e);
+    }
+
+    qDebug() << "    Loaded project index with" << _entries.count() << "entries";
+    return true;
+}
+
+bool ProjectIndex::save()
+{
+    if(!_modified || indexPath().isEmpty())
+        return true;
+
+    QDomDocument doc("index");
+    QDomElement root = doc.createElement("index");
+    root.setAttribute("version", GP_PROJECT_INDEX_VERSION);
+    doc.appendChild(root);
+
+    for(entryConstIter iter = _entries.begin(); iter != _entries.end(); ++iter)
+    {
+        const Entry &e = iter.value();
+        QDomElement fileTag = doc.createElement("file");
+        fileTag.setAttribute("type", e.type);
+        fileTag.setAttribute("path", e.path);
+        fileTag.setAttribute("size", QString::number(e.size));
+        fileTag.setAttribute("modified", e.modified.toString(Qt::ISODate));
+        fileTag.setAttribute("hash", QString(e.hash.toHex()));
+
+        if(!e.name.isEmpty())
+            fileTag.setAttribute("name", e.name);
+        if(e.type == "graph")
+        {
+            fileTag.setAttribute("nodes", e.nodeCount);
+            fileTag.setAttribute("edges", e.edgeCount);
+        }
+
+        root.appendChild(fileTag);
+    }
+
+    QFile file(indexPath());
+    if(!file.open(QFile::WriteOnly | QFile::Truncate))
+    {
+        qDebug() << "    Could not write project index: " << file.fileName();
+        return false;
+    }
+
+    QString xml = doc.toString(4);
+    xml.prepend("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+    file.write(xml.toUtf8());
+    file.close();
+
+    _modified = false;
+    return true;
+}
+
+bool ProjectIndex::isCurrent(const QString &filePath) const
+{
+    QString path = QFileInfo(filePath).absoluteFilePath();
+    entryConstIter iter = _entries.find(path);
+    if(iter == _entries.end())
+        return false;
+
+    const Entry &stored = iter.value();
+    QFileInfo info(path);
+    if(!info.exists())
+        return false;
+
+    // Cheap checks first, only hash the contents once these agree. The index
+    // only stores whole seconds.
+    if(info.size() != stored.size
+            || info.lastModified().toMSecsSinceEpoch() / 1000
+               != stored.modified.toMSecsSinceEpoch() / 1000)
+        return false;
+
+    return contentHash(path) == stored.hash;
+}
+
+const ProjectIndex::Entry *ProjectIndex::entry(const QString &filePath) const
+{
+    entryConstIter iter = _entries.find(QFileInfo(filePath).absoluteFilePath());
+    if(iter == _entries.end())
+        return 0;
+
+    return &iter.value();
+}
+
+void ProjectIndex::updateRule(Rule *rule)
+{
+    if(rule == 0)
+        return;
+
+    Entry e;
+    e.type = "rule";
+    if(!fingerprint(rule->absolutePath(), &e))
+        return;
+
+    e.name = rule->name();
+
+    _entries.insert(e.path, e);
+    _modified = true;
+}
+
+void ProjectIndex::updateGraph(Graph *graph)
+{
+    if(graph == 0)
+        return;
+
+    Entry e;
+    e.type = "graph";
+    if(!fingerprint(graph->absolutePath(), &e))
+        return;
+
+    e.name = graph->fileName();
+    e.nodeCount = graph->nodes().size();
+    e.edgeCount = graph->edges().size();
+
+    _entries.insert(e.path, e);
+    _modified = true;
+}
+
+void ProjectIndex::remove(const QString &filePath)
+{
+    if(_entries.remove(QFileInfo(filePath).absoluteFilePath()) > 0)
+        _modified = true;
+}
+
+void ProjectIndex::retain(const QStringList &filePaths)
+{
+    QSet<QString> keep;
+    for(int i = 0; i < filePaths.count(); ++i)
+        keep.insert(QFileInfo(filePaths.at(i)).absoluteFilePath());
+
+    entryIter iter = _entries.begin();
+    while(iter != _entries.end())
+    {
+        if(keep.contains(iter.key()))
+            ++iter;
+        else
+        {
+            iter = _entries.erase(iter);
+            _modified = true;
+        }
+    }
+}
+
+QByteArray ProjectIndex::contentHash(const QString &filePath)
+{
+    QFile file(filePath);
+    if(!file.open(QFile::ReadOnly))
+        return QByteArray();
+
+    return QCryptographicHash::hash(file.readAll(), QCryptographicHash::Sha1);
+}
+
+bool ProjectIndex::fingerprint(const QString &filePath, Entry *entry) const
+{
+    QFileInfo info(filePath);
+    if(!info.exists())
+        return false;
+
+    entry->path = info.absoluteFilePath();
+    entry->size = info.size();
+    entry->modified = info.lastModified();
+    entry->hash = contentHash(entry->path);
+    return true;
+}
+
+}
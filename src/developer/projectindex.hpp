@@ -0,0 +1,117 @@
+/*!
+ * \file
+ */
+#ifndef PROJECTINDEX_HPP
+#define PROJECTINDEX_HPP
+
+#include <QString>
+#include <QStringList>
+#include <QDateTime>
+#include <QByteArray>
+#include <QMap>
+
+namespace Developer {
+
+class Rule;
+class Graph;
+
+/*!
+ * \brief Persistent summary of the files tracked by a Project
+ *
+ * Opening a project used to mean running the full parser over every rule and
+ * graph it contains before anything could be displayed. The index is a
+ * sidecar file stored next to the project file (<project>.gpp.index) which
+ * records a fingerprint of each rule and graph along with what the project
+ * needs to list it: its name, and for graphs the numbers of nodes and edges.
+ * On the next open any file whose fingerprint still matches can be populated
+ * from the index and parsed lazily the first time its contents are actually
+ * required.
+ *
+ * Programs are not indexed. Opening one only reads its text, there is nothing
+ * to parse that the index could save.
+ *
+ * A fingerprint is made up of the file's size, its modification time and a
+ * SHA-1 hash of its contents. The hash is only computed once the size and
+ * modification time have matched, so changed files are detected cheaply.
+ *
+ * An example index file follows:
+ *
+ * \code
+ *  <?xml version="1.0" encoding="UTF-8" ?>
+ *  <index version="2">
+ *      <file type="rule" path="/home/user/project1/rules/rule1.gpr"
+ *            size="142" modified="2014-03-01T12:00:00" hash="..."
+ *            name="rule1"/>
+ *      <file type="graph" path="..." size="..." modified="..." hash="..."
+ *            name="host.gpg" nodes="12" edges="15"/>
+ *  </index>
+ * \endcode
+ */
+class ProjectIndex
+{
+public:
+    /*!
+     * \brief Cached information about a single project file
+     */
+    struct Entry
+    {
+        Entry();
+
+        QString type;
+        QString path;
+        qint64 size;
+        QDateTime modified;
+        QByteArray hash;
+
+        QString name;
+        //! Graphs only
+        int nodeCount;
+        int edgeCount;
+    };
+
+    /*!
+     * \brief Construct an index for the project file at the given path
+     *
+     * The index is not read from disk until load() is called.
+     *
+     * \param projectPath   Path to the project (.gpp) file
+     */
+    explicit ProjectIndex(const QString &projectPath = QString());
+
+    QString indexPath() const;
+    void setProjectPath(const QString &projectPath);
+
+    bool load();
+    bool save();
+
+    /*!
+     * \brief Test whether the index holds an up to date entry for a file
+     *
+     * \param filePath  The path of the file to check
+     * \return True if the stored fingerprint matches the file on disk, false
+     *  if there is no entry or the file has changed since it was indexed
+     */
+    bool isCurrent(const QString &filePath) const;
+    const Entry *entry(const QString &filePath) const;
+
+    void updateRule(Rule *rule);
+    void updateGraph(Graph *graph);
+    void remove(const QString &filePath);
+    void retain(const QStringList &filePaths);
+
+    static QByteArray contentHash(const QString &filePath);
+
+private:
+    bool fingerprint(const QString &filePath, Entry *entry) const;
+
+    QString _projectPath;
+    QMap<QString, Entry> _entries;
+    bool _modified;
+
+    typedef QMap<QString, Entry>::iterator entryIter;
+    typedef QMap<QString, Entry>::const_iterator entryConstIter;
+};
+
+}
+
+#endif // PROJECTINDEX_HPP
@@ -5,6 +5,7 @@
 #include "ui_quickrunwidget.h"
 
 #include "project.hpp"
+#include "runconfig.hpp"
 
 #include <QDebug>
 
@@ -13,6 +14,7 @@ namespace Developer {
 QuickRunWidget::QuickRunWidget(QWidget *parent)
     : QWidget(parent)
     , _ui(new Ui::QuickRunWidget)
+    , _project(0)
 {
     _ui->setupUi(this);
 }
@@ -24,14 +26,48 @@ QuickRunWidget::~QuickRunWidget()
 
 void QuickRunWidget::setProject(Project *project)
 {
+    if(_project != 0)
+        _project->disconnect(this);
+
+    _project = project;
     _ui->quickRunProjectName->setText(project->name());
 
-    //! \todo iterate across run configurations, also need to track them
+    connect(_project, SIGNAL(runConfigurationListChanged()),
+            this, SLOT(updateRunConfigurations()));
+    updateRunConfigurations();
 }
 
 void QuickRunWidget::run()
 {
-    qDebug() << "Run requested: " << _ui->quickRunConfigCombo->currentText();
+    QString configName = _ui->quickRunConfigCombo->currentText();
+    qDebug() << "Run requested: " << configName;
+    if(configName.isEmpty())
+        return;
+
+    // The run itself is queued and carried out by the Run tab
+    emit runRequested(configName);
+}
+
+void QuickRunWidget::updateRunConfigurations()
+{
+    QString current = _ui->quickRunConfigCombo->currentText();
+    _ui->quickRunConfigCombo->clear();
+    if(_project == 0)
+        return;
+
+    QVector<RunConfig *> configs = _project->runConfigurations();
+    for(QVector<RunConfig *>::iterator iter = configs.begin();
+        iter != configs.end(); ++iter)
+    {
+        RunConfig *config = *iter;
+        if(config != 0)
+            _ui->quickRunConfigCombo->addItem(config->name());
+    }
+
+    int index = _ui->quickRunConfigCombo->findText(current);
+    if(index != -1)
+        _ui->quickRunConfigCombo->setCurrentIndex(index);
+    _ui->quickRunButton->setEnabled(_ui->quickRunConfigCombo->count() > 0);
 }
 
 }
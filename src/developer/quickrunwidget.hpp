@@ -52,6 +52,18 @@ public slots:
      * should be run.
      */
     void run();
+
+    /*!
+     * \brief Refill the combo box from the project's run configurations
+     */
+    void updateRunConfigurations();
+
+signals:
+    /*!
+     * \brief Emitted when the user asks for a run configuration to be run
+     * \param configName    The name of the run configuration
+     */
+    void runRequested(QString configName);
     
 private:
     Ui::QuickRunWidget *_ui;
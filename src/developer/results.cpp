@@ -6,15 +6,30 @@
 
 #include "helpdialog.hpp"
 #include "project.hpp"
+#include "batchrun.hpp"
+#include "runusage.hpp"
+#include "benchmark.hpp"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QSettings>
 
 namespace Developer {
 
 Results::Results(QWidget *parent)
     : QWidget(parent)
     , _ui(new Ui::Results)
+    , _loadedCost(0)
+    , _currentItem(0)
+    , _shownGraph(0)
 {
     _ui->setupUi(this);
 
+    QSettings settings;
+    _memoryBudget = settings.value("Results/MemoryBudget",
+                                   DefaultMemoryBudget).toLongLong()
+            * 1024 * 1024;
+
 
     QStringList items;
     items << "Results";
@@ -22,6 +37,8 @@ Results::Results(QWidget *parent)
     root->setIcon(0, QIcon(QPixmap(":/icons/application-icon.png")));
     _ui->resultsTreeWidget->addTopLevelItem(root);
 
+    _ui->usageTable->setVisible(false);
+    _ui->benchmarkTable->setVisible(false);
 
     connect(_ui->graphEdit, SIGNAL(graphHasFocus(GraphWidget*)),
             this, SLOT(handleGraphHasFocus(GraphWidget*)));
@@ -32,6 +49,10 @@ Results::Results(QWidget *parent)
 Results::~Results()
 {
     delete _ui;
+
+    // A graph left over from cleared results is no longer in the cache
+    if(_currentItem == 0)
+        delete _shownGraph;
 }
 
 void Results::setProject(Project *project)
@@ -45,6 +66,7 @@ void Results::setProject(Project *project)
     _project = project;
 
     // Clear the existing result graphs
+    clearResults();
     _ui->resultsTreeWidget->clear();
 
     QStringList items;
@@ -83,33 +105,161 @@ void Results::graphClicked(QTreeWidgetItem *item)
         return;
 
     // Handle a clicked result
-
-    Graph* graph = _graphMap.key(item);    // Slow search, maps are optimized for fast retrieval by key, not value
-    if (graph == 0)
+    if (!_results.contains(item))
     {
         qDebug() << "Could not find a corresponding Graph: " << item->text(0);
         return;
     }
 
-    // qDebug() << "Attempting to view Result: " << graph->fileName();
-
-    //graph->open();
+    Graph* graph = loadResult(item);
+    Graph *previous = _shownGraph;
+    bool orphaned = (_currentItem == 0);
+    _currentItem = item;
+    _shownGraph = graph;
 
     _ui->graphEdit->setEnabled(true);
     _ui->graphEdit->setGraph(graph);
+
+    // A graph kept on screen after its results were cleared belongs to
+    // nothing else, so it goes once it has been replaced
+    if(orphaned)
+        delete previous;
+
+    // Only now is the previously shown graph free to be unloaded
+    trimLoaded();
+
+    showUsage(_results.value(item).path);
+    showBenchmark(_results.value(item).path);
 }
 
 void Results::addResultGraph(QString resultLocation, RunConfig* runConfig)
+{
+    QTreeWidgetItem* config = configItem(runConfig);
+    if (config == 0)
+        return;
+
+    // The graph itself is not read until the result is selected
+    QFileInfo info(resultLocation);
+
+    QStringList items;
+    items << info.fileName();
+    QTreeWidgetItem* graph = new QTreeWidgetItem(items);
+    graph->setToolTip(0, info.absoluteFilePath());
+
+    RunUsage usage;
+    if (usage.load(RunUsage::usageFile(resultLocation)) && !usage.isEmpty())
+    {
+        graph->setText(0, tr("%1 (%2 s)").arg(
+                           info.fileName(),
+                           seconds(usage.total().wallTime)));
+        graph->setToolTip(0, info.absoluteFilePath() + "\n"
+                          + usageSummary(usage));
+    }
+
+    Benchmark benchmark;
+    if (benchmark.loadCsv(Benchmark::csvFile(resultLocation))
+            && !benchmark.isEmpty())
+    {
+        BenchmarkSummary wall = benchmark.wallTime();
+        graph->setText(0, tr("%1 (median %2 s over %n run(s))", "", wall.count)
+                       .arg(info.fileName(),
+                            seconds(wall.median)));
+    }
+
+    config->addChild(graph);
+    addResult(graph, resultLocation);
+
+    _ui->resultsTreeWidget->expandItem(config);
+}
+
+void Results::addBatchResult(QString batch, QString hostGraph,
+                             QString resultLocation, int status,
+                             qint64 elapsed, RunConfig* runConfig)
+{
+    QTreeWidgetItem* config = configItem(runConfig);
+    if (config == 0)
+        return;
+
+    // Each batch is grouped under its own item within the configuration
+    QTreeWidgetItem* batchItem = 0;
+    for (int i = 0; i < config->childCount(); ++i)
+    {
+        QTreeWidgetItem* child = config->child(i);
+        if (child->data(0, Qt::UserRole).toString() == batch)
+        {
+            batchItem = child;
+            break;
+        }
+    }
+
+    if (batchItem == 0)
+    {
+        QStringList items;
+        items << batch;
+        batchItem = new QTreeWidgetItem(items);
+        batchItem->setData(0, Qt::UserRole, batch);
+        batchItem->setIcon(0, QIcon(QPixmap(":/icons/small_folder.png")));
+        config->addChild(batchItem);
+        _ui->resultsTreeWidget->expandItem(config);
+    }
+
+    BatchRun::InstanceStatus instanceStatus =
+            static_cast<BatchRun::InstanceStatus>(status);
+    QString time = seconds(elapsed);
+
+    QStringList items;
+    items << tr("%1 (%2 s)").arg(QFileInfo(hostGraph).fileName()).arg(time);
+    QTreeWidgetItem* instance = new QTreeWidgetItem(items);
+    instance->setToolTip(0, tr("%1\n%2, %3 s").arg(
+                             hostGraph,
+                             BatchRun::statusName(instanceStatus),
+                             time));
+    batchItem->addChild(instance);
+
+    RunUsage usage;
+    if (usage.load(RunUsage::usageFile(resultLocation)) && !usage.isEmpty())
+        instance->setToolTip(0, instance->toolTip(0) + "\n"
+                             + usageSummary(usage));
+
+    if (instanceStatus == BatchRun::Instance_Succeeded)
+    {
+        addResult(instance, resultLocation);
+    }
+    else
+    {
+        instance->setText(0, tr("%1 (%2)").arg(
+                              QFileInfo(hostGraph).fileName(),
+                              BatchRun::statusName(instanceStatus)));
+        instance->setForeground(0, QBrush(Qt::gray));
+    }
+}
+
+void Results::addStoppedRun(QString hostGraph, QString reason,
+                            RunConfig* runConfig)
+{
+    QTreeWidgetItem* config = configItem(runConfig);
+    if (config == 0)
+        return;
+
+    QStringList items;
+    items << tr("%1 (%2)").arg(QFileInfo(hostGraph).fileName(), reason);
+    QTreeWidgetItem* item = new QTreeWidgetItem(items);
+    item->setToolTip(0, tr("%1\n%2").arg(hostGraph, reason));
+    item->setForeground(0, QBrush(Qt::gray));
+    config->addChild(item);
+    _ui->resultsTreeWidget->expandItem(config);
+}
+
+QTreeWidgetItem *Results::configItem(RunConfig *runConfig)
 {
     // Check if config exists already in the tree structure
     // If no, create it
     QTreeWidgetItem* config;
-    QTreeWidgetItem* graph;
-    QStringList items;
     if (!_configMap.contains(runConfig))
     {
         qDebug() << "Adding a new run configuration to Results View: " << runConfig->name();
 
+        QStringList items;
         items << runConfig->name();
         config = new QTreeWidgetItem(items);
 
@@ -126,25 +276,198 @@ void Results::addResultGraph(QString resultLocation, RunConfig* runConfig)
     if (config == 0)
     {
         qDebug() << "Unable to add result config to Result View " << runConfig->name();    
-        return;
+        return 0;
     } 
 
     // Update widget display name
     if (config->text(0) != runConfig->name())
         config->setText(0, runConfig->name());
 
-    // Check if result graph exists in tree structure
-    // If no, create it
-    Graph* resultGraph = new Graph(resultLocation, this);
+    return config;
+}
 
-    items.clear(); items << resultGraph->fileName();
-    graph = new QTreeWidgetItem(items);
-    graph->setToolTip(0, resultGraph->absolutePath());
+void Results::addResult(QTreeWidgetItem *item, const QString &resultFile)
+{
+    ResultEntry entry;
+    entry.path = resultFile;
+    entry.graph = 0;
+    entry.cost = 0;
+    _results.insert(item, entry);
+}
 
-    config->addChild(graph);
-    _graphMap.insert(resultGraph, graph);
+Graph *Results::loadResult(QTreeWidgetItem *item)
+{
+    ResultEntry &entry = _results[item];
+    if (entry.graph == 0)
+    {
+        qDebug() << "Loading result graph:" << entry.path;
+        entry.graph = new Graph(entry.path, true, this);
+        entry.cost = estimateCost(entry);
+        _loadedCost += entry.cost;
+    }
+    else
+    {
+        _loaded.removeOne(item);
+    }
 
-    _ui->resultsTreeWidget->expandItem(config);
+    _loaded.prepend(item);
+    return entry.graph;
+}
+
+void Results::trimLoaded()
+{
+    for (int i = _loaded.count() - 1; i >= 0 && _loadedCost > _memoryBudget; --i)
+    {
+        QTreeWidgetItem *item = _loaded.at(i);
+        ResultEntry &entry = _results[item];
+        if (item == _currentItem || entry.graph->status() == GPFile::Modified)
+            continue;
+
+        qDebug() << "  Unloading result graph:" << entry.path;
+        delete entry.graph;
+        entry.graph = 0;
+        _loadedCost -= entry.cost;
+        entry.cost = 0;
+        _loaded.removeAt(i);
+    }
+}
+
+void Results::clearResults()
+{
+    // The graph being shown stays alive until something else replaces it,
+    // from now on it is owned through _shownGraph alone
+    for (int i = 0; i < _loaded.count(); ++i)
+    {
+        Graph *graph = _results.value(_loaded.at(i)).graph;
+        if (graph != _shownGraph)
+            delete graph;
+    }
+
+    _results.clear();
+    _loaded.clear();
+    _loadedCost = 0;
+    _currentItem = 0;
+}
+
+qint64 Results::estimateCost(const ResultEntry &entry)
+{
+    // A rough figure per node and edge, covering the objects and their
+    // parsed labels, on top of the text of the file itself
+    const qint64 elementCost = 1024;
+    qint64 elements = static_cast<qint64>(entry.graph->nodes().size())
+            + static_cast<qint64>(entry.graph->edges().size());
+
+    return elements * elementCost + QFileInfo(entry.path).size();
+}
+
+void Results::showUsage(const QString &resultFile)
+{
+    RunUsage usage;
+    if (!usage.load(RunUsage::usageFile(resultFile)) || usage.isEmpty())
+    {
+        _ui->usageTable->setVisible(false);
+        return;
+    }
+
+    QStringList stages = usage.stages();
+    _ui->usageTable->setRowCount(stages.count() + 1);
+    for (int i = 0; i <= stages.count(); ++i)
+    {
+        bool total = (i == stages.count());
+        ResourceUsage stage = total ? usage.total() : usage.stage(stages.at(i));
+
+        QStringList cells;
+        cells << (total ? tr("Total") : stages.at(i))
+              << seconds(stage.wallTime)
+              << seconds(stage.userTime)
+              << seconds(stage.systemTime)
+              << QString::number(stage.peakMemory / 1024.0, 'f', 1);
+
+        for (int column = 0; column < cells.count(); ++column)
+        {
+            QTableWidgetItem *cell = new QTableWidgetItem(cells.at(column));
+            if (column > 0)
+                cell->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            if (total)
+            {
+                QFont font = cell->font();
+                font.setBold(true);
+                cell->setFont(font);
+            }
+            _ui->usageTable->setItem(i, column, cell);
+        }
+    }
+
+    _ui->usageTable->resizeColumnsToContents();
+    _ui->usageTable->setVisible(true);
+}
+
+void Results::showBenchmark(const QString &resultFile)
+{
+    Benchmark benchmark;
+    if (!benchmark.loadCsv(Benchmark::csvFile(resultFile))
+            || benchmark.isEmpty())
+    {
+        _ui->benchmarkTable->setVisible(false);
+        return;
+    }
+
+    BenchmarkSummary wall = benchmark.wallTime();
+    BenchmarkSummary peak = benchmark.peakMemory();
+
+    QList<QStringList> rows;
+    rows << (QStringList() << tr("Wall time (s) over %n run(s)", "", wall.count)
+             << seconds(wall.min) << seconds(wall.median)
+             << seconds(wall.mean) << seconds(wall.p95)
+             << seconds(wall.stddev));
+    rows << (QStringList() << tr("Peak memory (MB)")
+             << QString::number(peak.min / 1024.0, 'f', 1)
+             << QString::number(peak.median / 1024.0, 'f', 1)
+             << QString::number(peak.mean / 1024.0, 'f', 1)
+             << QString::number(peak.p95 / 1024.0, 'f', 1)
+             << QString::number(peak.stddev / 1024.0, 'f', 1));
+
+    _ui->benchmarkTable->setRowCount(rows.count());
+    for (int row = 0; row < rows.count(); ++row)
+    {
+        for (int column = 0; column < rows.at(row).count(); ++column)
+        {
+            QTableWidgetItem *cell =
+                    new QTableWidgetItem(rows.at(row).at(column));
+            if (column > 0)
+                cell->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            _ui->benchmarkTable->setItem(row, column, cell);
+        }
+    }
+
+    _ui->benchmarkTable->setToolTip(
+                tr("Also exported to %1 and %2").arg(
+                    QDir::toNativeSeparators(Benchmark::csvFile(resultFile)),
+                    QDir::toNativeSeparators(Benchmark::jsonFile(resultFile))));
+    _ui->benchmarkTable->resizeColumnsToContents();
+    _ui->benchmarkTable->setVisible(true);
+}
+
+QString Results::usageSummary(const RunUsage &usage)
+{
+    QStringList lines;
+    QStringList stages = usage.stages();
+    for (int i = 0; i < stages.count(); ++i)
+    {
+        ResourceUsage stage = usage.stage(stages.at(i));
+        lines << tr("%1: %2 s wall, %3 s CPU, %4 MB").arg(
+                     stages.at(i),
+                     seconds(stage.wallTime),
+                     seconds(stage.userTime + stage.systemTime),
+                     QString::number(stage.peakMemory / 1024.0, 'f', 1));
+    }
+
+    return lines.join("\n");
+}
+
+QString Results::seconds(double milliseconds)
+{
+    return QString::number(milliseconds / 1000.0, 'f', 2);
 }
 
 void Results::handleGraphHasFocus(GraphWidget *graphWidget)
@@ -6,6 +6,8 @@
 
 #include <QWidget>
 #include <QTreeWidgetItem>
+#include <QHash>
+#include <QList>
 
 namespace Ui {
     class Results;
@@ -18,7 +20,16 @@ class Project;
 class Graph;
 class RunConfig;
 class GraphWidget;
+class RunUsage;
 
+/*!
+ * \brief Widget listing the results of runs and showing the selected one
+ *
+ * Result graphs are only read in when they are first selected. Loaded graphs
+ * are kept in least recently viewed order, and once their estimated size goes
+ * over the memory budget the oldest are unloaded again. The budget is read from
+ * the Results/MemoryBudget setting, in megabytes.
+ */
 class Results : public QWidget
 {
     Q_OBJECT
@@ -62,15 +73,88 @@ public slots:
      */
     void addResultGraph(QString resultLocation, RunConfig* runConfig);
 
+    /*!
+     * \brief Slot to handle one instance of a batch run completing
+     *
+     * Instances are grouped under an item for their batch, within the item for
+     * the run configuration. Each shows the host graph it was run on and the
+     * time the run took. Only instances which produced an output graph can be
+     * viewed.
+     *
+     * \param status    One of BatchRun::InstanceStatus
+     * \param elapsed   Wall clock time of the run, in milliseconds
+     */
+    void addBatchResult(QString batch, QString hostGraph,
+                        QString resultLocation, int status, qint64 elapsed,
+                        RunConfig* runConfig);
+
+    /*!
+     * \brief Slot to record a run which was stopped before producing a result
+     *
+     * The run is listed under its configuration with the reason it stopped,
+     * for example an exceeded time limit, but has no graph to view.
+     */
+    void addStoppedRun(QString hostGraph, QString reason, RunConfig* runConfig);
+
 signals:
     void graphHasFocus(GraphWidget *graphWidget);
     void graphLostFocus(GraphWidget *graphWidget);
 
 private:
+    //! Default memory budget for loaded result graphs, in megabytes
+    static const int DefaultMemoryBudget = 256;
+
+    /*!
+     * \brief A result graph file, and its graph while it is loaded
+     */
+    struct ResultEntry
+    {
+        QString path;
+        Graph *graph;
+        //! Estimated bytes used by graph, 0 while it is not loaded
+        qint64 cost;
+    };
+
+    QTreeWidgetItem *configItem(RunConfig *runConfig);
+
+    void addResult(QTreeWidgetItem *item, const QString &resultFile);
+    Graph *loadResult(QTreeWidgetItem *item);
+
+    /*!
+     * \brief Unload the least recently viewed result graphs until the loaded
+     *  ones fit in the memory budget
+     *
+     * The graph being shown and graphs with unsaved changes are never unloaded.
+     */
+    void trimLoaded();
+    void clearResults();
+    static qint64 estimateCost(const ResultEntry &entry);
+
+    /*!
+     * \brief Fill the details pane with the per-stage usage of a result, or
+     *  hide it if the result has none recorded
+     */
+    void showUsage(const QString &resultFile);
+
+    /*!
+     * \brief Fill the benchmark table with the statistics of a result, or
+     *  hide it if the result is not from a benchmark run
+     */
+    void showBenchmark(const QString &resultFile);
+    static QString usageSummary(const RunUsage &usage);
+    static QString seconds(double milliseconds);
+
     Ui::Results *_ui;
     Project *_project;
-    QMap<Graph *, QTreeWidgetItem *> _graphMap;
-    //Graph *_currentGraph;
+    QHash<QTreeWidgetItem *, ResultEntry> _results;
+    // Items with a loaded graph, most recently viewed first
+    QList<QTreeWidgetItem *> _loaded;
+    qint64 _loadedCost;
+    qint64 _memoryBudget;
+    QTreeWidgetItem *_currentItem;
+    // Graph in the editor. Owned by its entry in _results, or by this widget
+    // alone once _currentItem has been reset by clearResults().
+    Graph *_shownGraph;
 
     QMap<RunConfig *, QTreeWidgetItem *> _configMap;
     //RunConfig *_currentConfig;
@@ -7,6 +7,7 @@
 #include "graph.hpp"
 
 #include <QFileDialog>
+#include <QFileInfo>
 #include <QDebug>
 #include <QRegExp>
 
@@ -14,7 +15,7 @@
 
 namespace Developer {
 
-Rule::Rule(const QString &rulePath, QObject *parent)
+Rule::Rule(const QString &rulePath, QObject *parent, bool autoInitialise)
     : GPFile(rulePath, parent)
     , _name("")
     , _documentation("")
@@ -22,9 +23,10 @@ Rule::Rule(const QString &rulePath, QObject *parent)
     , _rhs(0)
     , _condition("")
     , _options(Rule_DefaultBehaviour)
+    , _parsed(rulePath.isEmpty())
 {
     _initialOpen = true;
-    if(!rulePath.isEmpty())
+    if(autoInitialise && !rulePath.isEmpty())
         open();
     _initialOpen = false;
 }
@@ -36,46 +38,69 @@ const QString &Rule::name() const
 
 const QString &Rule::documentation() const
 {
+    ensureParsed();
     return _documentation;
 }
 
 Graph *Rule::lhs() const
 {
+    ensureParsed();
     return _lhs;
 }
 
 Graph *Rule::rhs() const
 {
+    ensureParsed();
     return _rhs;
 }
 
 interface_t Rule::interface() const
 {
+    ensureParsed();
     return _interface;
 }
 
 std::vector<param_t> Rule::variables() const
 {
+    ensureParsed();
     return _variables;
 }
 
 const QString &Rule::condition() const
 {
+    ensureParsed();
     return _condition;
 }
 
 int Rule::options() const
 {
+    ensureParsed();
     return _options;
 }
 
 bool Rule::injectiveMatching() const
 {
-    return (_options & Rule_InjectiveMatching);
+    return (options() & Rule_InjectiveMatching);
+}
+
+bool Rule::isParsed() const
+{
+    return _parsed;
+}
+
+void Rule::setIndexedName(const QString &ruleName)
+{
+    // Only meaningful before the file is parsed, afterwards the name in the
+    // file is authoritative
+    if(_parsed)
+        return;
+
+    _name = ruleName;
 }
 
 void Rule::setName(const QString &ruleName)
 {
+    ensureParsed();
     if(ruleName.isEmpty() || ruleName == _name)
         return;
 
@@ -86,6 +111,7 @@ void Rule::setName(const QString &ruleName)
 
 void Rule::setDocumentation(const QString &docString)
 {
+    ensureParsed();
     if(docString.isEmpty() || docString == _documentation)
         return;
 
@@ -100,6 +126,7 @@ void Rule::setDocumentation(const QString &docString)
 
 void Rule::setLhs(Graph *lhsGraph)
 {
+    ensureParsed();
     if (_rhs != 0)
         disconnect(_lhs, SIGNAL(statusChanged(FileStatus)), this, SLOT(lhsGraphChanged()));
 
@@ -115,6 +142,7 @@ void Rule::setLhs(Graph *lhsGraph)
 
 void Rule::setRhs(Graph *rhsGraph)
 {
+    ensureParsed();
     if (_rhs != 0)
         disconnect(_rhs, SIGNAL(statusChanged(FileStatus)), this, SLOT(rhsGraphChanged()));
 
@@ -131,6 +159,7 @@ void Rule::setRhs(Graph *rhsGraph)
 
 void Rule::setInterface(interface_t &interface)
 {
+    ensureParsed();
     _interface = interface;
 		// Graph is an Qobject, but interface_t is not; TODO: rethink how to fix this
     //connect(_interface, SIGNAL(statusChanged(FileStatus)), this, SLOT(interfaceChanged()));
@@ -190,6 +219,7 @@ void Rule::setInterface(interface_t &interface)
 
 void Rule::setVariables(std::vector<param_t> &variables)
 {
+    ensureParsed();
     _variables = variables;
     // Graph is an Qobject, but std::vector<param_t> is not; TODO: rethink how to fix this
     //connect(_variables, SIGNAL(statusChanged(FileStatus)), this, SLOT(variablesChanged()));
@@ -203,6 +233,7 @@ void Rule::setVariables(std::vector<param_t> &variables)
 
 void Rule::modifyVariables()
 {
+    ensureParsed();
     if (_initialOpen) return;
 
     _status = Modified;
@@ -211,6 +242,7 @@ void Rule::modifyVariables()
 
 void Rule::setCondition(const QString &conditionString)
 {
+    ensureParsed();
     //qDebug() << _condition;
     if(_condition.compare(conditionString) == 0)
         return;
@@ -224,6 +256,8 @@ void Rule::setCondition(const QString &conditionString)
 
 void Rule::setOptions(int options)
 {
+    ensureParsed();
+
     // Check if this is valid input, remove all known option settings and if any
     // bits are still set then this is invalid and we should warn the user.
     int copy = options;
@@ -241,6 +275,7 @@ void Rule::setOptions(int options)
 
 void Rule::setInjectiveMatching(bool injective)
 {
+    ensureParsed();
     if(injective)
         _options |= Rule_InjectiveMatching;
     else
@@ -261,6 +296,7 @@ void Rule::addVariables(param_t &variables)
 
 void Rule::removeVariable(std::string &variable)
 {
+    ensureParsed();
     for (std::vector<param_t>::iterator it = _variables.begin(); it != _variables.end(); ++it)
     {
       std::vector<std::string> varlist = it->variables;
@@ -291,6 +327,12 @@ bool Rule::save()
     if(_path.isEmpty() || !_fp->isOpen())
         return false;
 
+    // A rule loaded from the index and not changed since is already on disk,
+    // anything else has to be parsed before it can be written out
+    if(!_parsed && _status != Modified)
+        return true;
+    ensureParsed();
+
     _fp->close();
     ++_internalChanges;
     _fp->open(QFile::Truncate | QFile::WriteOnly);
@@ -342,6 +384,8 @@ bool Rule::save()
 // comment and then concatenating the rule contents
 QString Rule::toAlternative()
 {
+    ensureParsed();
+
     QString saveText = QString();
     QString docText = _documentation;
     docText.replace("\n","\n \\\\ ");
@@ -456,6 +500,8 @@ bool Rule::saveAs(const QString &filePath)
 
 bool Rule::open()
 {
+    _parsed = true;
+
     if(!GPFile::open())
         return false;
 
@@ -467,8 +513,22 @@ bool Rule::open()
         return false;
     }
 
-    QString ruleContents = _fp->readAll();
-    if(ruleContents.isEmpty())
+    if(!parse())
+        return false;
+
+    _status = Normal;
+    emit statusChanged(_status);
+
+    return true;
+}
+
+bool Rule::parse()
+{
+    // Set first, the setters below would otherwise try to parse the file again
+    _parsed = true;
+
+    QFileInfo info(_path);
+    if(!info.exists() || info.size() == 0)
         return false;
 
     //std::string ruleString = ruleContents.toStdString();
@@ -477,15 +537,18 @@ bool Rule::open()
 
     qDebug() << "    Finished parsing rule file. " ;
 
+    // Loading the file is not a change to the rule
+    bool initialOpen = _initialOpen;
+    _initialOpen = true;
 
-    setName(rule.id.c_str());
+    _name = rule.id.c_str();
 
     QString docString = rule.documentation.c_str();
     // Strip opening whitespace and the first * if one exists, this allows for
     // common C/C++/Java-style multiline comments such as the top of this file
     docString.replace(QRegExp("\n\\s*\\*\\s*"), "\n");
     docString = docString.trimmed();
-    setDocumentation(docString);
+    _documentation = docString;
 
 		/*
     if(rule.lhs != NULL)
@@ -548,12 +611,22 @@ bool Rule::open()
     // qDebug() << "  rule.cpp: Setting condition to:" << QString(rule.condition.c_str());
     setCondition(QString(rule.condition.c_str()));
 
-    _status = Normal;
-    emit statusChanged(_status);
-
+    _initialOpen = initialOpen;
     return true;
 }
 
+void Rule::ensureParsed() const
+{
+    // Rules populated from the project index are only parsed when something
+    // beyond their name is requested. parse() only fills in the rule, it
+    // leaves the file and its status alone and emits nothing, so reading a
+    // rule never marks it changed.
+    if(_parsed)
+        return;
+
+    const_cast<Rule *>(this)->parse();
+}
+
 void Rule::lhsGraphChanged()
 {
     _status = Modified;
@@ -36,10 +36,13 @@ public:
      * this is provided then the Rule will automatically try to initialise
      * itself from this file.
      *
-     * \param rulePath  Optional. Path to a rule file to open
-     * \param parent    This object's parent object
+     * \param rulePath        Optional. Path to a rule file to open
+     * \param parent          This object's parent object
+     * \param autoInitialise  Optional. If passed "false" then the rule file is
+     *      not parsed until its contents are first requested
      */
-    explicit Rule(const QString &rulePath = QString(), QObject *parent = 0);
+    explicit Rule(const QString &rulePath = QString(), QObject *parent = 0,
+                  bool autoInitialise = true);
 
     /*!
      * \brief Get this rule's name (its identifier)
@@ -57,6 +60,22 @@ public:
     int options() const;
     bool injectiveMatching() const;
 
+    /*!
+     * \brief Test whether the rule file has been parsed yet
+     * \return True if the rule's graphs, interface and condition are loaded
+     */
+    bool isParsed() const;
+
+    /*!
+     * \brief Provide the rule's name ahead of parsing the file
+     *
+     * Used by Project when the name is already known from the project index,
+     * so that the rule can be listed without being parsed.
+     *
+     * \param ruleName  The name recorded for this rule
+     */
+    void setIndexedName(const QString &ruleName);
+
     /*!
      * \brief Set this rule's name (its identifier)
      *
@@ -99,6 +118,13 @@ signals:
     void redrawVariables();
 
 private:
+    /*!
+     * \brief Read the rule's contents from its file without emitting any
+     *  signals or changing its status
+     */
+    bool parse();
+    void ensureParsed() const;
+
     QString _name;
     QString _documentation;
     Graph *_lhs;
@@ -108,6 +134,7 @@ private:
     QString _condition;
     int _options;
     bool _initialOpen;
+    bool _parsed;
 };
 
 }
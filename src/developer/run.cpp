@@ -6,6 +6,7 @@
 
 #include "project.hpp"
 #include "runconfiguration.hpp"
+#include "runqueue.hpp"
 
 namespace Ui {
     class RunConfiguration;
@@ -19,6 +20,9 @@ Run::Run(QWidget *parent)
     , _initial(true)
 {
     _ui->setupUi(this);
+
+    _queue = new RunQueue(this);
+    _ui->runQueueView->setQueue(_queue);
 }
 
 Run::~Run()
@@ -31,6 +35,11 @@ Project *Run::project() const
     return _project;
 }
 
+RunQueue *Run::runQueue() const
+{
+    return _queue;
+}
+
 void Run::setProject(Project *proj)
 {
     if(proj == 0)
@@ -87,6 +96,37 @@ void Run::handleResultGraph(QString resultLocation, RunConfig* runConfig)
     emit obtainedResultGraph(resultLocation, runConfig);
 }
 
+void Run::handleBatchResult(QString batch, QString hostGraph,
+                            QString resultLocation, int status, qint64 elapsed,
+                            RunConfig* runConfig)
+{
+    emit obtainedBatchResult(batch, hostGraph, resultLocation, status, elapsed,
+                             runConfig);
+}
+
+void Run::handleRunStopped(QString hostGraph, QString reason,
+                           RunConfig* runConfig)
+{
+    emit runStopped(hostGraph, reason, runConfig);
+}
+
+void Run::queueRun(QString configName)
+{
+    QList<RunConfiguration *> configurations =
+            _ui->runConfigurations->findChildren<RunConfiguration *>();
+    for (int i = 0; i < configurations.count(); ++i)
+    {
+        if (configurations.at(i)->name() == configName)
+        {
+            _queue->enqueue(configurations.at(i), RunQueue::Kind_Single);
+            return;
+        }
+    }
+
+    qDebug() << "Run::queueRun() could not find run configuration"
+             << configName;
+}
+
 void Run::handleRunConfigListChanged()
 {
     QVector<RunConfig*> configs = _project->runConfigurations();
@@ -135,6 +175,7 @@ RunConfiguration *Run::addRunConfiguration(RunConfig* runConfig)
 
     RunConfiguration *runConfiguration = new RunConfiguration(_project, _ui->runConfigurations, runConfig);
     _ui->runConfigurations->layout()->addWidget(runConfiguration);
+    runConfiguration->setRunQueue(_queue);
 
     // New run configurations should never be added to project
     // Instead, should be added only when ran
@@ -146,6 +187,14 @@ RunConfiguration *Run::addRunConfiguration(RunConfig* runConfig)
 //    }
 
     connect (runConfiguration, SIGNAL(obtainedResultGraph(QString, RunConfig*)), this, SLOT(handleResultGraph(QString, RunConfig*))  );
+    connect (runConfiguration,
+             SIGNAL(obtainedBatchResult(QString, QString, QString, int, qint64, RunConfig*)),
+             this,
+             SLOT(handleBatchResult(QString, QString, QString, int, qint64, RunConfig*)));
+    connect (runConfiguration,
+             SIGNAL(runStopped(QString, QString, RunConfig*)),
+             this,
+             SLOT(handleRunStopped(QString, QString, RunConfig*)));
 
     return runConfiguration;
 }
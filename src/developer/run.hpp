@@ -17,6 +17,7 @@ class Project;
 class Graph;
 class RunConfig;
 class RunConfiguration;
+class RunQueue;
 
 class Run : public QWidget
 {
@@ -30,18 +31,38 @@ public:
 
     void setProject(Project *proj);
 
+    /*!
+     * \brief Get the queue every run of this project goes through
+     */
+    RunQueue *runQueue() const;
+
 signals:
     void obtainedResultGraph(QString resultLocation, RunConfig* runConfig);
+    void obtainedBatchResult(QString batch, QString hostGraph,
+                             QString resultLocation, int status,
+                             qint64 elapsed, RunConfig* runConfig);
+    void runStopped(QString hostGraph, QString reason, RunConfig* runConfig);
 
 public slots:
     RunConfiguration *addRunConfiguration(RunConfig* runConfig = 0);
     void handleResultGraph(QString resultLocation, RunConfig* runConfig);
+    void handleBatchResult(QString batch, QString hostGraph,
+                           QString resultLocation, int status, qint64 elapsed,
+                           RunConfig* runConfig);
+    void handleRunStopped(QString hostGraph, QString reason,
+                          RunConfig* runConfig);
     void handleRunConfigListChanged();
+
+    /*!
+     * \brief Queue a single run of the named run configuration
+     */
+    void queueRun(QString configName);
     
 private:
     Ui::Run *_ui;
     Project *_project;
     bool _initial;
+    RunQueue *_queue;
 };
 
 }
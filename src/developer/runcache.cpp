@@ -0,0 +1,186 @@
+/*!
+ * \file
+ */
+#include "runcache.hpp"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDomDocument>
+#include <QCryptographicHash>
+#include <QDebug>
+
+namespace Developer {
+
+RunCache::RunCache(const QString &cachePath)
+    : _cachePath(cachePath)
+    , _modified(false)
+{
+}
+
+QString RunCache::cachePath() const
+{
+    return _cachePath;
+}
+
+void RunCache::setCachePath(const QString &cachePath)
+{
+    _cachePath = cachePath;
+}
+
+bool RunCache::load()
+{
+    _results.clear();
+    _modified = false;
+
+    QFile file(_cachePath);
+    if(_cachePath.isEmpty() || !file.exists())
+        return false;
+
+    if(!file.open(QFile::ReadOnly))
+    {
+        qDebug() << "    Could not open run cache: " << _cachePath;
+        return false;
+    }
+
+    QDomDocument document("runs");
+    if(!document.setContent(&file))
+    {
+        qDebug() << "    Run cache could not be parsed, ignoring it.";
+        return false;
+    }
+
+    QDomNodeList runs = document.documentElement().elementsByTagName("run");
+    for(int i = 0; i < runs.count(); ++i)
+    {
+        QDomElement elem = runs.at(i).toElement();
+        Result r;
+        r.file = elem.attribute("result");
+        r.hash = elem.attribute("hash").toLatin1();
+        if(r.file.isEmpty())
+            continue;
+
+        _results.insert(elem.attribute("key").toLatin1(), r);
+    }
+
+    return true;
+}
+
+bool RunCache::save()
+{
+    // Drop results which have since been deleted or overwritten, result()
+    // would never return them again
+    QDir cacheDir = QFileInfo(_cachePath).dir();
+    resultIter iter = _results.begin();
+    while(iter != _results.end())
+    {
+        QString path = cacheDir.filePath(iter.value().file);
+        if(QFile::exists(path) && fileHash(path) == iter.value().hash)
+            ++iter;
+        else
+        {
+            iter = _results.erase(iter);
+            _modified = true;
+        }
+    }
+
+    if(!_modified || _cachePath.isEmpty())
+        return true;
+
+    QDomDocument doc("runs");
+    QDomElement root = doc.createElement("runs");
+    doc.appendChild(root);
+
+    for(resultConstIter iter = _results.begin(); iter != _results.end(); ++iter)
+    {
+        QDomElement run = doc.createElement("run");
+        run.setAttribute("key", QString(iter.key()));
+        run.setAttribute("result", iter.value().file);
+        run.setAttribute("hash", QString(iter.value().hash));
+        root.appendChild(run);
+    }
+
+    QFile file(_cachePath);
+    if(!file.open(QFile::WriteOnly | QFile::Truncate))
+    {
+        qDebug() << "    Could not write run cache: " << _cachePath;
+        return false;
+    }
+
+    QString xml = doc.toString(4);
+    xml.prepend("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+    file.write(xml.toUtf8());
+    file.close();
+
+    _modified = false;
+    return true;
+}
+
+QByteArray RunCache::key(const QString &programFile, const QString &graphFile,
+                         const QString &compilerIdentity)
+{
+    // Without a known compiler a result can't be trusted to be reproducible
+    if(compilerIdentity.isEmpty())
+        return QByteArray();
+
+    QFile program(programFile);
+    QFile graph(graphFile);
+    if(!program.open(QFile::ReadOnly) || !graph.open(QFile::ReadOnly))
+        return QByteArray();
+
+    // Lengths are included so that content can't shift between the parts
+    QByteArray programText = program.readAll();
+    QByteArray graphText = graph.readAll();
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(compilerIdentity.toUtf8());
+    hash.addData(QByteArray::number(programText.size()) + ":");
+    hash.addData(programText);
+    hash.addData(QByteArray::number(graphText.size()) + ":");
+    hash.addData(graphText);
+    return hash.result().toHex();
+}
+
+QString RunCache::result(const QByteArray &runKey) const
+{
+    if(runKey.isEmpty())
+        return QString();
+
+    resultConstIter iter = _results.find(runKey);
+    if(iter == _results.end())
+        return QString();
+
+    // Results are stored relative to the cache so the project can be moved
+    QString path = QFileInfo(_cachePath).dir().filePath(iter.value().file);
+    if(!QFile::exists(path) || fileHash(path) != iter.value().hash)
+        return QString();
+
+    return path;
+}
+
+void RunCache::insert(const QByteArray &runKey, const QString &resultFile)
+{
+    if(runKey.isEmpty())
+        return;
+
+    Result r;
+    r.file = QFileInfo(_cachePath).dir().relativeFilePath(resultFile);
+    r.hash = fileHash(resultFile);
+    if(r.hash.isEmpty())
+        return;
+
+    _results.insert(runKey, r);
+    _modified = true;
+}
+
+QByteArray RunCache::fileHash(const QString &filePath)
+{
+    QFile file(filePath);
+    if(!file.open(QFile::ReadOnly))
+        return QByteArray();
+
+    return QCryptographicHash::hash(file.readAll(),
+                                    QCryptographicHash::Sha1).toHex();
+}
+
+}
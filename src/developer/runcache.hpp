@@ -0,0 +1,85 @@
+/*!
+ * \file
+ */
+#ifndef RUNCACHE_HPP
+#define RUNCACHE_HPP
+
+#include <QString>
+#include <QByteArray>
+#include <QMap>
+
+namespace Developer {
+
+/*!
+ * \brief Record of the output produced by previous runs
+ *
+ * The output of a run is determined entirely by the program text (including
+ * the rules appended to it), the host graph and the compiler used. The run
+ * cache maps a hash of those inputs to the result graph the run produced so
+ * that an identical run can simply reuse the existing result.
+ *
+ * A stored result is only returned while the result file is unchanged on
+ * disk, results which have since been deleted or overwritten are treated as
+ * misses and are dropped when the cache is next saved.
+ *
+ * The cache is stored in the project's results directory:
+ *
+ * \code
+ *  <?xml version="1.0" encoding="UTF-8" ?>
+ *  <runs>
+ *      <run key="..." result="Graph0_RunConfig.host" hash="..." />
+ *  </runs>
+ * \endcode
+ */
+class RunCache
+{
+public:
+    explicit RunCache(const QString &cachePath = QString());
+
+    QString cachePath() const;
+    void setCachePath(const QString &cachePath);
+
+    bool load();
+    bool save();
+
+    /*!
+     * \brief Compute the key identifying a run's inputs
+     *
+     * \param programFile       The program text with all rules appended
+     * \param graphFile         The host graph
+     * \param compilerIdentity  The compiler's identity, see
+     *  ValidationCache::identify()
+     * \return The key, or an empty array if one of the files could not be read
+     */
+    static QByteArray key(const QString &programFile, const QString &graphFile,
+                          const QString &compilerIdentity);
+
+    /*!
+     * \brief Look up the result of a previous identical run
+     * \param runKey    The key returned by key()
+     * \return The absolute path to the result graph, or an empty string if
+     *  there is no usable result
+     */
+    QString result(const QByteArray &runKey) const;
+    void insert(const QByteArray &runKey, const QString &resultFile);
+
+private:
+    struct Result
+    {
+        QString file;
+        QByteArray hash;
+    };
+
+    static QByteArray fileHash(const QString &filePath);
+
+    QString _cachePath;
+    QMap<QByteArray, Result> _results;
+    bool _modified;
+
+    typedef QMap<QByteArray, Result>::iterator resultIter;
+    typedef QMap<QByteArray, Result>::const_iterator resultConstIter;
+};
+
+}
+
+#endif // RUNCACHE_HPP
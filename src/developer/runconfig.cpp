@@ -12,6 +12,11 @@ RunConfig::RunConfig(QObject *parent, const QString& name, const QString& progra
 		, _graph(graph)
 		, _tracing(false)
 		, _backtracking(false)
+		, _timeLimit(0)
+		, _cpuLimit(0)
+		, _memoryLimit(0)
+		, _benchmarkRuns(0)
+		, _warmupRuns(0)
 {
 }
 
@@ -32,6 +37,10 @@ QString RunConfig::graph()
 {
 	return _graph;
 }
+QString RunConfig::batchGraphs()
+{
+	return _batchGraphs;
+}
 
 bool RunConfig::getTracing()
 {
@@ -57,6 +66,11 @@ void RunConfig::setGraph(QString graph)
 	_graph = graph;
 }
 
+void RunConfig::setBatchGraphs(QString pattern)
+{
+	_batchGraphs = pattern;
+}
+
 void RunConfig::setTracing(bool tracing)
 {
 	_tracing = tracing;
@@ -75,4 +89,58 @@ bool RunConfig::hasBacktracking()
 	return _backtracking;
 }
 
+int RunConfig::timeLimit()
+{
+	return _timeLimit;
+}
+int RunConfig::cpuLimit()
+{
+	return _cpuLimit;
+}
+int RunConfig::memoryLimit()
+{
+	return _memoryLimit;
+}
+
+void RunConfig::setTimeLimit(int seconds)
+{
+	_timeLimit = qMax(seconds, 0);
+}
+void RunConfig::setCpuLimit(int seconds)
+{
+	_cpuLimit = qMax(seconds, 0);
+}
+void RunConfig::setMemoryLimit(int megabytes)
+{
+	_memoryLimit = qMax(megabytes, 0);
+}
+
+bool RunConfig::hasLimits()
+{
+	return _timeLimit > 0 || _cpuLimit > 0 || _memoryLimit > 0;
+}
+
+int RunConfig::benchmarkRuns()
+{
+	return _benchmarkRuns;
+}
+int RunConfig::warmupRuns()
+{
+	return _warmupRuns;
+}
+
+void RunConfig::setBenchmarkRuns(int runs)
+{
+	_benchmarkRuns = qMax(runs, 0);
+}
+void RunConfig::setWarmupRuns(int runs)
+{
+	_warmupRuns = qMax(runs, 0);
+}
+
+bool RunConfig::isBenchmark()
+{
+	return _benchmarkRuns > 0;
+}
+
 }
@@ -19,6 +19,7 @@ public:
 		QString name();
 		QString program();
 		QString graph();
+		QString batchGraphs();
 
 		bool getTracing();
 		bool getBacktracking();
@@ -26,6 +27,7 @@ public:
 		void setName(QString name);
 		void setProgram(QString program);
 		void setGraph(QString graph);
+		void setBatchGraphs(QString pattern);
 
 		void setTracing(bool tracing);
 		void setBacktracking(bool backtracking);
@@ -33,6 +35,22 @@ public:
 		bool hasTracing();
 		bool hasBacktracking();
 
+		// Limits on gp2run, 0 means unlimited
+		int timeLimit();
+		int cpuLimit();
+		int memoryLimit();
+		void setTimeLimit(int seconds);
+		void setCpuLimit(int seconds);
+		void setMemoryLimit(int megabytes);
+		bool hasLimits();
+
+		// Number of measured executions of gp2run, 0 for a normal run
+		int benchmarkRuns();
+		int warmupRuns();
+		void setBenchmarkRuns(int runs);
+		void setWarmupRuns(int runs);
+		bool isBenchmark();
+
 
 signals:
     
@@ -42,8 +60,14 @@ private:
 		QString _name;
 		QString _graph;
 		QString _program;
+		QString _batchGraphs;
 		bool _tracing;
-		bool _backtracking;    
+		bool _backtracking;
+		int _timeLimit;
+		int _cpuLimit;
+		int _memoryLimit;
+		int _benchmarkRuns;
+		int _warmupRuns;    
 };
 
 }
@@ -6,13 +6,26 @@
 
 #include "project.hpp"
 #include "rule.hpp"
+#include "runpipeline.hpp"
+#include "batchrun.hpp"
+#include "runqueue.hpp"
+#include "runcache.hpp"
+#include "validationcache.hpp"
+#include "syntaxcheck.hpp"
 
 #include <QFile>
 #include <QByteArray>
 #include <QFileInfo>
 #include <QFile>
 #include <QMessageBox>
+#include <QFileDialog>
+#include <QDir>
+#include <QDateTime>
+#include <QSettings>
+#include <QScrollBar>
+#include <QTextCursor>
 #include <QProcess>
+#include <QSet>
 
 #include <stdlib.h>  /* system, NULL, EXIT_FAILURE */
 
@@ -30,9 +43,49 @@ RunConfiguration::RunConfiguration(Project *proj, QWidget *parent, RunConfig* ru
     , _project(proj)
     , _runs(0)
     , _config(runConfig)
+    , _pipeline(new RunPipeline(this))
+    , _batch(new BatchRun(this))
+    , _queue(0)
+    , _unattended(false)
 {
     _ui->setupUi(this);
 
+    _ui->cancelButton->setVisible(false);
+    _ui->progressWidget->setVisible(false);
+    _ui->outputView->setVisible(false);
+
+    // The view only keeps the most recent lines, the full output of a run is
+    // in its log file in the results directory
+    QFont outputFont("Monospace");
+    outputFont.setStyleHint(QFont::TypeWriter);
+    _ui->outputView->setFont(outputFont);
+    _ui->outputView->setMaximumBlockCount(
+                QSettings().value("Run/OutputLines", 5000).toInt());
+
+    connect(_pipeline, SIGNAL(stageChanged(int,QString)),
+            this, SLOT(pipelineStageChanged(int,QString)));
+    connect(_pipeline, SIGNAL(progress(int,int)),
+            this, SLOT(pipelineProgress(int,int)));
+    connect(_pipeline, SIGNAL(output(QString)),
+            this, SLOT(pipelineOutput(QString)));
+    connect(_pipeline, SIGNAL(failed(QString,QString)),
+            this, SLOT(pipelineFailed(QString,QString)));
+    connect(_pipeline, SIGNAL(finished(bool)),
+            this, SLOT(pipelineFinished(bool)));
+    connect(_batch, SIGNAL(instanceFinished(QString,QString,int,qint64)),
+            this, SLOT(batchInstanceFinished(QString,QString,int,qint64)));
+    connect(_batch, SIGNAL(progress(int,int)),
+            this, SLOT(batchProgress(int,int)));
+    connect(_batch, SIGNAL(failed(QString,QString)),
+            this, SLOT(pipelineFailed(QString,QString)));
+    connect(_batch, SIGNAL(finished(int,int)),
+            this, SLOT(batchFinished(int,int)));
+    connect(_ui->cancelButton, SIGNAL(clicked()), this, SLOT(cancelRun()));
+
+    _pipeline->setValidationCache(_project->validationCache());
+    _batch->setValidationCache(_project->validationCache());
+    _batch->setRunCache(_project->runCache());
+
     // Load the main stylesheet and apply it to this widget
     QFile fp(":/stylesheets/runconfiguration.css");
     fp.open(QIODevice::ReadOnly | QIODevice::Text);
@@ -57,11 +110,19 @@ RunConfiguration::RunConfiguration(Project *proj, QWidget *parent, RunConfig* ru
         index = _ui->targetGraphCombo->findText(_config->graph());
         if (index != -1)
             _ui->targetGraphCombo->setCurrentIndex(index);
+
+        _ui->batchGraphsEdit->setText(_config->batchGraphs());
+        _ui->timeLimitSpin->setValue(_config->timeLimit());
+        _ui->cpuLimitSpin->setValue(_config->cpuLimit());
+        _ui->memoryLimitSpin->setValue(_config->memoryLimit());
+        _ui->benchmarkRunsSpin->setValue(_config->benchmarkRuns());
+        _ui->warmupRunsSpin->setValue(_config->warmupRuns());
     }
 }
 
 RunConfiguration::~RunConfiguration()
 {
+    removeProgramFile();
     delete _ui;
     if (_config)
         delete _config;
@@ -87,6 +148,39 @@ QString RunConfiguration::graph() const
     return _ui->targetGraphCombo->currentText();
 }
 
+bool RunConfiguration::isRunning() const
+{
+    return _pipeline->isRunning() || _batch->isRunning();
+}
+
+bool RunConfiguration::isUnattended() const
+{
+    return _unattended;
+}
+
+void RunConfiguration::setUnattended(bool unattended)
+{
+    _unattended = unattended;
+}
+
+QString RunConfiguration::lastError() const
+{
+    return _lastError;
+}
+
+void RunConfiguration::reportError(const QString &title,
+                                   const QString &message)
+{
+    if (!_unattended)
+    {
+        QMessageBox::warning(this, title, message);
+        return;
+    }
+
+    qDebug() << "   " << title << "-" << message;
+    _lastError = message;
+}
+
 
 void RunConfiguration::setName(QString name)
 {
@@ -122,6 +216,33 @@ void RunConfiguration::setGraph(QString graphName)
 
 
 
+void RunConfiguration::setRunQueue(RunQueue *queue)
+{
+    _queue = queue;
+}
+
+void RunConfiguration::queueRun()
+{
+    if (_queue == 0)
+    {
+        runConfiguration();
+        return;
+    }
+
+    _queue->enqueue(this, RunQueue::Kind_Single);
+}
+
+void RunConfiguration::queueBatch()
+{
+    if (_queue == 0)
+    {
+        runBatch();
+        return;
+    }
+
+    _queue->enqueue(this, RunQueue::Kind_Batch);
+}
+
 void RunConfiguration::toggleDetails()
 {
     _ui->detailsWidget->setVisible(!_ui->detailsWidget->isVisible());
@@ -166,34 +287,117 @@ void RunConfiguration::updateGraphs()
     }
 }
 
-void RunConfiguration::runConfiguration()
+bool RunConfiguration::runConfiguration()
 {
 
     QString configName =  _ui->configurationNameEdit->text();
     qDebug() << "Running configuration" << configName;
 
+    if (isRunning())
+    {
+        qDebug() << "    Configuration is already running, ignoring.";
+        return false;
+    }
+    _lastError = QString();
+
+    QString programTmp = writeProgramFile();
+    if (programTmp.isEmpty())
+        return false;
+
+    /* Locate the selected GP host graph */
+
+    QString graphName = _ui->targetGraphCombo->currentText();
+    Graph* graph = _project->graph(graphName);
+    if (!graph || !graph->save())
+    {
+        // Couldn't save the specified graph
+        reportError(
+                    tr("Saving Host Graph Failed"),
+                    tr("Could not save the graph %1 before running. Check the log for details.")
+                    .arg(graphName)
+                    );
+        removeProgramFile();
+        return false;
+    }
+
+    QString hostgraphFile = graph->absolutePath();
+
+
+    //hostgraph = "~/github/GP2Test/hostgraphs/1.graph";
+
+    if (!storeConfig())
+    {
+        removeProgramFile();
+        return false;
+    }
+    applyRunOptions();
+
+    /* Reuse the result of an identical earlier run */
+    _runKey = RunCache::key(programTmp, hostgraphFile,
+                            ValidationCache::identify(_pipeline->compiler()));
+    // A benchmark is run for its measurements, not its output graph
+    if (!_ui->forceRerunCheckBox->isChecked() && !_config->isBenchmark())
+    {
+        QString previous = _project->runCache()->result(_runKey);
+        if (!previous.isEmpty())
+        {
+            qDebug() << "    Inputs unchanged since an earlier run, reusing result:"
+                     << previous;
+            removeProgramFile();
+            handleResult(previous);
+            return false;
+        }
+    }
+
+    /* Desired location of output */
+    // The actual output is written to gp2.output in the run's build directory
+    // and copied here once the run succeeds
+    QDir resultsDir = _project->resultsDir();
+    QString results = resultsDir.absolutePath();
+
+    //qDebug() << "Results dir is: " << results << ", exists: " <<  resultsDir.exists() << ", isReadable: " << resultsDir.isReadable();
+
+    QString output = results + "/Graph"+ QVariant(_runs).toString() + "_" + configName + ".host"; //eg. project/results/RunConfig1_run1.gpg  or project/results/RunConfig1_run2.gpg etc.
+    QFileInfo checkFile(output);
+    if (checkFile.exists())
+    {
+        qDebug() << "    Truncating the file: " << output;
+        QFile outputFile(output);
+        outputFile.open(QFile::WriteOnly|QFile::Truncate);
+        outputFile.close();
+    }
+
+    /* Call the compiler and run the executable */
+    // The run continues in the background, pipelineFinished() picks up the
+    // result once the output graph has been produced
+    return run(programTmp, hostgraphFile, output);
+}
+
+QString RunConfiguration::writeProgramFile()
+{
     QString progName = _ui->programCombo->currentText();
     Program* prog = _project->program(progName);    // exploiting that project->program(path) first iterates through _programs and compares program.name() with path
     if (!prog || !prog->save())
     {
         // Couldn't save the specified program
-        QMessageBox::warning(
-                    this,
+        reportError(
                     tr("Saving Program Failed"),
                     tr("Could not save the program %1 before running. Check the log for details.")
-                    .arg(prog->baseName())
+                    .arg(progName)
                     );
-        return;
+        return QString();
     }
 
 
     QString programString = prog->program();
     //program = qPrintable(prog->absolutePath());
 
-    // Collect all rule specifications, we have to append them to the program text
-    QVector<Rule *> rules =  _project->rules();
+    // Collect the rule specifications the program can call, we have to append
+    // them to the program text
+    QVector<Rule *> rules = reachableRules(prog);
 
     QStringList resultList;
+    _rulePaths.clear();
     for (QVector<Rule *>::iterator it = rules.begin(); it!= rules.end(); ++it)
     {
         Rule* rule = *it;
@@ -202,70 +406,149 @@ void RunConfiguration::runConfiguration()
         if (!rule || !rule->save())
         {
             // Couldn't save on of the rules
-            QMessageBox::warning(
-                        this,
+            reportError(
                         tr("Saving Program Failed"),
                         tr("Could not save the rule %1 before running. Check the log for details.")
                         .arg(rule->name())
                         );
-            return;
+            return QString();
         }
         else
         {
             resultList << rule->toAlternative();
+            _rulePaths << rule->absolutePath();
         }
     }
 
     QString ruleStrings = resultList.join("\n");
 
-    // Create temporary file to hold program text and rules
-    QString programTmp = prog->absolutePath() + ".tmp";
-    QFile file(programTmp);  
-  
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) 
+    // The program text and rules go in the run's own build directory under
+    // the program's file name, so overlapping runs can't clash and the file
+    // is cleaned up along with the build
+    removeProgramFile();
+    QString buildDirectory = _pipeline->prepareBuildDirectory();
+    if (buildDirectory.isEmpty())
     {
-        qDebug() << "    Could not open a temporary file for writing: " << programTmp;
+        reportError(
+                    tr("Saving Program Failed"),
+                    tr("Could not create a build directory in %1.")
+                    .arg(_pipeline->buildRoot())
+                    );
+        return QString();
     }
-    else 
+
+    QFile file(QDir(buildDirectory).filePath(
+                   QFileInfo(prog->absolutePath()).fileName()));
+    if (!file.open(QFile::WriteOnly | QFile::Truncate))
     {
-        QTextStream content(&file);
-        content << programString << "\n\n" << ruleStrings;
+        qDebug() << "    Could not open the program file for writing: "
+                 << file.fileName();
+        _pipeline->discardBuildDirectory();
+        return QString();
     }
+
+    QTextStream content(&file);
+    content << programString << "\n\n" << ruleStrings;
+    content.flush();
+    _programFile = file.fileName();
     file.close();
 
-    /* Locate the selected GP host graph */
+    return _programFile;
+}
 
-    QString graphName = _ui->targetGraphCombo->currentText();
-    Graph* graph = _project->graph(graphName);
-    if (!graph || !graph->save())
+void RunConfiguration::removeProgramFile()
+{
+    if (_programFile.isEmpty())
+        return;
+
+    // Once a run has started the pipeline owns the directory, and cleans it
+    // up according to its policy
+    _pipeline->discardBuildDirectory();
+    _programFile = QString();
+}
+
+QVector<Rule *> RunConfiguration::reachableRules(Program *prog)
+{
+    QVector<Rule *> rules = _project->rules();
+
+    QStringList called;
+    QStringList declared;
+    if (!SyntaxCheck::reachableRules(prog->absolutePath(), &called, &declared))
     {
-        // Couldn't save the specified graph
+        // The program stage reports the syntax error, until then assume every
+        // rule may be needed
+        qDebug() << "    Program could not be parsed, including every rule";
+        return rules;
+    }
+
+    QVector<Rule *> reachable;
+    QSet<QString> found;
+    for (QVector<Rule *>::iterator it = rules.begin(); it!= rules.end(); ++it)
+    {
+        Rule* rule = *it;
+        if (rule && called.contains(rule->name()))
+        {
+            reachable << rule;
+            found.insert(rule->name());
+        }
+    }
+
+    QStringList missing;
+    for (int i = 0; i < called.count(); ++i)
+    {
+        if (!found.contains(called.at(i)) && !declared.contains(called.at(i)))
+            missing << called.at(i);
+    }
+
+    qDebug() << "    Program calls" << reachable.count() << "of" << rules.count()
+             << "rules in the project";
+
+    // The run goes ahead regardless, so a queued run only logs this
+    if (!missing.isEmpty() && _unattended)
+    {
+        missing.sort();
+        qDebug() << "    Program calls rules which are not in the project:"
+                 << missing.join(", ");
+    }
+    else if (!missing.isEmpty())
+    {
+        missing.sort();
         QMessageBox::warning(
                     this,
-                    tr("Saving Host Graph Failed"),
-                    tr("Could not save the graph %1 before running. Check the log for details.")
-                    .arg(graphName)
+                    tr("Missing Rules"),
+                    tr("The program %1 calls rules which are not in the project: %2")
+                    .arg(prog->name())
+                    .arg(missing.join(", "))
                     );
-        return;
     }
 
-    QString hostgraphFile = graph->absolutePath();
-
+    return reachable;
+}
 
-    //hostgraph = "~/github/GP2Test/hostgraphs/1.graph";
+bool RunConfiguration::storeConfig()
+{
+    QString configName = _ui->configurationNameEdit->text();
+    QString progName = _ui->programCombo->currentText();
+    QString graphName = _ui->targetGraphCombo->currentText();
 
     // Update the corresponding RunConfig object
     // _config = _project->runConfig(configName);
 
     if (!_config)
-        _config = new RunConfig(_project, configName, prog->name(), graph->fileName());
+        _config = new RunConfig(_project, configName, progName, graphName);
 
     else
     {
         _config->setName(configName);
-        _config->setProgram(prog->name());
-        _config->setGraph(graph->fileName());
+        _config->setProgram(progName);
+        _config->setGraph(graphName);
     }
+    _config->setBatchGraphs(_ui->batchGraphsEdit->text().trimmed());
+    _config->setTimeLimit(_ui->timeLimitSpin->value());
+    _config->setCpuLimit(_ui->cpuLimitSpin->value());
+    _config->setMemoryLimit(_ui->memoryLimitSpin->value());
+    _config->setBenchmarkRuns(_ui->benchmarkRunsSpin->value());
+    _config->setWarmupRuns(_ui->warmupRunsSpin->value());
 
     // Update the project
     // Check the current configuration is non-local (i.e. it exists in the project already)
@@ -279,44 +562,201 @@ void RunConfiguration::runConfiguration()
         if (!_addSuccess)
         {
             // Local and couldn't save to project, probably name clash
-            QMessageBox::information(
-                        this,
+            reportError(
                         tr("Saving Run Configuration Failed"),
                         tr("There is already an existing run configuration with the same name."));
-            return;
+            return false;
         }
     }
 
     // This will save the project file (.gpp) along with the run congfigurations
     // Will not do a recursive save on all files
     _project->save();
+    return true;
+}
 
-    /* Desired location of output */
-    // The actual output is put by default in /tmp/gp2/gp2.output
-    QDir resultsDir = _project->resultsDir();
-    QString results = resultsDir.absolutePath();
+void RunConfiguration::applyRunOptions()
+{
+    _pipeline->setTimeLimit(_config->timeLimit());
+    _pipeline->setCpuLimit(_config->cpuLimit());
+    _pipeline->setMemoryLimit(_config->memoryLimit());
+    _pipeline->setRepetitions(_config->benchmarkRuns(), _config->warmupRuns());
+    _batch->setLimits(_config->timeLimit(), _config->cpuLimit(),
+                      _config->memoryLimit());
+}
 
-    //qDebug() << "Results dir is: " << results << ", exists: " <<  resultsDir.exists() << ", isReadable: " << resultsDir.isReadable();
+bool RunConfiguration::runBatch()
+{
+    QString configName = _ui->configurationNameEdit->text();
+    qDebug() << "Running configuration" << configName << "as a batch";
 
-    QString output = results + "/Graph"+ QVariant(_runs).toString() + "_" + configName + ".host"; //eg. project/results/RunConfig1_run1.gpg  or project/results/RunConfig1_run2.gpg etc.
-    QFileInfo checkFile(output);
-    if (checkFile.exists())
+    if (isRunning())
     {
-        qDebug() << "    Truncating the file: " << output;
-        QFile outputFile(output);
-        outputFile.open(QFile::WriteOnly|QFile::Truncate);
-        outputFile.close();
+        qDebug() << "    Configuration is already running, ignoring.";
+        return false;
     }
+    _lastError = QString();
+
+    QString pattern = _ui->batchGraphsEdit->text().trimmed();
+    QStringList graphs = BatchRun::expandGraphs(pattern, _project->dir());
+    if (graphs.isEmpty())
+    {
+        reportError(
+                    tr("No Host Graphs"),
+                    tr("No host graphs match the batch graphs \"%1\".")
+                    .arg(pattern));
+        return false;
+    }
+
+    QString programTmp = writeProgramFile();
+    if (programTmp.isEmpty())
+        return false;
+    if (!storeConfig())
+    {
+        removeProgramFile();
+        return false;
+    }
+    applyRunOptions();
+
+    // Each batch files its results in a directory and Results group of its
+    // own, down to the millisecond so that batches started in quick
+    // succession stay apart
+    QDateTime now = QDateTime::currentDateTime();
+    _batchLabel = tr("Batch %1").arg(now.toString("yyyy-MM-dd hh:mm:ss.zzz"));
+    QString output = _project->resultsDir().filePath(
+                configName + "_Batch" + now.toString("yyyyMMdd-hhmmss-zzz"));
+
+    // Only the rules written into the program by writeProgramFile()
+    _batch->setRules(_rulePaths);
+    _batch->setCompiler(_pipeline->compiler());
+    _batch->setReuseResults(!_ui->forceRerunCheckBox->isChecked());
+
+    _ui->runButton->setEnabled(false);
+    _ui->batchButton->setEnabled(false);
+    _ui->cancelButton->setVisible(true);
+    _ui->progressWidget->setVisible(true);
+
+    _batch->start(programTmp, graphs, output);
+    return true;
+}
+
+void RunConfiguration::selectBatchGraphs()
+{
+    QString dir = QFileDialog::getExistingDirectory(
+                this,
+                tr("Select Host Graph Directory"),
+                _project->dir().absolutePath()
+                );
+
+    if (dir.isEmpty())
+        return;
+
+    // Keep the pattern relative when it is inside the project, so the
+    // configuration still works if the project is moved
+    QString relative = _project->dir().relativeFilePath(dir);
+    if (!relative.startsWith(".."))
+        dir = relative;
+    _ui->batchGraphsEdit->setText(QDir::toNativeSeparators(dir));
+}
+
+void RunConfiguration::cancelRun()
+{
+    _pipeline->cancel();
+    _batch->cancel();
+}
+
+void RunConfiguration::batchInstanceFinished(QString graphFile,
+                                             QString outputFile, int status,
+                                             qint64 elapsed)
+{
+    emit obtainedBatchResult(_batchLabel, graphFile, outputFile, status,
+                             elapsed, _config);
+}
+
+void RunConfiguration::batchProgress(int value, int maximum)
+{
+    _ui->stageLabel->setText(tr("Batch: %1 of %2").arg(value).arg(maximum));
+    _ui->runProgress->setMaximum(maximum);
+    _ui->runProgress->setValue(value);
+}
+
+void RunConfiguration::batchFinished(int succeeded, int total)
+{
+    Q_UNUSED(succeeded)
+    Q_UNUSED(total)
+
+    _ui->runButton->setEnabled(true);
+    _ui->batchButton->setEnabled(true);
+    _ui->cancelButton->setVisible(false);
+    _ui->progressWidget->setVisible(false);
+    removeProgramFile();
+
+    emit runFinished();
+}
+
+void RunConfiguration::pipelineStageChanged(int stage, QString description)
+{
+    Q_UNUSED(stage)
+    _ui->stageLabel->setText(description);
+}
+
+void RunConfiguration::pipelineProgress(int value, int maximum)
+{
+    _ui->runProgress->setMaximum(maximum);
+    _ui->runProgress->setValue(value);
+}
+
+void RunConfiguration::pipelineOutput(QString text)
+{
+    // Output arrives in arbitrary chunks, so it is inserted at the end rather
+    // than appended as a new paragraph
+    QScrollBar *scrollBar = _ui->outputView->verticalScrollBar();
+    bool following = (scrollBar->value() == scrollBar->maximum());
+
+    QTextCursor cursor(_ui->outputView->document());
+    cursor.movePosition(QTextCursor::End);
+    cursor.insertText(text);
+
+    if (following)
+        scrollBar->setValue(scrollBar->maximum());
+}
+
+void RunConfiguration::pipelineFailed(QString title, QString message)
+{
+    reportError(title, message);
+}
+
+void RunConfiguration::pipelineFinished(bool success)
+{
+    _ui->runButton->setEnabled(true);
+    _ui->batchButton->setEnabled(true);
+    _ui->cancelButton->setVisible(false);
+    _ui->progressWidget->setVisible(false);
+    removeProgramFile();
 
-    /* Call the compiler and run the executable */
-    bool success = run(programTmp, hostgraphFile, output);
     if (!success)
     {
-        // The Compiler failed to validate/compile/execute (instead of giving a proper Fail)
+        // The Compiler failed to validate/compile/execute (instead of giving a
+        // proper Fail), or the run was cancelled. Only a run stopped by one of
+        // its limits is worth keeping in the results.
+        RunPipeline::Limit limit = _pipeline->exceededLimit();
+        if (limit != RunPipeline::Limit_None)
+            emit runStopped(_ui->targetGraphCombo->currentText(),
+                            RunPipeline::limitName(limit), _config);
+        emit runFinished();
         return;
     }
     _runs ++;
 
+    _project->runCache()->insert(_runKey, _output);
+    _project->runCache()->save();
+
+    handleResult(_output);
+    emit runFinished();
+}
+
+void RunConfiguration::handleResult(const QString &output)
+{
     /*
       Check for failure - represented as a string in the output
       The compiler uses the following code to represent failure:
@@ -354,8 +794,7 @@ void RunConfiguration::runConfiguration()
 
     if (failure)
     {
-        QMessageBox::information(
-                    this,
+        reportError(
                     tr("Run Failed"),
                     tr("Running the program produced Failure"));
         return;
@@ -369,266 +808,30 @@ void RunConfiguration::runConfiguration()
 
 bool RunConfiguration::run(QString programFile, QString graphFile, QString outputFile)
 {
-    /* Location of GP Compiler */
-    //QString GPCompilerDir = "~/github/GP2/Compiler";
-    // QString GPCompilerDir = QString(COMPILER_LOCATION);
-    QString Compiler = "gp2compile";
-    QStringList args = QStringList();
-
-    //qDebug() << "Location of GP2 Compiler: " << Compiler;
-
-    QProcess validate;
-    // http://stackoverflow.com/questions/3852587/how-to-get-stdout-from-a-qprocess
-    validate.setProcessChannelMode(QProcess::MergedChannels);
-
-    /* ****************** */
-    /* Validate each rule */
-    /* ****************** */
-
-    // Collect all rules
-    QVector<Rule *> rules =  _project->rules();
-    qDebug () << "  Attempting to validate Rules.";
-
-    for (QVector<Rule *>::iterator it = rules.begin(); it!= rules.end(); ++it)
-    {
-        Rule* rule = *it;
-        args.clear();
-        args << "-r" << rule->absolutePath().replace(" ","\\ ");
-
-        validate.start(Compiler, args);
-
-        if (!validate.waitForStarted())
-        {
-            QMessageBox::information(
-                        this,
-                        tr("Validation Failed"),
-                        tr("Could not start validating one of the rules."));
-            validate.close();
-            return false;
-        }
-
-        if (!validate.waitForFinished()) // sets current thread to sleep
-        {
-            QMessageBox::information(
-                        this,
-                        tr("Validation Failed"),
-                        tr("Could not finish validating one of the rules."));
-            validate.close();
-            return false;
-        }
-
-        QByteArray validateOutput = validate.readAllStandardOutput();
-        qDebug() << "    " << QString(validateOutput).simplified();
-        if (!validateOutput.contains("is valid"))
-        {
-            QMessageBox::information(
-                        this,
-                        tr("Validation Failed"),
-                        tr("Could not validate one of the rules. See the log for details."));
-            validate.close();
-            return false;
-        }
-        validate.close();
-    }
-    qDebug () << "  Validation of Rules completed.";
-
-
-    /* ******************************* */
-    /* Validate program and host graph */
-    /* ******************************* */
-    args.clear();
-    args << "-p" << programFile.replace(" ","\\ ");
-
-    validate.start(Compiler, args);
-    qDebug () << "  Attempting to validate Program:" << Compiler << args;
-
-    if (!validate.waitForStarted())
-    {
-        QMessageBox::information(
-                    this,
-                    tr("Validation Failed"),
-                    tr("Could not start validating the given program."));
-        validate.close();
-        return false;
-    }
-
-    if (!validate.waitForFinished()) // sets current thread to sleep
-    {
-        QMessageBox::information(
-                    this,
-                    tr("Validation Failed"),
-                    tr("Could not finish validating the given program."));
-        validate.close();
-        return false;
-    }
-
-    QByteArray validateOutput = validate.readAllStandardOutput();
-    qDebug() << "    " << QString(validateOutput).simplified();
-    if (!validateOutput.contains("is valid"))
-    {
-        QMessageBox::information(
-                    this,
-                    tr("Validation Failed"),
-                    tr("Could not validate the given configartion. See the log for details."));
-        validate.close();
-        return false;
-    }
-    validate.close();
-
-    // do the same for the host graph
-    args.clear(); args << "-h" << graphFile.replace(" ","\\ ");
-    validate.start(Compiler, args);
-    qDebug () << "  Attempting to validate Host Graph:" << Compiler << args;
-
-    if (!validate.waitForStarted())
-    {
-        QMessageBox::information(
-                    this,
-                    tr("Validation Failed"),
-                    tr("Could not start validating the given host graph."));
-        validate.close();
-        return false;
-    }
-
-    if (!validate.waitForFinished())
-    {
-        QMessageBox::information(
-                    this,
-                    tr("Validation Failed"),
-                    tr("Could not finish validating the given host graph."));
-        validate.close();
-        return false;
-    }
-
-    validateOutput = validate.readAllStandardOutput();
-    qDebug() << "    " << QString(validateOutput).simplified();
-    if (!validateOutput.contains("is valid"))
-    {
-        QMessageBox::information(
-                    this,
-                    tr("Validation Failed"),
-                    tr("Could not validate the given host graph. See the log for details."));
-        validate.close();
-        return false;
-    }
-    validate.close();
-
-    /* *************************************************** */
-    /* Create command for compiling program and host graph */
-    /* *************************************************** */
-    args.clear();
-    args << programFile.replace(" ","\\ ") << graphFile.replace(" ","\\ ");
-
-    // Clear the output directory first;
-    QString tempPath = "/tmp/gp2";
-    QFileInfo tmp(tempPath);
-    if (tmp.exists() && tmp.isDir())
-    {
-        qDebug () << "  Cleaning temporary directory" << tempPath;
-        QDir dir(tempPath);
-        dir.setNameFilters(QStringList() << "*.*");
-        dir.setFilter(QDir::Files);
-        foreach(QString dirFile, dir.entryList())
-        {
-            dir.remove(dirFile);
-        }
-    }
-
-    // The actual output is put by default in /tmp/gp2/gp2.output
-    QProcess compile;
-    // http://stackoverflow.com/questions/3852587/how-to-get-stdout-from-a-qprocess
-    compile.setProcessChannelMode(QProcess::MergedChannels);
-
-    qDebug () << "  Attempting to Compile configuration:" << Compiler << args;
-    compile.start(Compiler, args);
-    if (!compile.waitForStarted())
-    {
-        QMessageBox::information(
-                    this,
-                    tr("Compilation Failed"),
-                    tr("Could not start compiling the given configartion."));
-        compile.close();
-        return false;
-    }
-
-    if (!compile.waitForFinished())
+    if (isRunning())
     {
-        QMessageBox::information(
-                    this,
-                    tr("Compilation Failed"),
-                    tr("Could not finish compiling the given configartion."));
-        compile.close();
+        qDebug() << "    Configuration is already running, ignoring.";
         return false;
     }
 
-    QByteArray compileOutput = compile.readAllStandardOutput();
-    qDebug() << "    " << QString(compileOutput).simplified();
-    if (!compileOutput.contains("Generating program code...") || compileOutput.contains("Segmentation"))
-    {
-        QMessageBox::information(
-                    this,
-                    tr("Compilation Failed"),
-                    tr("Could not compile the given configartion. See the log for details."));
-        compile.close();
-        return false;
-    }
-    compile.close();
-
-    /* *********************************************************** */
-    /* Create command for running the GP program on the host graph */
-    /* *********************************************************** */
-    QString RunCmd = QString();
-    RunCmd += "cd /tmp/gp2";
-    RunCmd += " && make && ";
-    RunCmd += "./gp2run && cp gp2.output " + outputFile.replace(" ","\\ ");
-
-    qDebug () << "  Attempting to execute GP2 Program:" << RunCmd;
-//    bool success = (call(RunCmd) == 0);
-    bool success = true;
-    QProcess run;
-    // http://stackoverflow.com/questions/3852587/how-to-get-stdout-from-a-qprocess
-    run.setProcessChannelMode(QProcess::MergedChannels);
-
-    args.clear();
-    args << "-c" <<RunCmd;
-    run.start("sh", args);
-    if (!run.waitForStarted())
-    {
-        QMessageBox::information(
-                    this,
-                    tr("Run Failed"),
-                    tr("Could not start running the given configartion."));
-        run.close();
-        qDebug () << "    Run failed.";
-        return false;
-    }
+    // Each rule the program can call is validated before it is compiled, these
+    // were collected by writeProgramFile()
+    _pipeline->setRules(_rulePaths);
+    _output = outputFile;
 
-    if (!run.waitForFinished())
-    {
-        QMessageBox::information(
-                    this,
-                    tr("Run Failed"),
-                    tr("Could not finish running the given configartion."));
-        run.close();
-        qDebug () << "    Run failed.";
-        return false;
-    }
+    // The complete output is kept beside the result, eg. Graph0_RunConfig.log
+    QFileInfo outputInfo(outputFile);
+    _pipeline->setLogFile(outputInfo.dir().filePath(
+                              outputInfo.completeBaseName() + ".log"));
+    _ui->outputView->clear();
+    _ui->outputView->setVisible(true);
 
-    QByteArray runOutput = run.readAllStandardOutput();
-    qDebug() << "    " << runOutput;
-    if (!success || runOutput.contains("Error"))
-    {
-        QMessageBox::information(
-                    this,
-                    tr("Run Failed"),
-                    tr("There was something wrong with execution. See the log for details."));
-        run.close();
-        qDebug () << "    Run failed.";
-        return false;
-    }
-    qDebug () << "    Run successful.";
-    run.close();
+    _ui->runButton->setEnabled(false);
+    _ui->batchButton->setEnabled(false);
+    _ui->cancelButton->setVisible(true);
+    _ui->progressWidget->setVisible(true);
 
+    _pipeline->start(programFile, graphFile, outputFile);
     return true;
 }
 
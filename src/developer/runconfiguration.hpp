@@ -5,6 +5,7 @@
 #define RUNCONFIGURATION_HPP
 
 #include <QWidget>
+#include <QStringList>
 
 namespace Ui {
     class RunConfiguration;
@@ -13,9 +14,13 @@ namespace Ui {
 namespace Developer {
 
 class Project;
+class Program;
 class Rule;
 class Graph;
 class RunConfig;
+class RunPipeline;
+class BatchRun;
+class RunQueue;
 
 class RunConfiguration : public QWidget
 {
@@ -29,34 +34,112 @@ public:
     QString name() const;
     QString program() const;
     QString graph() const;
+    bool isRunning() const;
+
+    /*!
+     * \brief Get whether errors are recorded rather than shown
+     *
+     * A queue starts runs with nobody watching, so instead of stopping at a
+     * dialog the configuration keeps the error for lastError().
+     */
+    bool isUnattended() const;
+    void setUnattended(bool unattended);
+    //! The error which ended the latest run or batch, empty if there was none
+    QString lastError() const;
 
     void setName(QString name);
     void setProgram(QString programName);
     void setGraph(QString graphName);
 
+    /*!
+     * \brief Send the run and batch buttons' requests through a queue
+     *
+     * Without a queue the buttons start a run straight away.
+     */
+    void setRunQueue(RunQueue *queue);
+
 public slots:
     void toggleDetails();
 
     void updatePrograms();
     void updateGraphs();
-    void runConfiguration();
+    /*!
+     * \brief Start a single run of this configuration
+     * \return True if a run was started, false if there was nothing to wait
+     *  for because of an error or because an earlier result was reused
+     */
+    bool runConfiguration();
+    /*!
+     * \brief Start this configuration as a batch over its batch graphs
+     * \return True if the batch was started
+     */
+    bool runBatch();
+    void queueRun();
+    void queueBatch();
+    void selectBatchGraphs();
+    void cancelRun();
 
 signals:
     void obtainedResultGraph(QString resultLocation, RunConfig* runConfig);
+    void obtainedBatchResult(QString batch, QString hostGraph,
+                             QString resultLocation, int status,
+                             qint64 elapsed, RunConfig* runConfig);
+    void runStopped(QString hostGraph, QString reason, RunConfig* runConfig);
+    //! Emitted when a run or batch started by this configuration has ended
+    void runFinished();
     
 private slots:
     void on_deleteButton_clicked();
 
+    void pipelineStageChanged(int stage, QString description);
+    void pipelineProgress(int value, int maximum);
+    void pipelineOutput(QString text);
+    void pipelineFailed(QString title, QString message);
+    void pipelineFinished(bool success);
+    void batchInstanceFinished(QString graphFile, QString outputFile,
+                               int status, qint64 elapsed);
+    void batchProgress(int value, int maximum);
+    void batchFinished(int succeeded, int total);
+
 private:
     Ui::RunConfiguration *_ui;
     Project *_project;
     bool _existsInProject;
     RunConfig *_config;
     bool run(QString program, QString graph, QString output);
+    /*!
+     * \brief Write the program and the rules it calls into the build
+     *  directory prepared for the next run
+     * \return The file's path, or an empty string if it could not be written
+     */
+    QString writeProgramFile();
+    //! Discard the build directory of a run which never started
+    void removeProgramFile();
+    /*!
+     * \brief Get the project rules a program can call, warning about any rule
+     *  it calls which neither the project nor the program declares
+     */
+    QVector<Rule *> reachableRules(Program *prog);
+    bool storeConfig();
+    void applyRunOptions();
+    void handleResult(const QString &output);
+    //! Show an error, or record it for lastError() when unattended
+    void reportError(const QString &title, const QString &message);
 		int call(QString cmd);
     QString rulesToQString(QVector<Rule *> rules);
 
     int _runs;
+    RunPipeline *_pipeline;
+    BatchRun *_batch;
+    RunQueue *_queue;
+    QString _batchLabel;
+    QString _output;
+    QByteArray _runKey;
+    QStringList _rulePaths;
+    //! Written by writeProgramFile(), cleaned up with its build directory
+    QString _programFile;
+    bool _unattended;
+    QString _lastError;
 };
 
 }
@@ -0,0 +1,1121 @@
+/*!
+ * \file
+ */
+#include "runpipeline.hpp"
+#include "runprocess.hpp"
+#include "validationcache.hpp"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSettings>
+#include <QThread>
+#include <QTextCodec>
+#include <QTextDecoder>
+#include <QDebug>
+
+#include <QTimer>
+
+#ifdef Q_OS_UNIX
+#include <stdlib.h>
+#include <signal.h>
+#else
+#include <QCoreApplication>
+#include <QDateTime>
+#endif
+
+namespace Developer {
+
+// Text the pipeline looks for in the output of its stages
+static const char *const OutputMarkers[] = {
+    "is valid",
+    "Generating program code...",
+    "Segmentation",
+    "Error",
+    "malloc failure"
+};
+static const int OutputMarkerCount = 5;
+
+// Percentage of the CPU limit a command killed with SIGKILL must have used
+// for the kill to be blamed on the limit. The hard limit is a second past the
+// soft one, so a command killed there has used all of its time, but rusage is
+// sampled at clock ticks and can fall a little short of the real figure
+static const qint64 CpuLimitPercent = 95;
+
+// Percentage of the memory limit a crashed command's peak resident size must
+// reach for the crash to be blamed on the limit. The limit applies to the
+// address space, which also counts libraries and reserved but untouched
+// pages, so the resident size of a command which ran out stays below it
+static const qint64 MemoryLimitPercent = 90;
+
+RunPipeline::RunPipeline(QObject *parent)
+    : QObject(parent)
+    , _process(0)
+    , _stage(Stage_Idle)
+    , _compiler("gp2compile")
+    , _cleanupPolicy(Cleanup_OnSuccess)
+    , _maxParallelValidations(1)
+    , _validationCache(0)
+    , _rulesChecked(0)
+    , _step(0)
+    , _steps(0)
+    , _decoder(QTextCodec::codecForLocale()->makeDecoder())
+    , _timeLimit(0)
+    , _cpuLimit(0)
+    , _memoryLimit(0)
+    , _exceededLimit(Limit_None)
+    , _limitTimer(new QTimer(this))
+    , _benchmarkRuns(0)
+    , _warmupRuns(0)
+    , _executions(0)
+{
+    _limitTimer->setSingleShot(true);
+    connect(_limitTimer, SIGNAL(timeout()), this, SLOT(timeLimitReached()));
+
+    QSettings settings;
+    setMaxParallelValidations(settings.value(
+                                  "Run/ParallelValidations",
+                                  QThread::idealThreadCount()
+                                  ).toInt());
+    _buildRoot = settings.value("Run/BuildDirectoryRoot",
+                                defaultBuildRoot()).toString();
+    _cleanupPolicy = static_cast<CleanupPolicy>(
+                settings.value("Run/BuildDirectoryCleanup",
+                               Cleanup_OnSuccess).toInt());
+    _log.setCapacity(settings.value("Run/OutputBufferSize",
+                                    OutputLog::DefaultCapacity).toInt());
+    _externalValidation = settings.value("Run/ExternalValidation",
+                                         true).toBool();
+}
+
+RunPipeline::~RunPipeline()
+{
+    stopValidators();
+    discardBuildDirectory();
+
+    if(_process != 0)
+    {
+        _process->disconnect(this);
+        _process->killTree();
+    }
+
+    delete _decoder;
+}
+
+QString RunPipeline::compiler() const
+{
+    return _compiler;
+}
+
+void RunPipeline::setCompiler(const QString &compiler)
+{
+    _compiler = compiler;
+}
+
+QStringList RunPipeline::rules() const
+{
+    return _rules;
+}
+
+void RunPipeline::setRules(const QStringList &rulePaths)
+{
+    _rules = rulePaths;
+}
+
+QString RunPipeline::buildRoot() const
+{
+    return _buildRoot;
+}
+
+void RunPipeline::setBuildRoot(const QString &path)
+{
+    _buildRoot = path;
+}
+
+RunPipeline::CleanupPolicy RunPipeline::cleanupPolicy() const
+{
+    return _cleanupPolicy;
+}
+
+void RunPipeline::setCleanupPolicy(CleanupPolicy policy)
+{
+    _cleanupPolicy = policy;
+}
+
+QString RunPipeline::buildDirectory() const
+{
+    return _buildDirectory;
+}
+
+QString RunPipeline::defaultBuildRoot()
+{
+    return QDir::temp().filePath("gp2developer");
+}
+
+bool RunPipeline::externalValidation() const
+{
+    return _externalValidation;
+}
+
+void RunPipeline::setExternalValidation(bool external)
+{
+    _externalValidation = external;
+}
+
+int RunPipeline::maxParallelValidations() const
+{
+    return _maxParallelValidations;
+}
+
+void RunPipeline::setMaxParallelValidations(int count)
+{
+    // idealThreadCount() returns -1 if the core count can't be determined
+    _maxParallelValidations = (count < 1) ? 1 : count;
+}
+
+int RunPipeline::timeLimit() const
+{
+    return _timeLimit;
+}
+
+void RunPipeline::setTimeLimit(int seconds)
+{
+    _timeLimit = qMax(seconds, 0);
+}
+
+int RunPipeline::cpuLimit() const
+{
+    return _cpuLimit;
+}
+
+void RunPipeline::setCpuLimit(int seconds)
+{
+    _cpuLimit = qMax(seconds, 0);
+}
+
+int RunPipeline::memoryLimit() const
+{
+    return _memoryLimit;
+}
+
+void RunPipeline::setMemoryLimit(int megabytes)
+{
+    _memoryLimit = qMax(megabytes, 0);
+}
+
+RunPipeline::Limit RunPipeline::exceededLimit() const
+{
+    return _exceededLimit;
+}
+
+QString RunPipeline::limitName(Limit limit)
+{
+    switch(limit)
+    {
+    case Limit_Time:
+        return tr("Time limit exceeded");
+    case Limit_Cpu:
+        return tr("CPU time limit exceeded");
+    case Limit_Memory:
+        return tr("Memory limit exceeded");
+    default:
+        return QString();
+    }
+}
+
+QString RunPipeline::logFile() const
+{
+    return _logFile;
+}
+
+void RunPipeline::setLogFile(const QString &path)
+{
+    _logFile = path;
+}
+
+QString RunPipeline::recentOutput(int lines) const
+{
+    return _log.lastLines(lines);
+}
+
+ValidationCache *RunPipeline::validationCache() const
+{
+    return _validationCache;
+}
+
+void RunPipeline::setValidationCache(ValidationCache *cache)
+{
+    _validationCache = cache;
+}
+
+RunPipeline::Stage RunPipeline::stage() const
+{
+    return _stage;
+}
+
+bool RunPipeline::isRunning() const
+{
+    return (_stage != Stage_Idle && _stage != Stage_Finished);
+}
+
+RunUsage RunPipeline::usage() const
+{
+    return _usage;
+}
+
+void RunPipeline::setRepetitions(int runs, int warmups)
+{
+    _benchmarkRuns = qMax(runs, 0);
+    _warmupRuns = qMax(warmups, 0);
+}
+
+int RunPipeline::benchmarkRuns() const
+{
+    return _benchmarkRuns;
+}
+
+int RunPipeline::warmupRuns() const
+{
+    return _warmupRuns;
+}
+
+Benchmark RunPipeline::benchmark() const
+{
+    return _benchmark;
+}
+
+QString RunPipeline::stageName(Stage stage)
+{
+    switch(stage)
+    {
+    case Stage_ValidateRules:
+        return tr("Validating rules");
+    case Stage_ValidateProgram:
+        return tr("Validating program");
+    case Stage_ValidateGraph:
+        return tr("Validating host graph");
+    case Stage_Compile:
+        return tr("Compiling");
+    case Stage_Build:
+        return tr("Building");
+    case Stage_Execute:
+        return tr("Running");
+    case Stage_Finished:
+        return tr("Finished");
+    default:
+        return tr("Idle");
+    }
+}
+
+void RunPipeline::start(const QString &programFile, const QString &graphFile,
+                        const QString &outputFile)
+{
+    if(isRunning())
+    {
+        qDebug() << "RunPipeline::start() called during a run, ignoring";
+        return;
+    }
+
+    _programFile = programFile;
+    _graphFile = graphFile;
+    _outputFile = outputFile;
+    _step = 0;
+    _usage.clear();
+    _stageTimer.invalidate();
+    _exceededLimit = Limit_None;
+    _executions = 0;
+    _benchmark.clear();
+    _log.clear();
+    _log.open(_logFile);
+    if(_validationCache != 0)
+        _validationCache->setCompiler(_compiler);
+    // Each rule, then the program and graph validation, compile, build, run
+    _steps = _rules.count() + 4 + executionCount();
+    emit progress(_step, _steps);
+
+    // A directory prepared for this run may already hold some of its inputs
+    _buildDirectory = _preparedDirectory;
+    _preparedDirectory = QString();
+    if(_buildDirectory.isEmpty())
+        _buildDirectory = createBuildDirectory();
+
+    if(_buildDirectory.isEmpty())
+    {
+        _stage = Stage_Compile;
+        fail(tr("Compilation Failed"),
+             tr("Could not create a build directory in %1.").arg(_buildRoot));
+        return;
+    }
+
+    qDebug () << "  Attempting to validate Rules.";
+    setStage(Stage_ValidateRules);
+    validateRules();
+}
+
+void RunPipeline::cancel()
+{
+    if(!isRunning())
+        return;
+
+    qDebug() << "  Run cancelled during stage:" << stageName(_stage);
+
+    stopValidators();
+
+    // Throw the process away rather than waiting for it to be reaped, its
+    // finished() signal must not reach us once the run has been abandoned
+    if(_process != 0)
+    {
+        _process->disconnect(this);
+        _process->killTree();
+        _process->deleteLater();
+        _process = 0;
+    }
+
+    _limitTimer->stop();
+    removeBuildDirectory(false);
+    endStage();
+    _log.close();
+
+    _stage = Stage_Idle;
+    emit stageChanged(_stage, tr("Cancelled"));
+    emit finished(false);
+}
+
+void RunPipeline::processFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    _limitTimer->stop();
+    ResourceUsage usage = recordUsage(_process);
+
+    // Collect anything written since the last readyRead()
+    processOutput();
+
+    bool crashed = (exitStatus == QProcess::CrashExit);
+
+    switch(_stage)
+    {
+    case Stage_ValidateProgram:
+        if(crashed || !outputContains("is valid"))
+        {
+            fail(tr("Validation Failed"),
+                 tr("Could not validate the given configuration. See the log "
+                    "for details."));
+            return;
+        }
+
+        if(_validationCache != 0)
+            _validationCache->setValid(_programFile,
+                                       ValidationCache::ProgramValidation);
+        advance();
+        validateGraph();
+        break;
+
+    case Stage_Compile:
+        if(crashed || !outputContains("Generating program code...")
+                || outputContains("Segmentation"))
+        {
+            fail(tr("Compilation Failed"),
+                 tr("Could not compile the given configuration. See the log "
+                    "for details."));
+            return;
+        }
+
+        advance();
+        build();
+        break;
+
+    case Stage_Build:
+        if(crashed || exitCode != 0)
+        {
+            fail(tr("Run Failed"),
+                 tr("Could not build the compiled program. See the log for "
+                    "details."));
+            return;
+        }
+
+        advance();
+        execute();
+        break;
+
+    case Stage_Execute:
+    {
+        if(crashed || exitCode != 0 || outputContains("Error"))
+        {
+            _exceededLimit = classifyFailure(usage, _process->exitSignal());
+            if(_exceededLimit == Limit_Time)
+            {
+                fail(limitName(_exceededLimit),
+                     tr("The program was stopped after running for %n "
+                        "second(s).", "", _timeLimit));
+                return;
+            }
+            if(_exceededLimit == Limit_Cpu)
+            {
+                fail(limitName(_exceededLimit),
+                     tr("The program was stopped after using %n second(s) "
+                        "of CPU time.", "", _cpuLimit));
+                return;
+            }
+            if(_exceededLimit == Limit_Memory)
+            {
+                fail(limitName(_exceededLimit),
+                     tr("The program failed while limited to %1 MB of "
+                        "memory, most likely because it ran out.")
+                     .arg(_memoryLimit));
+                return;
+            }
+
+            fail(tr("Run Failed"),
+                 tr("There was something wrong with execution. See the log "
+                    "for details."));
+            return;
+        }
+
+        // Warm-up executions are run but not measured
+        usage.wallTime = _executionTimer.elapsed();
+        if(_benchmarkRuns > 0 && _executions >= _warmupRuns)
+            _benchmark.addSample(usage);
+
+        ++_executions;
+        if(_executions < executionCount())
+        {
+            advance();
+            startExecution();
+            return;
+        }
+
+        QString result = QDir(_buildDirectory).filePath("gp2.output");
+        if(QFile::exists(_outputFile))
+            QFile::remove(_outputFile);
+        if(!QFile::copy(result, _outputFile))
+        {
+            fail(tr("Run Failed"),
+                 tr("Could not copy the output graph to %1.").arg(_outputFile));
+            return;
+        }
+
+        advance();
+        qDebug () << "    Run successful.";
+        finish(true);
+        break;
+    }
+
+    default:
+        qDebug() << "RunPipeline::processFinished() outside of a run, ignoring";
+        break;
+    }
+}
+
+void RunPipeline::processError(QProcess::ProcessError error)
+{
+    // Crashes are reported through processFinished(), only failure to start
+    // has to be handled here
+    if(error != QProcess::FailedToStart)
+        return;
+
+    switch(_stage)
+    {
+    case Stage_ValidateProgram:
+        fail(tr("Validation Failed"),
+             tr("Could not start validating the given program."));
+        break;
+    case Stage_Compile:
+        fail(tr("Compilation Failed"),
+             tr("Could not start compiling the given configuration."));
+        break;
+    case Stage_Build:
+    case Stage_Execute:
+        fail(tr("Run Failed"),
+             tr("Could not start running the given configuration."));
+        break;
+    default:
+        break;
+    }
+}
+
+void RunPipeline::setStage(Stage stage)
+{
+    endStage();
+    _stage = stage;
+    _stageTimer.start();
+    appendOutput(QString("--- %1 ---\n").arg(stageName(_stage)).toLocal8Bit());
+    emit stageChanged(_stage, stageName(_stage));
+}
+
+void RunPipeline::endStage()
+{
+    if(!_stageTimer.isValid())
+        return;
+
+    ResourceUsage usage;
+    usage.wallTime = _stageTimer.elapsed();
+    _usage.add(stageName(_stage), usage);
+    _stageTimer.invalidate();
+}
+
+ResourceUsage RunPipeline::recordUsage(RunProcess *process)
+{
+    ResourceUsage usage;
+    if(process->resourceUsage(&usage))
+        _usage.add(stageName(_stage), usage);
+
+    return usage;
+}
+
+RunPipeline::Limit RunPipeline::classifyFailure(const ResourceUsage &usage,
+                                                int signal) const
+{
+    if(_exceededLimit == Limit_Time)
+        return Limit_Time;
+
+#ifdef Q_OS_UNIX
+    // SIGXCPU at the soft limit, SIGKILL at the hard limit if it was ignored
+    qint64 cpuTime = usage.userTime + usage.systemTime;
+    qint64 cpuLimitMs = static_cast<qint64>(_cpuLimit) * 1000;
+    if(_cpuLimit > 0 && (signal == SIGXCPU
+                         || (signal == SIGKILL
+                             && cpuTime >= cpuLimitMs * CpuLimitPercent / 100)))
+        return Limit_Cpu;
+
+    // Running out of address space shows up as a failed allocation. Only
+    // blame the limit when the program reported one or a crash came with
+    // the peak usage close to it; any other crash is just a crash
+    if(_memoryLimit > 0)
+    {
+        if(outputContains("malloc failure"))
+            return Limit_Memory;
+
+        qint64 limitKb = static_cast<qint64>(_memoryLimit) * 1024;
+        bool crashed = signal == SIGSEGV || signal == SIGBUS
+                || signal == SIGABRT;
+        if(crashed && usage.peakMemory >= limitKb * MemoryLimitPercent / 100)
+            return Limit_Memory;
+    }
+#else
+    Q_UNUSED(usage)
+    Q_UNUSED(signal)
+#endif
+
+    return Limit_None;
+}
+
+void RunPipeline::timeLimitReached()
+{
+    if(_stage != Stage_Execute || _process == 0)
+        return;
+
+    qDebug() << "    Time limit of" << _timeLimit << "seconds reached, stopping";
+    _exceededLimit = Limit_Time;
+    _process->killTree();
+}
+
+void RunPipeline::startProcess(const QString &program, const QStringList &args,
+                               const QString &workingDirectory)
+{
+    if(_process == 0)
+    {
+        _process = new RunProcess(this);
+        // http://stackoverflow.com/questions/3852587/how-to-get-stdout-from-a-qprocess
+        _process->setProcessChannelMode(QProcess::MergedChannels);
+        connect(_process, SIGNAL(finished(int,QProcess::ExitStatus)),
+                this, SLOT(processFinished(int,QProcess::ExitStatus)));
+        connect(_process, SIGNAL(error(QProcess::ProcessError)),
+                this, SLOT(processError(QProcess::ProcessError)));
+        connect(_process, SIGNAL(readyRead()), this, SLOT(processOutput()));
+    }
+
+    _scanTail.clear();
+    _markersSeen.clear();
+
+    // Limits only apply to the GP program itself, not to the toolchain
+    if(_stage == Stage_Execute)
+        _process->setLimits(_cpuLimit,
+                            static_cast<qint64>(_memoryLimit) * 1024 * 1024);
+    else
+        _process->setLimits(0, 0);
+
+    _process->setWorkingDirectory(workingDirectory);
+    _process->startCommand(program, args);
+}
+
+void RunPipeline::validatorFinished(int exitCode,
+                                    QProcess::ExitStatus exitStatus)
+{
+    Q_UNUSED(exitCode)
+
+    RunProcess *validator = qobject_cast<RunProcess *>(sender());
+    if(validator == 0 || !_validators.contains(validator))
+        return;
+
+    QByteArray output = validator->readAll();
+    _ruleOutput[_validators.value(validator)] = output;
+    ruleChecked(validator, exitStatus == QProcess::NormalExit
+                           && output.contains("is valid"));
+}
+
+void RunPipeline::validatorError(QProcess::ProcessError error)
+{
+    if(error != QProcess::FailedToStart)
+        return;
+
+    RunProcess *validator = qobject_cast<RunProcess *>(sender());
+    if(validator == 0 || !_validators.contains(validator))
+        return;
+
+    _ruleOutput[_validators.value(validator)] =
+            QString("Could not start %1").arg(_compiler).toLocal8Bit();
+    ruleChecked(validator, false);
+}
+
+void RunPipeline::validateRules()
+{
+    _ruleResults.fill(-1, _rules.count());
+    _ruleOutput.fill(QByteArray(), _rules.count());
+    _ruleErrors.fill(QString(), _rules.count());
+    _pendingRules.clear();
+    _rulesChecked = 0;
+
+    // Rules which have already passed with this compiler need no process, nor
+    // do rules the parser can settle by itself
+    for(int i = 0; i < _rules.count(); ++i)
+    {
+        SyntaxError error;
+        if(_validationCache != 0
+                && _validationCache->isValid(_rules.at(i),
+                                             ValidationCache::RuleValidation))
+        {
+            _ruleResults[i] = 1;
+            _ruleOutput[i] = QString("%1 is unchanged since it last passed "
+                                     "validation.").arg(_rules.at(i)).toLocal8Bit();
+        }
+        else if(!SyntaxCheck::check(_rules.at(i), SyntaxCheck::Target_Rule,
+                                    &error))
+        {
+            _ruleResults[i] = 0;
+            _ruleOutput[i] = error.toString().toLocal8Bit();
+            _ruleErrors[i] = tr("line %1, column %2: %3").arg(error.line)
+                    .arg(error.column).arg(error.message);
+        }
+        else if(!_externalValidation)
+        {
+            _ruleResults[i] = 1;
+            _ruleOutput[i] = QString("%1 passed the syntax check.")
+                    .arg(_rules.at(i)).toLocal8Bit();
+        }
+        else
+        {
+            _pendingRules << i;
+            continue;
+        }
+
+        ++_rulesChecked;
+        advance();
+    }
+
+    if(_pendingRules.isEmpty())
+    {
+        ruleChecked(0, true);
+        return;
+    }
+
+    int count = qMin(_maxParallelValidations, _pendingRules.count());
+    qDebug () << "    Validating" << _pendingRules.count() << "rules with up to"
+              << count << "processes";
+    for(int i = 0; i < count; ++i)
+        startValidator();
+}
+
+void RunPipeline::startValidator()
+{
+    RunProcess *validator = new RunProcess(this);
+    validator->setProcessChannelMode(QProcess::MergedChannels);
+    connect(validator, SIGNAL(finished(int,QProcess::ExitStatus)),
+            this, SLOT(validatorFinished(int,QProcess::ExitStatus)));
+    connect(validator, SIGNAL(error(QProcess::ProcessError)),
+            this, SLOT(validatorError(QProcess::ProcessError)));
+
+    int rule = _pendingRules.takeFirst();
+    _validators.insert(validator, rule);
+    validator->start(_compiler, QStringList() << "-r" << _rules.at(rule));
+}
+
+void RunPipeline::ruleChecked(RunProcess *validator, bool valid)
+{
+    if(validator != 0)
+    {
+        int rule = _validators.take(validator);
+        _ruleResults[rule] = valid ? 1 : 0;
+        if(valid && _validationCache != 0)
+            _validationCache->setValid(_rules.at(rule),
+                                       ValidationCache::RuleValidation);
+        validator->deleteLater();
+        ++_rulesChecked;
+        advance();
+
+        // Keep the pool full until every rule has been handed out
+        if(!_pendingRules.isEmpty())
+            startValidator();
+    }
+
+    if(_rulesChecked < _rules.count())
+        return;
+
+    // Everything is in, report in project order
+    QStringList failures;
+    for(int i = 0; i < _rules.count(); ++i)
+    {
+        QByteArray output = _ruleOutput.at(i);
+        if(!output.endsWith('\n'))
+            output += '\n';
+        appendOutput(output);
+        bool ruleValid = (_ruleResults.at(i) == 1);
+        emit ruleValidated(_rules.at(i), ruleValid);
+        if(!ruleValid)
+        {
+            QString name = QFileInfo(_rules.at(i)).completeBaseName();
+            if(!_ruleErrors.at(i).isEmpty())
+                name += ": " + _ruleErrors.at(i);
+            failures << name;
+        }
+    }
+
+    if(!failures.isEmpty())
+    {
+        fail(tr("Validation Failed"),
+             tr("Could not validate the following rules. See the log for "
+                "details.\n\n%1").arg(failures.join("\n")));
+        return;
+    }
+
+    qDebug () << "  Validation of Rules completed.";
+    validateProgram();
+}
+
+void RunPipeline::validateProgram()
+{
+    setStage(Stage_ValidateProgram);
+    if(_validationCache != 0
+            && _validationCache->isValid(_programFile,
+                                         ValidationCache::ProgramValidation))
+    {
+        qDebug () << "  Program unchanged since it last passed validation.";
+        advance();
+        validateGraph();
+        return;
+    }
+
+    if(!checkSyntax(_programFile, SyntaxCheck::Target_Program))
+        return;
+    if(!_externalValidation)
+    {
+        advance();
+        validateGraph();
+        return;
+    }
+
+    qDebug () << "  Attempting to validate Program:" << _programFile;
+    startProcess(_compiler, QStringList() << "-p" << _programFile);
+}
+
+void RunPipeline::validateGraph()
+{
+    setStage(Stage_ValidateGraph);
+    if(_validationCache != 0
+            && _validationCache->isValid(_graphFile,
+                                         ValidationCache::GraphValidation))
+    {
+        qDebug () << "  Host Graph unchanged since it last passed validation.";
+        advance();
+        compile();
+        return;
+    }
+
+    // gp2compile checks nothing in a host graph beyond its syntax, so the
+    // embedded parser's verdict is final
+    if(!checkSyntax(_graphFile, SyntaxCheck::Target_Graph))
+        return;
+
+    if(_validationCache != 0)
+        _validationCache->setValid(_graphFile,
+                                   ValidationCache::GraphValidation);
+    advance();
+    compile();
+}
+
+bool RunPipeline::checkSyntax(const QString &filePath,
+                              SyntaxCheck::Target target)
+{
+    SyntaxError error;
+    if(SyntaxCheck::check(filePath, target, &error))
+    {
+        appendOutput(QString("%1 passed the syntax check.\n")
+                     .arg(filePath).toLocal8Bit());
+        return true;
+    }
+
+    appendOutput((error.toString() + "\n").toLocal8Bit());
+    fail(tr("Validation Failed"),
+         tr("%1 has a syntax error at line %2, column %3:\n\n%4")
+         .arg(QFileInfo(filePath).fileName()).arg(error.line)
+         .arg(error.column).arg(error.message));
+    return false;
+}
+
+void RunPipeline::compile()
+{
+    setStage(Stage_Compile);
+    qDebug () << "  Attempting to Compile configuration:" << _compiler
+              << _programFile << _graphFile << "into" << _buildDirectory;
+    startProcess(_compiler, QStringList() << "-o" << _buildDirectory
+                                          << _programFile << _graphFile);
+}
+
+void RunPipeline::build()
+{
+    setStage(Stage_Build);
+    qDebug () << "  Attempting to build GP2 Program in" << _buildDirectory;
+    startProcess("make", QStringList(), _buildDirectory);
+}
+
+void RunPipeline::execute()
+{
+    setStage(Stage_Execute);
+    qDebug () << "  Attempting to execute GP2 Program.";
+    startExecution();
+}
+
+void RunPipeline::startExecution()
+{
+    if(executionCount() > 1)
+    {
+        bool warmup = (_executions < _warmupRuns);
+        int number = warmup ? _executions + 1 : _executions - _warmupRuns + 1;
+        appendOutput(QString("--- %1 %2 of %3 ---\n")
+                     .arg(warmup ? tr("Warm-up run") : tr("Measured run"))
+                     .arg(number)
+                     .arg(warmup ? _warmupRuns : _benchmarkRuns)
+                     .toLocal8Bit());
+    }
+
+    _executionTimer.start();
+    startProcess(QDir(_buildDirectory).filePath("gp2run"), QStringList(),
+                 _buildDirectory);
+
+    if(_timeLimit > 0)
+        _limitTimer->start(_timeLimit * 1000);
+}
+
+int RunPipeline::executionCount() const
+{
+    if(_benchmarkRuns == 0)
+        return 1;
+
+    return _warmupRuns + _benchmarkRuns;
+}
+
+void RunPipeline::stopValidators()
+{
+    QList<RunProcess *> validators = _validators.keys();
+    _validators.clear();
+
+    for(int i = 0; i < validators.count(); ++i)
+    {
+        RunProcess *validator = validators.at(i);
+        validator->disconnect(this);
+        validator->killTree();
+        validator->deleteLater();
+    }
+}
+
+QString RunPipeline::prepareBuildDirectory()
+{
+    if(isRunning())
+    {
+        qDebug() << "RunPipeline::prepareBuildDirectory() called during a run, "
+                 << "ignoring";
+        return QString();
+    }
+
+    if(_preparedDirectory.isEmpty())
+        _preparedDirectory = createBuildDirectory();
+
+    return _preparedDirectory;
+}
+
+void RunPipeline::discardBuildDirectory()
+{
+    if(_preparedDirectory.isEmpty())
+        return;
+
+    qDebug () << "  Removing unused build directory" << _preparedDirectory;
+    removePath(_preparedDirectory);
+    _preparedDirectory = QString();
+}
+
+QString RunPipeline::createBuildDirectory() const
+{
+    // Every run gets a fresh directory of its own so that runs, including
+    // those from other instances of the editor, can't interfere
+    QDir root(_buildRoot);
+    if(!root.exists() && !root.mkpath(_buildRoot))
+        return QString();
+
+    QString directory;
+#ifdef Q_OS_UNIX
+    QByteArray pattern = QFile::encodeName(root.filePath("run-XXXXXX"));
+    if(::mkdtemp(pattern.data()) == 0)
+        return QString();
+    directory = QFile::decodeName(pattern);
+#else
+    static int counter = 0;
+    QString name;
+    do
+    {
+        name = QString("run-%1-%2-%3").arg(
+                    QCoreApplication::applicationPid()).arg(
+                    QDateTime::currentMSecsSinceEpoch()).arg(counter++);
+    } while(root.exists(name));
+
+    if(!root.mkdir(name))
+        return QString();
+    directory = root.filePath(name);
+#endif
+
+    qDebug () << "  Building in" << directory;
+    return directory;
+}
+
+void RunPipeline::removeBuildDirectory(bool success)
+{
+    if(_buildDirectory.isEmpty())
+        return;
+
+    bool remove = (_cleanupPolicy == Cleanup_Always)
+            || (_cleanupPolicy == Cleanup_OnSuccess && success);
+
+    if(remove)
+    {
+        qDebug () << "  Removing build directory" << _buildDirectory;
+        removePath(_buildDirectory);
+    }
+    else
+        qDebug () << "  Keeping build directory" << _buildDirectory;
+
+    _buildDirectory = QString();
+}
+
+bool RunPipeline::removePath(const QString &path)
+{
+    QFileInfo info(path);
+    if(info.isDir() && !info.isSymLink())
+    {
+        QDir dir(path);
+        QFileInfoList entries = dir.entryInfoList(QDir::AllEntries
+                                                  | QDir::Hidden
+                                                  | QDir::System
+                                                  | QDir::NoDotAndDotDot);
+        for(int i = 0; i < entries.count(); ++i)
+            removePath(entries.at(i).absoluteFilePath());
+
+        return dir.rmdir(path);
+    }
+
+    return QFile::remove(path);
+}
+
+void RunPipeline::fail(const QString &title, const QString &message)
+{
+    qDebug () << "    Run failed during stage:" << stageName(_stage);
+
+    QString details = message;
+    QString lines = _log.lastLines(10);
+    if(!lines.isEmpty())
+        details += tr("\n\nLast output:\n%1").arg(lines);
+
+    emit failed(title, details);
+    finish(false);
+}
+
+void RunPipeline::processOutput()
+{
+    if(_process == 0)
+        return;
+
+    QByteArray data = _process->readAll();
+    if(data.isEmpty())
+        return;
+
+    // A marker may be split between two reads, so the end of the previous
+    // read is searched along with this one
+    QByteArray window = _scanTail + data;
+    for(int i = 0; i < OutputMarkerCount; ++i)
+    {
+        QByteArray marker(OutputMarkers[i]);
+        if(!_markersSeen.contains(marker) && window.contains(marker))
+            _markersSeen.insert(marker);
+    }
+    _scanTail = window.right(32);
+
+    appendOutput(data);
+}
+
+void RunPipeline::appendOutput(const QByteArray &data)
+{
+    _log.append(data);
+    emit output(_decoder->toUnicode(data));
+}
+
+bool RunPipeline::outputContains(const char *marker) const
+{
+    return _markersSeen.contains(QByteArray(marker));
+}
+
+void RunPipeline::finish(bool success)
+{
+    _limitTimer->stop();
+    removeBuildDirectory(success);
+    endStage();
+    _log.close();
+
+    QStringList stages = _usage.stages();
+    for(int i = 0; i < stages.count(); ++i)
+    {
+        ResourceUsage usage = _usage.stage(stages.at(i));
+        qDebug() << "    " << stages.at(i) << "- wall" << usage.wallTime
+                 << "ms, user" << usage.userTime << "ms, system"
+                 << usage.systemTime << "ms, peak" << usage.peakMemory << "kB";
+    }
+
+    // Kept next to the output graph so it can be shown with the result
+    if(success)
+        _usage.save(RunUsage::usageFile(_outputFile));
+
+    if(success && !_benchmark.isEmpty())
+    {
+        BenchmarkSummary wall = _benchmark.wallTime();
+        qDebug() << "    Benchmark of" << wall.count << "runs - median"
+                 << wall.median << "ms, p95" << wall.p95 << "ms";
+        _benchmark.saveCsv(Benchmark::csvFile(_outputFile));
+        _benchmark.saveJson(Benchmark::jsonFile(_outputFile));
+    }
+    else if(success)
+    {
+        // A plain run must not be shown with the figures of an older benchmark
+        QFile::remove(Benchmark::csvFile(_outputFile));
+        QFile::remove(Benchmark::jsonFile(_outputFile));
+    }
+
+    if(_validationCache != 0)
+        _validationCache->save();
+
+    _stage = Stage_Finished;
+    emit stageChanged(_stage, success ? stageName(_stage) : tr("Failed"));
+    emit finished(success);
+}
+
+void RunPipeline::advance()
+{
+    ++_step;
+    emit progress(_step, _steps);
+}
+
+}
@@ -0,0 +1,384 @@
+/*!
+ * \file
+ */
+#ifndef RUNPIPELINE_HPP
+#define RUNPIPELINE_HPP
+
+#include "runusage.hpp"
+#include "outputlog.hpp"
+#include "syntaxcheck.hpp"
+#include "benchmark.hpp"
+
+#include <QObject>
+#include <QStringList>
+#include <QProcess>
+#include <QVector>
+#include <QMap>
+#include <QElapsedTimer>
+#include <QSet>
+
+class QTextDecoder;
+class QTimer;
+
+namespace Developer {
+
+class RunProcess;
+class ValidationCache;
+
+/*!
+ * \brief Asynchronous state machine which validates, compiles and runs a GP
+ *  program on a host graph
+ *
+ * Each stage of a run is carried out by an external process. Rather than
+ * blocking on each one the pipeline starts a process and returns to the event
+ * loop, moving on to the next stage when the process reports that it has
+ * finished. The stages are, in order:
+ *
+ * \code
+ *  ValidateRules   - gp2compile -r <rule>, once per rule
+ *  ValidateProgram - gp2compile -p <program>
+ *  ValidateGraph   - gp2compile -h <graph>
+ *  Compile         - gp2compile -o <build directory> <program> <graph>
+ *  Build           - make, in the build directory
+ *  Execute         - ./gp2run, in the build directory
+ * \endcode
+ *
+ * Each run is given a new, uniquely named build directory beneath
+ * buildRoot(), so any number of pipelines may compile and execute at the same
+ * time. What happens to the directory afterwards is decided by the
+ * cleanupPolicy().
+ *
+ * If a ValidationCache is set then any file which has already passed
+ * validation with the same compiler is not passed to gp2compile again.
+ *
+ * Every file is first parsed in-process with the editor's copy of the GP2
+ * grammar, see SyntaxCheck. A syntax error fails the stage straight away with
+ * its line and column. For a host graph the parser's verdict is final, the
+ * compiler checks nothing in a graph beyond its syntax, so no process is
+ * started for it. Rules and the program are only handed to gp2compile as well
+ * for the semantic checks the parser can't make:
+ *  - in a rule, variables which are undeclared or used against their type,
+ *    interface nodes missing from either side and conditions on unknown
+ *    variables or nodes;
+ *  - in a program, calls to rules or procedures which are not declared and
+ *    names declared twice.
+ *
+ * Turning externalValidation() off leaves these to the Compile stage, which
+ * runs the full compiler front end anyway. The ValidationCache keeps each
+ * result, so unchanged files are not checked again.
+ *
+ * Rules are independent of each other, so they are validated concurrently
+ * with up to maxParallelValidations() processes at once. Every rule is checked
+ * even if an earlier one fails so that all of the failures can be reported
+ * together.
+ *
+ * The wall clock time of every stage is measured, along with the CPU time and
+ * peak memory of each command the stage ran, see usage() and RunProcess. Rule
+ * validators are only covered by the wall time of their stage, measuring
+ * every one of them is not worth a wrapper process each. The figures of a
+ * successful run are saved next to its output graph.
+ *
+ * With setRepetitions() the program is compiled once and then executed a
+ * number of times. Each measured execution is a sample of benchmark(), which
+ * is saved next to the output graph as CSV and JSON. The output graph is the
+ * one produced by the last execution.
+ *
+ * Output is read as it arrives rather than when each process exits, and is
+ * passed on through output(). Only the most recent part is kept in memory,
+ * the whole of it is written to logFile() if one is set.
+ *
+ * The toolchain stages have no timeout. The execution of the GP program
+ * itself may be limited in wall clock time, CPU time and address space, see
+ * setTimeLimit(), setCpuLimit() and setMemoryLimit(). A run which is stopped
+ * by a limit fails, and exceededLimit() tells which one it was.
+ */
+class RunPipeline : public QObject
+{
+    Q_OBJECT
+
+public:
+    /*!
+     * \brief When to delete a run's build directory once the run is over
+     */
+    enum CleanupPolicy
+    {
+        //! Always delete the build directory
+        Cleanup_Always,
+        //! Delete it after a successful run, keep it for inspection otherwise
+        Cleanup_OnSuccess,
+        //! Never delete build directories
+        Cleanup_Never
+    };
+
+    /*!
+     * \brief The limit, if any, which stopped the program
+     */
+    enum Limit
+    {
+        Limit_None,
+        //! The wall clock time limit
+        Limit_Time,
+        //! The CPU time limit
+        Limit_Cpu,
+        //! The address space limit, inferred from how the program failed
+        Limit_Memory
+    };
+
+    enum Stage
+    {
+        Stage_Idle,
+        Stage_ValidateRules,
+        Stage_ValidateProgram,
+        Stage_ValidateGraph,
+        Stage_Compile,
+        Stage_Build,
+        Stage_Execute,
+        Stage_Finished
+    };
+
+    explicit RunPipeline(QObject *parent = 0);
+    ~RunPipeline();
+
+    QString compiler() const;
+    void setCompiler(const QString &compiler);
+    QStringList rules() const;
+    void setRules(const QStringList &rulePaths);
+    QString buildRoot() const;
+    void setBuildRoot(const QString &path);
+    CleanupPolicy cleanupPolicy() const;
+    void setCleanupPolicy(CleanupPolicy policy);
+
+    /*!
+     * \brief Get the build directory of the current run
+     * \return The directory path, or an empty string if no run is using one
+     */
+    QString buildDirectory() const;
+    static QString defaultBuildRoot();
+
+    /*!
+     * \brief Create the build directory of the next run ahead of start()
+     *
+     * The caller may write the run's inputs into it, they are then cleaned up
+     * with the rest of the build according to cleanupPolicy(). Calling this
+     * again before start() returns the same directory.
+     *
+     * \return The directory path, or an empty string if it could not be
+     *  created
+     */
+    QString prepareBuildDirectory();
+
+    /*!
+     * \brief Remove a directory from prepareBuildDirectory() which start()
+     *  was never given, along with everything in it
+     *
+     * Does nothing if there is no such directory.
+     */
+    void discardBuildDirectory();
+
+    int maxParallelValidations() const;
+    void setMaxParallelValidations(int count);
+    //! True if rules and programs which parse are also checked by gp2compile
+    bool externalValidation() const;
+    void setExternalValidation(bool external);
+
+    //! Wall clock seconds the GP program may run for, 0 for no limit
+    int timeLimit() const;
+    void setTimeLimit(int seconds);
+    //! CPU seconds the GP program may use, 0 for no limit
+    int cpuLimit() const;
+    void setCpuLimit(int seconds);
+    //! Megabytes of address space the GP program may use, 0 for no limit
+    int memoryLimit() const;
+    void setMemoryLimit(int megabytes);
+
+    /*!
+     * \brief Get the limit which stopped the most recent run
+     * \return The limit, or Limit_None if the run was not stopped by one
+     */
+    Limit exceededLimit() const;
+    static QString limitName(Limit limit);
+
+    /*!
+     * \brief Get the file the output of every stage is written to
+     * \return The path, or an empty string if output is not saved
+     */
+    QString logFile() const;
+    void setLogFile(const QString &path);
+
+    /*!
+     * \brief Get the end of the output of the current or most recent run
+     * \param lines Maximum number of lines to return
+     */
+    QString recentOutput(int lines) const;
+
+    ValidationCache *validationCache() const;
+    void setValidationCache(ValidationCache *cache);
+
+    Stage stage() const;
+    bool isRunning() const;
+
+    /*!
+     * \brief Get the resources used by each stage of the current or most
+     *  recent run
+     */
+    RunUsage usage() const;
+
+    /*!
+     * \brief Execute the program several times once it has been built
+     * \param runs     Number of measured executions, 0 for a single
+     *  unmeasured run
+     * \param warmups  Executions before the measured ones, whose figures are
+     *  discarded
+     */
+    void setRepetitions(int runs, int warmups = 0);
+    int benchmarkRuns() const;
+    int warmupRuns() const;
+
+    /*!
+     * \brief Get the measured executions of the current or most recent run
+     */
+    Benchmark benchmark() const;
+
+    /*!
+     * \brief Get a human readable description of a stage
+     * \param stage The stage to describe
+     * \return A short string suitable for a status label
+     */
+    static QString stageName(Stage stage);
+
+public slots:
+    /*!
+     * \brief Begin a new run
+     *
+     * Returns immediately, the result is reported through finished().
+     *
+     * \param programFile   The program text with all rules appended
+     * \param graphFile     The host graph
+     * \param outputFile    Where the output graph should be copied to
+     */
+    void start(const QString &programFile, const QString &graphFile,
+               const QString &outputFile);
+
+    /*!
+     * \brief Abandon the current run, killing any process still running
+     */
+    void cancel();
+
+signals:
+    void stageChanged(int stage, QString description);
+    void progress(int value, int maximum);
+    void ruleValidated(QString rulePath, bool valid);
+
+    /*!
+     * \brief Emitted whenever a stage produces more output
+     * \param text The new output, not necessarily a whole number of lines
+     */
+    void output(QString text);
+
+    /*!
+     * \brief Emitted when a stage fails
+     * \param title     Short description of the failure
+     * \param message   Explanation suitable for showing to the user
+     */
+    void failed(QString title, QString message);
+
+    /*!
+     * \brief Emitted once the pipeline has stopped, for whatever reason
+     * \param success   True if the output graph was produced
+     */
+    void finished(bool success);
+
+private slots:
+    void processFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void processError(QProcess::ProcessError error);
+    void processOutput();
+    void timeLimitReached();
+    void validatorFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void validatorError(QProcess::ProcessError error);
+
+private:
+    void setStage(Stage stage);
+    void endStage();
+    ResourceUsage recordUsage(RunProcess *process);
+    Limit classifyFailure(const ResourceUsage &usage, int signal) const;
+    void appendOutput(const QByteArray &data);
+    bool outputContains(const char *marker) const;
+    void startProcess(const QString &program, const QStringList &args,
+                      const QString &workingDirectory = QString());
+    void validateRules();
+    void startValidator();
+    void ruleChecked(RunProcess *validator, bool valid);
+    void stopValidators();
+    void validateProgram();
+    void validateGraph();
+    /*!
+     * \brief Parse a file in-process, failing the run if it is rejected
+     * \return True if the file parsed
+     */
+    bool checkSyntax(const QString &filePath, SyntaxCheck::Target target);
+    void compile();
+    void startExecution();
+    int executionCount() const;
+    void build();
+    void execute();
+    QString createBuildDirectory() const;
+    void removeBuildDirectory(bool success);
+    static bool removePath(const QString &path);
+    void fail(const QString &title, const QString &message);
+    void finish(bool success);
+    void advance();
+
+    RunProcess *_process;
+    Stage _stage;
+    QString _compiler;
+    QString _buildRoot;
+    CleanupPolicy _cleanupPolicy;
+    QString _buildDirectory;
+    QString _preparedDirectory;
+    QStringList _rules;
+    int _maxParallelValidations;
+    ValidationCache *_validationCache;
+
+    // Rule validation state, results are held by rule index so they can be
+    // reported in project order whichever process finishes first
+    QMap<RunProcess *, int> _validators;
+    QVector<int> _ruleResults;
+    QVector<QByteArray> _ruleOutput;
+    // Location of each rule's syntax error, empty if it has none
+    QVector<QString> _ruleErrors;
+    bool _externalValidation;
+    QList<int> _pendingRules;
+    int _rulesChecked;
+
+    QString _programFile;
+    QString _graphFile;
+    QString _outputFile;
+
+    int _step;
+    int _steps;
+
+    RunUsage _usage;
+    QElapsedTimer _stageTimer;
+
+    OutputLog _log;
+    QString _logFile;
+    QTextDecoder *_decoder;
+    QByteArray _scanTail;
+    QSet<QByteArray> _markersSeen;
+
+    int _timeLimit;
+    int _cpuLimit;
+    int _memoryLimit;
+    Limit _exceededLimit;
+    QTimer *_limitTimer;
+
+    int _benchmarkRuns;
+    int _warmupRuns;
+    int _executions;
+    QElapsedTimer _executionTimer;
+    Benchmark _benchmark;
+};
+
+}
+
+#endif // RUNPIPELINE_HPP
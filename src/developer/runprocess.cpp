@@ -0,0 +1,267 @@
+/*!
+ * \file
+ */
+#include "runprocess.hpp"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QDebug>
+
+#ifdef Q_OS_UNIX
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <unistd.h>
+#endif
+
+namespace Developer {
+
+const char *RunProcess::WrapperOption = "--run-command";
+
+#ifdef Q_OS_UNIX
+/*!
+ * \brief What the wrapper writes to the usage file
+ */
+struct UsageRecord
+{
+    int status;
+    struct rusage usage;
+};
+
+static qint64 toMilliseconds(const struct timeval &time)
+{
+    return static_cast<qint64>(time.tv_sec) * 1000 + time.tv_usec / 1000;
+}
+
+static void applyLimits(qint64 cpuSeconds, qint64 memoryBytes)
+{
+    if(cpuSeconds > 0)
+    {
+        // The soft limit raises SIGXCPU, the hard limit a second later kills
+        // a command which ignores it
+        struct rlimit cpu;
+        cpu.rlim_cur = static_cast<rlim_t>(cpuSeconds);
+        cpu.rlim_max = static_cast<rlim_t>(cpuSeconds + 1);
+        ::setrlimit(RLIMIT_CPU, &cpu);
+    }
+
+    if(memoryBytes > 0)
+    {
+        struct rlimit memory;
+        memory.rlim_cur = static_cast<rlim_t>(memoryBytes);
+        memory.rlim_max = static_cast<rlim_t>(memoryBytes);
+        ::setrlimit(RLIMIT_AS, &memory);
+    }
+}
+
+// The wrapper's command, for its SIGTERM handler
+static volatile sig_atomic_t wrappedCommand = 0;
+
+static void killWrappedCommand(int)
+{
+    if(wrappedCommand > 0)
+        ::kill(-wrappedCommand, SIGKILL);
+}
+#endif
+
+RunProcess::RunProcess(QObject *parent)
+    : QProcess(parent)
+    , _wrapped(false)
+    , _exitSignal(0)
+    , _cpuLimit(0)
+    , _memoryLimit(0)
+{
+}
+
+void RunProcess::startCommand(const QString &program,
+                              const QStringList &arguments)
+{
+    _wrapped = false;
+
+#ifdef Q_OS_UNIX
+    QString executable = program;
+    if(program.contains('/'))
+        executable = QDir(workingDirectory()).absoluteFilePath(program);
+    else
+        executable = QStandardPaths::findExecutable(program);
+
+    if(_usageFile.fileName().isEmpty())
+    {
+        _usageFile.setFileTemplate(QDir::temp().filePath("gp2usage-XXXXXX"));
+        if(_usageFile.open())
+            _usageFile.close();
+    }
+
+    if(!executable.isEmpty() && QFileInfo(executable).isExecutable()
+            && !_usageFile.fileName().isEmpty())
+    {
+        QStringList wrapperArguments;
+        wrapperArguments << WrapperOption << _usageFile.fileName()
+                         << QString::number(_cpuLimit)
+                         << QString::number(_memoryLimit)
+                         << program << arguments;
+        _wrapped = true;
+        start(QCoreApplication::applicationFilePath(), wrapperArguments);
+        return;
+    }
+#endif
+
+    start(program, arguments);
+}
+
+void RunProcess::killTree()
+{
+    if(state() == QProcess::NotRunning)
+        return;
+
+#ifdef Q_OS_UNIX
+    if(_wrapped)
+    {
+        // The wrapper kills the command's group and stays alive to write the
+        // usage record
+        qDebug() << "    Stopping process tree of" << processId();
+        ::kill(processId(), SIGTERM);
+        return;
+    }
+#endif
+
+    kill();
+}
+
+bool RunProcess::resourceUsage(ResourceUsage *usage)
+{
+#ifdef Q_OS_UNIX
+    _exitSignal = 0;
+    if(!_wrapped || usage == 0)
+        return false;
+
+    QFile file(_usageFile.fileName());
+    if(!file.open(QFile::ReadOnly))
+        return false;
+
+    UsageRecord record;
+    bool complete = (file.read(reinterpret_cast<char *>(&record),
+                               sizeof(record)) == sizeof(record));
+    file.close();
+
+    // Empty the file so a later command can't report stale figures
+    file.open(QFile::WriteOnly | QFile::Truncate);
+    file.close();
+
+    if(!complete)
+        return false;
+
+    _exitSignal = WIFSIGNALED(record.status) ? WTERMSIG(record.status) : 0;
+
+    usage->wallTime = 0;
+    usage->userTime = toMilliseconds(record.usage.ru_utime);
+    usage->systemTime = toMilliseconds(record.usage.ru_stime);
+#ifdef Q_OS_MAC
+    // Reported in bytes rather than kilobytes
+    usage->peakMemory = record.usage.ru_maxrss / 1024;
+#else
+    usage->peakMemory = record.usage.ru_maxrss;
+#endif
+    usage->processes = 1;
+    return true;
+#else
+    Q_UNUSED(usage)
+    return false;
+#endif
+}
+
+int RunProcess::exitSignal() const
+{
+    return _exitSignal;
+}
+
+void RunProcess::setLimits(qint64 cpuSeconds, qint64 memoryBytes)
+{
+    _cpuLimit = cpuSeconds;
+    _memoryLimit = memoryBytes;
+}
+
+int RunProcess::wrapperMain(int argc, char *argv[])
+{
+#ifdef Q_OS_UNIX
+    if(argc < 6)
+        return 127;
+
+    const char *usagePath = argv[2];
+    qint64 cpuSeconds = ::strtoll(argv[3], 0, 10);
+    qint64 memoryBytes = ::strtoll(argv[4], 0, 10);
+
+    // A kill from killTree() is held back until it can be passed on
+    sigset_t terminate;
+    sigset_t previousMask;
+    ::sigemptyset(&terminate);
+    ::sigaddset(&terminate, SIGTERM);
+    ::sigprocmask(SIG_BLOCK, &terminate, &previousMask);
+
+    pid_t command = ::fork();
+    if(command < 0)
+        return 127;
+
+    if(command == 0)
+    {
+        ::setpgid(0, 0);
+        ::sigprocmask(SIG_SETMASK, &previousMask, 0);
+        applyLimits(cpuSeconds, memoryBytes);
+        ::execvp(argv[5], argv + 5);
+        ::_exit(127);
+    }
+
+    // Also set here, so the group exists before a kill can be passed on
+    ::setpgid(command, command);
+    wrappedCommand = command;
+
+    struct sigaction relay;
+    ::sigemptyset(&relay.sa_mask);
+    relay.sa_flags = 0;
+    relay.sa_handler = killWrappedCommand;
+    ::sigaction(SIGTERM, &relay, 0);
+    ::sigprocmask(SIG_SETMASK, &previousMask, 0);
+
+    UsageRecord record;
+    pid_t result;
+    do
+    {
+        result = ::wait4(command, &record.status, 0, &record.usage);
+    } while(result < 0 && errno == EINTR);
+
+    if(result < 0)
+        return 127;
+
+    int fd = ::open(usagePath, O_WRONLY | O_TRUNC);
+    if(fd >= 0)
+    {
+        ::write(fd, &record, sizeof(record));
+        ::close(fd);
+    }
+
+    // Pass the command's fate on to QProcess
+    if(WIFSIGNALED(record.status))
+    {
+        struct rlimit noCore = { 0, 0 };
+        ::setrlimit(RLIMIT_CORE, &noCore);
+        ::signal(WTERMSIG(record.status), SIG_DFL);
+        ::kill(::getpid(), WTERMSIG(record.status));
+    }
+
+    return WIFEXITED(record.status) ? WEXITSTATUS(record.status) : 127;
+#else
+    Q_UNUSED(argc)
+    Q_UNUSED(argv)
+    return 127;
+#endif
+}
+
+}
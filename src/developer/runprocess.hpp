@@ -0,0 +1,114 @@
+/*!
+ * \file
+ */
+#ifndef RUNPROCESS_HPP
+#define RUNPROCESS_HPP
+
+#include "runusage.hpp"
+
+#include <QProcess>
+#include <QTemporaryFile>
+
+namespace Developer {
+
+/*!
+ * \brief QProcess which can run a command in a separate process group and
+ *  measure the resources it uses
+ *
+ * The run pipeline launches commands which spawn children of their own (make
+ * runs the C compiler, the shell runs gp2run and so on). Killing only the
+ * direct child would leave those running, and QProcess reaps its child
+ * itself, which leaves no opportunity to collect its resource usage.
+ *
+ * On Unix startCommand() therefore runs the command through a wrapper, which
+ * is the editor's own executable started with WrapperOption, see
+ * wrapperMain(). The wrapper starts the command at the head of a new process
+ * group, waits for it with wait4(), writes the resulting rusage to a
+ * temporary file and exits with the command's status. The figures cover the
+ * command and every descendant it waited for. killTree() asks the wrapper to
+ * kill the command's group, so a killed command is measured too.
+ *
+ * Limits on CPU time and address space may be set with setLimits(), the
+ * wrapper applies them with setrlimit() to the command only.
+ *
+ * Commands started with the plain QProcess::start() are neither measured nor
+ * limited, and killTree() only kills the direct child.
+ */
+class RunProcess : public QProcess
+{
+    Q_OBJECT
+
+public:
+    //! First argument which makes the editor run as the wrapper
+    static const char *WrapperOption;
+
+    explicit RunProcess(QObject *parent = 0);
+
+    /*!
+     * \brief Start a command through the wrapper
+     *
+     * A program which cannot be found is started directly, so that QProcess
+     * reports the failure to start as usual. Elsewhere than on Unix this is
+     * the same as start().
+     */
+    void startCommand(const QString &program, const QStringList &arguments);
+
+    /*!
+     * \brief Kill the child process along with everything it has spawned
+     *
+     * Does nothing if the process is not running.
+     */
+    void killTree();
+
+    /*!
+     * \brief Get the resources used by the most recently finished command
+     *
+     * The wall time is not measured here, it is left at zero.
+     *
+     * \param usage Filled in with the user and system time and peak memory
+     * \return True if the command was started with startCommand() and a
+     *  measurement was available
+     */
+    bool resourceUsage(ResourceUsage *usage);
+
+    /*!
+     * \brief Get the signal which terminated the most recently finished
+     *  command
+     *
+     * Only valid after resourceUsage() has returned true.
+     *
+     * \return The signal number, or 0 if the command exited normally
+     */
+    int exitSignal() const;
+
+    /*!
+     * \brief Limit the resources of commands started from now on
+     * \param cpuSeconds    CPU time allowed, 0 for no limit. The command is
+     *  sent SIGXCPU when it runs out.
+     * \param memoryBytes   Address space allowed, 0 for no limit. Allocations
+     *  beyond it fail.
+     */
+    void setLimits(qint64 cpuSeconds, qint64 memoryBytes);
+
+    /*!
+     * \brief Run as the wrapper, called from main() before anything else
+     *
+     * The arguments are WrapperOption, the usage file, the CPU and memory
+     * limits and then the command line to run.
+     *
+     * \return The command's exit status. If the command was killed by a
+     *  signal then the wrapper kills itself with the same one instead.
+     */
+    static int wrapperMain(int argc, char *argv[]);
+
+private:
+    QTemporaryFile _usageFile;
+    bool _wrapped;
+    int _exitSignal;
+    qint64 _cpuLimit;
+    qint64 _memoryLimit;
+};
+
+}
+
+#endif // RUNPROCESS_HPP
@@ -0,0 +1,350 @@
+/*!
+ * \file
+ */
+#include "runqueue.hpp"
+#include "runconfiguration.hpp"
+
+#include <QSettings>
+#include <QDebug>
+
+namespace Developer {
+
+RunQueue::RunQueue(QObject *parent)
+    : QObject(parent)
+    , _nextId(1)
+    , _maxWorkers(1)
+    , _dispatching(false)
+{
+    QSettings settings;
+    setMaxWorkers(settings.value("Run/QueueWorkers", 1).toInt());
+}
+
+RunQueue::~RunQueue()
+{
+}
+
+int RunQueue::maxWorkers() const
+{
+    return _maxWorkers;
+}
+
+void RunQueue::setMaxWorkers(int count)
+{
+    _maxWorkers = (count < 1) ? 1 : count;
+    dispatch();
+}
+
+int RunQueue::runningCount() const
+{
+    int count = 0;
+    for(int i = 0; i < _entries.count(); ++i)
+    {
+        if(_entries.at(i).status == Status_Running)
+            ++count;
+    }
+
+    return count;
+}
+
+int RunQueue::queuedCount() const
+{
+    int count = 0;
+    for(int i = 0; i < _entries.count(); ++i)
+    {
+        if(_entries.at(i).status == Status_Queued)
+            ++count;
+    }
+
+    return count;
+}
+
+QList<RunQueue::Entry> RunQueue::entries() const
+{
+    return _entries;
+}
+
+QString RunQueue::kindName(Kind kind)
+{
+    switch(kind)
+    {
+    case Kind_Batch:
+        return tr("Batch");
+    default:
+        return tr("Run");
+    }
+}
+
+QString RunQueue::priorityName(Priority priority)
+{
+    switch(priority)
+    {
+    case Priority_Low:
+        return tr("Low");
+    case Priority_High:
+        return tr("High");
+    default:
+        return tr("Normal");
+    }
+}
+
+QString RunQueue::statusName(Status status)
+{
+    switch(status)
+    {
+    case Status_Queued:
+        return tr("Queued");
+    case Status_Running:
+        return tr("Running");
+    case Status_Done:
+        return tr("Done");
+    case Status_Failed:
+        return tr("Failed");
+    case Status_Cancelled:
+        return tr("Cancelled");
+    default:
+        return QString();
+    }
+}
+
+int RunQueue::enqueue(RunConfiguration *configuration, int kind, int priority)
+{
+    if(configuration == 0)
+    {
+        qDebug() << "RunQueue::enqueue() handed a null pointer, ignoring";
+        return 0;
+    }
+
+    connect(configuration, SIGNAL(runFinished()),
+            this, SLOT(configurationFinished()), Qt::UniqueConnection);
+    connect(configuration, SIGNAL(destroyed(QObject*)),
+            this, SLOT(configurationDestroyed(QObject*)), Qt::UniqueConnection);
+
+    Entry entry;
+    entry.id = _nextId++;
+    entry.configuration = configuration;
+    entry.name = configuration->name();
+    entry.kind = static_cast<Kind>(kind);
+    entry.priority = static_cast<Priority>(priority);
+    entry.status = Status_Queued;
+    _entries << entry;
+
+    qDebug() << "Queued" << kindName(entry.kind) << "of" << entry.name
+             << "with" << runningCount() << "of" << _maxWorkers
+             << "workers busy";
+    emit changed();
+
+    dispatch();
+    return entry.id;
+}
+
+void RunQueue::cancel(int id)
+{
+    int index = indexOf(id);
+    if(index < 0)
+        return;
+
+    Entry &entry = _entries[index];
+    Status previous = entry.status;
+    if(previous != Status_Queued && previous != Status_Running)
+        return;
+
+    entry.status = Status_Cancelled;
+    emit changed();
+
+    if(previous == Status_Running && entry.configuration != 0)
+        entry.configuration->cancelRun();
+
+    dispatch();
+}
+
+void RunQueue::moveUp(int id)
+{
+    int index = indexOf(id);
+    if(index < 0 || _entries.at(index).status != Status_Queued)
+        return;
+
+    // Only the order among waiting requests matters
+    for(int i = index - 1; i >= 0; --i)
+    {
+        if(_entries.at(i).status == Status_Queued)
+        {
+            _entries.swap(i, index);
+            emit changed();
+            return;
+        }
+    }
+}
+
+void RunQueue::moveDown(int id)
+{
+    int index = indexOf(id);
+    if(index < 0 || _entries.at(index).status != Status_Queued)
+        return;
+
+    for(int i = index + 1; i < _entries.count(); ++i)
+    {
+        if(_entries.at(i).status == Status_Queued)
+        {
+            _entries.swap(i, index);
+            emit changed();
+            return;
+        }
+    }
+}
+
+void RunQueue::setPriority(int id, int priority)
+{
+    int index = indexOf(id);
+    if(index < 0)
+        return;
+
+    _entries[index].priority = static_cast<Priority>(priority);
+    emit changed();
+}
+
+void RunQueue::clearFinished()
+{
+    for(int i = _entries.count() - 1; i >= 0; --i)
+    {
+        Status status = _entries.at(i).status;
+        if(status == Status_Done || status == Status_Failed
+                || status == Status_Cancelled)
+            _entries.removeAt(i);
+    }
+
+    emit changed();
+}
+
+void RunQueue::configurationFinished()
+{
+    RunConfiguration *configuration =
+            qobject_cast<RunConfiguration *>(sender());
+    if(configuration == 0)
+        return;
+
+    for(int i = 0; i < _entries.count(); ++i)
+    {
+        const Entry &entry = _entries.at(i);
+        if(entry.configuration == configuration
+                && entry.status == Status_Running)
+        {
+            finish(i);
+            break;
+        }
+    }
+
+    // Also reached when a cancelled request stops
+    configuration->setUnattended(false);
+    dispatch();
+}
+
+void RunQueue::configurationDestroyed(QObject *object)
+{
+    // The widget is being torn down, nothing about it may be called any more
+    for(int i = 0; i < _entries.count(); ++i)
+    {
+        Entry &entry = _entries[i];
+        if(static_cast<QObject *>(entry.configuration) != object)
+            continue;
+
+        entry.configuration = 0;
+        if(entry.status == Status_Queued || entry.status == Status_Running)
+            entry.status = Status_Cancelled;
+    }
+
+    emit changed();
+    dispatch();
+}
+
+int RunQueue::indexOf(int id) const
+{
+    for(int i = 0; i < _entries.count(); ++i)
+    {
+        if(_entries.at(i).id == id)
+            return i;
+    }
+
+    return -1;
+}
+
+bool RunQueue::isBusy(RunConfiguration *configuration) const
+{
+    if(configuration == 0)
+        return true;
+
+    for(int i = 0; i < _entries.count(); ++i)
+    {
+        const Entry &entry = _entries.at(i);
+        if(entry.configuration == configuration
+                && entry.status == Status_Running)
+            return true;
+    }
+
+    return configuration->isRunning();
+}
+
+void RunQueue::dispatch()
+{
+    // A run may end inside start(), the loop below picks up the free worker
+    if(_dispatching)
+        return;
+    _dispatching = true;
+
+    while(runningCount() < _maxWorkers)
+    {
+        int next = -1;
+        for(int i = 0; i < _entries.count(); ++i)
+        {
+            const Entry &entry = _entries.at(i);
+            if(entry.status != Status_Queued || isBusy(entry.configuration))
+                continue;
+            if(next < 0 || entry.priority > _entries.at(next).priority)
+                next = i;
+        }
+
+        if(next < 0)
+            break;
+
+        start(next);
+    }
+
+    _dispatching = false;
+}
+
+void RunQueue::start(int index)
+{
+    Entry &entry = _entries[index];
+    entry.status = Status_Running;
+    int id = entry.id;
+    RunConfiguration *configuration = entry.configuration;
+    Kind kind = entry.kind;
+    emit changed();
+
+    qDebug() << "Starting queued" << kindName(kind) << "of" << entry.name;
+    configuration->setUnattended(true);
+    bool started = (kind == Kind_Batch) ? configuration->runBatch()
+                                        : configuration->runConfiguration();
+
+    // Nothing was left running, for instance an earlier result was reused or
+    // a file could not be saved
+    index = indexOf(id);
+    if(!started && index >= 0 && _entries.at(index).status == Status_Running)
+        finish(index);
+    if(!started)
+        configuration->setUnattended(false);
+}
+
+void RunQueue::finish(int index)
+{
+    Entry &entry = _entries[index];
+    entry.error = (entry.configuration != 0) ? entry.configuration->lastError()
+                                             : QString();
+    entry.status = entry.error.isEmpty() ? Status_Done : Status_Failed;
+
+    if(entry.status == Status_Failed)
+        qDebug() << "Queued" << kindName(entry.kind) << "of" << entry.name
+                 << "failed:" << entry.error;
+    emit changed();
+}
+
+}
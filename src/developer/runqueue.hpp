@@ -0,0 +1,148 @@
+/*!
+ * \file
+ */
+#ifndef RUNQUEUE_HPP
+#define RUNQUEUE_HPP
+
+#include <QObject>
+#include <QList>
+#include <QString>
+
+namespace Developer {
+
+class RunConfiguration;
+
+/*!
+ * \brief Project-wide queue of run requests, executed by a pool of workers
+ *
+ * Requests come from the Run tab, the quick run widget and batch runs. Each
+ * names a run configuration and whether it should be run once or as a batch.
+ * Up to maxWorkers() requests are running at any time. When a worker becomes
+ * free the queued request with the highest priority is started, requests of
+ * equal priority are taken in queue order.
+ *
+ * A run configuration can only run one thing at a time, so a request waits
+ * while an earlier request for the same configuration is running.
+ *
+ * Requests are run unattended, see RunConfiguration::setUnattended(), so an
+ * error ends the request as Status_Failed rather than waiting on a dialog.
+ *
+ * The number of workers is read from the Run/QueueWorkers setting.
+ */
+class RunQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Kind
+    {
+        Kind_Single,
+        Kind_Batch
+    };
+
+    enum Priority
+    {
+        Priority_Low,
+        Priority_Normal,
+        Priority_High
+    };
+
+    enum Status
+    {
+        Status_Queued,
+        Status_Running,
+        //! The run has ended, whether or not it produced a result
+        Status_Done,
+        //! The run could not be started or stopped with an error
+        Status_Failed,
+        Status_Cancelled
+    };
+
+    /*!
+     * \brief A single request in the queue
+     */
+    struct Entry
+    {
+        int id;
+        RunConfiguration *configuration;
+        //! Name of the configuration when it was queued
+        QString name;
+        Kind kind;
+        Priority priority;
+        Status status;
+        //! Why the request failed, for Status_Failed
+        QString error;
+    };
+
+    explicit RunQueue(QObject *parent = 0);
+    ~RunQueue();
+
+    int maxWorkers() const;
+    void setMaxWorkers(int count);
+    int runningCount() const;
+    int queuedCount() const;
+
+    /*!
+     * \brief Get every request, in queue order, including those which have
+     *  finished and not been cleared
+     */
+    QList<Entry> entries() const;
+
+    static QString kindName(Kind kind);
+    static QString priorityName(Priority priority);
+    static QString statusName(Status status);
+
+public slots:
+    /*!
+     * \brief Add a request to the end of the queue
+     * \param configuration The run configuration to run
+     * \param kind          One of Kind
+     * \param priority      One of Priority
+     * \return The identifier of the new request
+     */
+    int enqueue(RunConfiguration *configuration, int kind,
+                int priority = Priority_Normal);
+
+    /*!
+     * \brief Cancel a request, stopping it if it is running
+     */
+    void cancel(int id);
+    void moveUp(int id);
+    void moveDown(int id);
+    void setPriority(int id, int priority);
+
+    /*!
+     * \brief Remove the requests which are done, failed or cancelled
+     */
+    void clearFinished();
+
+signals:
+    //! Emitted whenever a request is added, removed, moved or changes status
+    void changed();
+
+private slots:
+    void configurationFinished();
+    void configurationDestroyed(QObject *object);
+
+private:
+    int indexOf(int id) const;
+    bool isBusy(RunConfiguration *configuration) const;
+
+    /*!
+     * \brief Start queued requests until every worker is busy or nothing
+     *  more can start
+     */
+    void dispatch();
+    void start(int index);
+    //! Mark a running request as ended, failed if its configuration had an error
+    void finish(int index);
+
+    QList<Entry> _entries;
+    int _nextId;
+    int _maxWorkers;
+    bool _dispatching;
+};
+
+}
+
+#endif // RUNQUEUE_HPP
@@ -0,0 +1,175 @@
+/*!
+ * \file
+ */
+#include "runqueueview.hpp"
+#include "ui_runqueueview.h"
+
+#include "runqueue.hpp"
+
+#include <QSettings>
+
+namespace Developer {
+
+RunQueueView::RunQueueView(QWidget *parent)
+    : QWidget(parent)
+    , _ui(new Ui::RunQueueView)
+    , _queue(0)
+{
+    _ui->setupUi(this);
+
+    connect(_ui->moveUpButton, SIGNAL(clicked()), this, SLOT(moveUp()));
+    connect(_ui->moveDownButton, SIGNAL(clicked()), this, SLOT(moveDown()));
+    connect(_ui->cancelButton, SIGNAL(clicked()), this, SLOT(cancelSelected()));
+    connect(_ui->clearButton, SIGNAL(clicked()), this, SLOT(clearFinished()));
+    connect(_ui->priorityCombo, SIGNAL(activated(int)),
+            this, SLOT(priorityChanged(int)));
+    connect(_ui->workersSpin, SIGNAL(valueChanged(int)),
+            this, SLOT(workersChanged(int)));
+    connect(_ui->queueTree, SIGNAL(itemSelectionChanged()),
+            this, SLOT(updateButtons()));
+
+    updateButtons();
+}
+
+RunQueueView::~RunQueueView()
+{
+    delete _ui;
+}
+
+void RunQueueView::setQueue(RunQueue *queue)
+{
+    if(_queue != 0)
+        _queue->disconnect(this);
+
+    _queue = queue;
+    if(_queue != 0)
+    {
+        connect(_queue, SIGNAL(changed()), this, SLOT(refresh()));
+        _ui->workersSpin->blockSignals(true);
+        _ui->workersSpin->setValue(_queue->maxWorkers());
+        _ui->workersSpin->blockSignals(false);
+    }
+
+    refresh();
+}
+
+void RunQueueView::refresh()
+{
+    int selected = selectedId();
+    _ui->queueTree->clear();
+
+    if(_queue == 0)
+    {
+        setVisible(false);
+        return;
+    }
+
+    QList<RunQueue::Entry> entries = _queue->entries();
+    for(int i = 0; i < entries.count(); ++i)
+    {
+        const RunQueue::Entry &entry = entries.at(i);
+
+        QStringList columns;
+        columns << entry.name
+                << RunQueue::kindName(entry.kind)
+                << RunQueue::priorityName(entry.priority)
+                << RunQueue::statusName(entry.status);
+        QTreeWidgetItem *item = new QTreeWidgetItem(columns);
+        item->setData(0, Qt::UserRole, entry.id);
+        if(entry.status == RunQueue::Status_Done
+                || entry.status == RunQueue::Status_Cancelled)
+        {
+            for(int column = 0; column < columns.count(); ++column)
+                item->setForeground(column, QBrush(Qt::gray));
+        }
+        else if(entry.status == RunQueue::Status_Failed)
+        {
+            item->setForeground(3, QBrush(Qt::red));
+            for(int column = 0; column < columns.count(); ++column)
+                item->setToolTip(column, entry.error);
+        }
+
+        _ui->queueTree->addTopLevelItem(item);
+        if(entry.id == selected)
+            item->setSelected(true);
+    }
+
+    // Only worth the space once something has been queued
+    setVisible(!entries.isEmpty());
+    updateButtons();
+}
+
+void RunQueueView::moveUp()
+{
+    if(_queue != 0)
+        _queue->moveUp(selectedId());
+}
+
+void RunQueueView::moveDown()
+{
+    if(_queue != 0)
+        _queue->moveDown(selectedId());
+}
+
+void RunQueueView::cancelSelected()
+{
+    if(_queue != 0)
+        _queue->cancel(selectedId());
+}
+
+void RunQueueView::clearFinished()
+{
+    if(_queue != 0)
+        _queue->clearFinished();
+}
+
+void RunQueueView::priorityChanged(int priority)
+{
+    if(_queue != 0)
+        _queue->setPriority(selectedId(), priority);
+}
+
+void RunQueueView::workersChanged(int count)
+{
+    QSettings settings;
+    settings.setValue("Run/QueueWorkers", count);
+
+    if(_queue != 0)
+        _queue->setMaxWorkers(count);
+}
+
+void RunQueueView::updateButtons()
+{
+    int id = selectedId();
+    RunQueue::Entry entry;
+    entry.status = RunQueue::Status_Done;
+    entry.priority = RunQueue::Priority_Normal;
+    if(_queue != 0 && id != 0)
+    {
+        QList<RunQueue::Entry> entries = _queue->entries();
+        for(int i = 0; i < entries.count(); ++i)
+        {
+            if(entries.at(i).id == id)
+                entry = entries.at(i);
+        }
+    }
+
+    bool queued = (entry.status == RunQueue::Status_Queued);
+    bool active = queued || (entry.status == RunQueue::Status_Running);
+    _ui->moveUpButton->setEnabled(queued);
+    _ui->moveDownButton->setEnabled(queued);
+    _ui->priorityCombo->setEnabled(queued);
+    _ui->priorityCombo->setCurrentIndex(entry.priority);
+    _ui->cancelButton->setEnabled(active);
+}
+
+int RunQueueView::selectedId() const
+{
+    QList<QTreeWidgetItem *> items = _ui->queueTree->selectedItems();
+    if(items.isEmpty())
+        return 0;
+
+    return items.first()->data(0, Qt::UserRole).toInt();
+}
+
+}
@@ -0,0 +1,56 @@
+/*!
+ * \file
+ */
+#ifndef RUNQUEUEVIEW_HPP
+#define RUNQUEUEVIEW_HPP
+
+#include <QWidget>
+
+namespace Ui {
+    class RunQueueView;
+}
+
+namespace Developer {
+
+class RunQueue;
+
+/*!
+ * \brief Widget listing the requests in a RunQueue
+ *
+ * Queued requests can be moved, given a different priority or cancelled, and
+ * running ones cancelled. The number of workers set here is saved to the
+ * Run/QueueWorkers setting.
+ */
+class RunQueueView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit RunQueueView(QWidget *parent = 0);
+    ~RunQueueView();
+
+    void setQueue(RunQueue *queue);
+
+public slots:
+    void refresh();
+
+private slots:
+    void moveUp();
+    void moveDown();
+    void cancelSelected();
+    void clearFinished();
+    void priorityChanged(int priority);
+    void workersChanged(int count);
+    void updateButtons();
+
+private:
+    //! Identifier of the selected request, 0 if there is none
+    int selectedId() const;
+
+    Ui::RunQueueView *_ui;
+    RunQueue *_queue;
+};
+
+}
+
+#endif // RUNQUEUEVIEW_HPP
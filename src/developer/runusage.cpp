@@ -0,0 +1,152 @@
+/*!
+ * \file
+ */
+#include "runusage.hpp"
+
+#include <QFile>
+#include <QDomDocument>
+#include <QDebug>
+
+namespace Developer {
+
+ResourceUsage::ResourceUsage()
+    : wallTime(0)
+    , userTime(0)
+    , systemTime(0)
+    , peakMemory(0)
+    , processes(0)
+{
+}
+
+void ResourceUsage::add(const ResourceUsage &other)
+{
+    wallTime += other.wallTime;
+    userTime += other.userTime;
+    systemTime += other.systemTime;
+    peakMemory = qMax(peakMemory, other.peakMemory);
+    processes += other.processes;
+}
+
+RunUsage::RunUsage()
+{
+}
+
+bool RunUsage::isEmpty() const
+{
+    return _stages.isEmpty();
+}
+
+void RunUsage::clear()
+{
+    _stages.clear();
+    _usage.clear();
+}
+
+void RunUsage::add(const QString &stage, const ResourceUsage &usage)
+{
+    int index = _stages.indexOf(stage);
+    if(index < 0)
+    {
+        _stages << stage;
+        _usage.append(usage);
+        return;
+    }
+
+    _usage[index].add(usage);
+}
+
+QStringList RunUsage::stages() const
+{
+    return _stages;
+}
+
+ResourceUsage RunUsage::stage(const QString &stage) const
+{
+    int index = _stages.indexOf(stage);
+    if(index < 0)
+        return ResourceUsage();
+
+    return _usage.at(index);
+}
+
+ResourceUsage RunUsage::total() const
+{
+    ResourceUsage total;
+    for(int i = 0; i < _usage.count(); ++i)
+        total.add(_usage.at(i));
+
+    return total;
+}
+
+bool RunUsage::save(const QString &filePath) const
+{
+    QDomDocument doc("usage");
+    QDomElement root = doc.createElement("usage");
+    doc.appendChild(root);
+
+    for(int i = 0; i < _stages.count(); ++i)
+    {
+        const ResourceUsage &usage = _usage.at(i);
+        QDomElement stage = doc.createElement("stage");
+        stage.setAttribute("name", _stages.at(i));
+        stage.setAttribute("wall", usage.wallTime);
+        stage.setAttribute("user", usage.userTime);
+        stage.setAttribute("system", usage.systemTime);
+        stage.setAttribute("peak", usage.peakMemory);
+        stage.setAttribute("processes", usage.processes);
+        root.appendChild(stage);
+    }
+
+    QFile file(filePath);
+    if(!file.open(QFile::WriteOnly | QFile::Truncate))
+    {
+        qDebug() << "    Could not write run usage: " << filePath;
+        return false;
+    }
+
+    QString xml = doc.toString(4);
+    xml.prepend("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+    file.write(xml.toUtf8());
+    file.close();
+
+    return true;
+}
+
+bool RunUsage::load(const QString &filePath)
+{
+    clear();
+
+    QFile file(filePath);
+    if(!file.exists() || !file.open(QFile::ReadOnly))
+        return false;
+
+    QDomDocument document("usage");
+    if(!document.setContent(&file))
+    {
+        qDebug() << "    Run usage could not be parsed, ignoring it: "
+                 << filePath;
+        return false;
+    }
+
+    QDomNodeList stages = document.documentElement().elementsByTagName("stage");
+    for(int i = 0; i < stages.count(); ++i)
+    {
+        QDomElement elem = stages.at(i).toElement();
+        ResourceUsage usage;
+        usage.wallTime = elem.attribute("wall").toLongLong();
+        usage.userTime = elem.attribute("user").toLongLong();
+        usage.systemTime = elem.attribute("system").toLongLong();
+        usage.peakMemory = elem.attribute("peak").toLongLong();
+        usage.processes = elem.attribute("processes").toInt();
+        add(elem.attribute("name"), usage);
+    }
+
+    return true;
+}
+
+QString RunUsage::usageFile(const QString &resultFile)
+{
+    return resultFile + ".usage";
+}
+
+}
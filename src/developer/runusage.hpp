@@ -0,0 +1,96 @@
+/*!
+ * \file
+ */
+#ifndef RUNUSAGE_HPP
+#define RUNUSAGE_HPP
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+namespace Developer {
+
+/*!
+ * \brief Time and memory used by one or more processes
+ *
+ * CPU times are summed over every process measured, while the peak memory is
+ * the largest resident set size reached by any single one of them.
+ */
+struct ResourceUsage
+{
+    ResourceUsage();
+
+    /*!
+     * \brief Combine another measurement into this one
+     */
+    void add(const ResourceUsage &other);
+
+    //! Wall clock time in milliseconds
+    qint64 wallTime;
+    //! CPU time spent in user mode, in milliseconds
+    qint64 userTime;
+    //! CPU time spent in the kernel, in milliseconds
+    qint64 systemTime;
+    //! Peak resident set size in kilobytes
+    qint64 peakMemory;
+    //! Number of processes which contributed CPU and memory figures
+    int processes;
+};
+
+/*!
+ * \brief Per-stage resource usage of a single run
+ *
+ * Stages are kept in the order they were first recorded. The record is saved
+ * alongside the result graph it belongs to, in a file with the same name and a
+ * .usage suffix:
+ *
+ * \code
+ *  <?xml version="1.0" encoding="UTF-8" ?>
+ *  <usage>
+ *      <stage name="Compiling" wall="120" user="80" system="20" peak="5120"
+ *             processes="1" />
+ *  </usage>
+ * \endcode
+ *
+ * Times are in milliseconds and memory in kilobytes.
+ */
+class RunUsage
+{
+public:
+    RunUsage();
+
+    bool isEmpty() const;
+    void clear();
+
+    /*!
+     * \brief Add a measurement to a stage, creating the stage if needed
+     */
+    void add(const QString &stage, const ResourceUsage &usage);
+
+    QStringList stages() const;
+    ResourceUsage stage(const QString &stage) const;
+
+    /*!
+     * \brief Get the usage of the whole run
+     *
+     * Wall times are added up, which is correct because the stages of a run
+     * happen one after another.
+     */
+    ResourceUsage total() const;
+
+    bool save(const QString &filePath) const;
+    bool load(const QString &filePath);
+
+    /*!
+     * \brief Get the path the usage of a result graph is stored at
+     */
+    static QString usageFile(const QString &resultFile);
+
+private:
+    QStringList _stages;
+    QVector<ResourceUsage> _usage;
+};
+
+}
+
+#endif // RUNUSAGE_HPP
@@ -0,0 +1,277 @@
+/*!
+ * \file
+ */
+#include "syntaxcheck.hpp"
+
+#include <QObject>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+#include <QList>
+#include <QDebug>
+
+#include <stdio.h>
+#include <string.h>
+
+extern "C" {
+#include "translate/globals.h"
+#include "translate/ast.h"
+#include "translate/parser.h"
+}
+
+// Defined in ruleparser.cpp and read by the lexer to pick the grammar
+extern int parse_target;
+extern "C" { int yyparse(); void yyrestart(FILE *new_file); extern int yycolumn; }
+
+namespace Developer {
+
+SyntaxError::SyntaxError()
+    : line(0)
+    , column(0)
+{
+}
+
+QString SyntaxError::toString() const
+{
+    return QString("%1:%2:%3: %4").arg(file).arg(line).arg(column).arg(message);
+}
+
+bool SyntaxCheck::check(const QString &filePath, Target target,
+                        SyntaxError *error)
+{
+    bool valid = parse(filePath, target, error);
+
+    // Only the verdict is wanted, not the tree
+    freeTree(target);
+
+    return valid;
+}
+
+namespace {
+
+// What the walk from Main has found so far
+struct CallGraph
+{
+    QStringList called;
+    QSet<QString> calledSet;
+    QSet<GPProcedure *> visited;
+};
+
+void visitCommand(GPCommand *command, const QList<List *> &scopes,
+                  CallGraph &graph);
+
+void addRule(const char *name, CallGraph &graph)
+{
+    if(name == NULL)
+        return;
+
+    QString rule = QString::fromLocal8Bit(name);
+    if(graph.calledSet.contains(rule))
+        return;
+
+    graph.calledSet.insert(rule);
+    graph.called << rule;
+}
+
+void visitProcedure(GPProcedure *procedure, QList<List *> scopes,
+                    CallGraph &graph)
+{
+    if(procedure == NULL || graph.visited.contains(procedure))
+        return;
+
+    graph.visited.insert(procedure);
+    if(procedure->local_decls != NULL)
+        scopes << procedure->local_decls;
+    visitCommand(procedure->commands, scopes, graph);
+}
+
+void callProcedure(const char *name, const QList<List *> &scopes,
+                   CallGraph &graph)
+{
+    if(name == NULL)
+        return;
+
+    // Innermost scope first, the procedure is walked in the scope it was
+    // declared in rather than the one it was called from
+    for(int depth = scopes.count() - 1; depth >= 0; --depth)
+    {
+        for(List *decl = scopes.at(depth); decl != NULL; decl = decl->next)
+        {
+            GPDeclaration *declaration = decl->declaration;
+            if(declaration == NULL
+                    || declaration->type != PROCEDURE_DECLARATION
+                    || declaration->procedure == NULL
+                    || declaration->procedure->name == NULL
+                    || strcmp(declaration->procedure->name, name) != 0)
+                continue;
+
+            visitProcedure(declaration->procedure, scopes.mid(0, depth + 1),
+                           graph);
+            return;
+        }
+    }
+}
+
+void visitCommand(GPCommand *command, const QList<List *> &scopes,
+                  CallGraph &graph)
+{
+    if(command == NULL)
+        return;
+
+    switch(command->type)
+    {
+    case COMMAND_SEQUENCE:
+        for(List *item = command->commands; item != NULL; item = item->next)
+            visitCommand(item->command, scopes, graph);
+        break;
+    case RULE_CALL:
+        addRule(command->rule_call.rule_name, graph);
+        break;
+    case RULE_SET_CALL:
+        for(List *item = command->rule_set; item != NULL; item = item->next)
+            addRule(item->rule_call.rule_name, graph);
+        break;
+    case PROCEDURE_CALL:
+        callProcedure(command->proc_call.proc_name, scopes, graph);
+        break;
+    case IF_STATEMENT:
+    case TRY_STATEMENT:
+        visitCommand(command->cond_branch.condition, scopes, graph);
+        visitCommand(command->cond_branch.then_command, scopes, graph);
+        visitCommand(command->cond_branch.else_command, scopes, graph);
+        break;
+    case ALAP_STATEMENT:
+        visitCommand(command->loop_stmt.loop_body, scopes, graph);
+        break;
+    case PROGRAM_OR:
+        visitCommand(command->or_stmt.left_command, scopes, graph);
+        visitCommand(command->or_stmt.right_command, scopes, graph);
+        break;
+    default:
+        break;
+    }
+}
+
+void collectDeclaredRules(List *declarations, QStringList *declared)
+{
+    for(List *decl = declarations; decl != NULL; decl = decl->next)
+    {
+        GPDeclaration *declaration = decl->declaration;
+        if(declaration == NULL)
+            continue;
+
+        if(declaration->type == RULE_DECLARATION && declaration->rule != NULL
+                && declaration->rule->name != NULL)
+            *declared << QString::fromLocal8Bit(declaration->rule->name);
+        else if(declaration->type == PROCEDURE_DECLARATION
+                && declaration->procedure != NULL)
+            collectDeclaredRules(declaration->procedure->local_decls, declared);
+    }
+}
+
+}
+
+bool SyntaxCheck::reachableRules(const QString &filePath, QStringList *called,
+                                 QStringList *declared, SyntaxError *error)
+{
+    if(called != 0)
+        called->clear();
+    if(declared != 0)
+        declared->clear();
+
+    if(!parse(filePath, Target_Program, error))
+    {
+        freeTree(Target_Program);
+        return false;
+    }
+
+    CallGraph graph;
+    QList<List *> scopes;
+    scopes << gp_program;
+    for(List *decl = gp_program; decl != NULL; decl = decl->next)
+    {
+        GPDeclaration *declaration = decl->declaration;
+        if(declaration != NULL && declaration->type == MAIN_DECLARATION)
+            visitCommand(declaration->main_program, scopes, graph);
+    }
+
+    if(called != 0)
+        *called = graph.called;
+    if(declared != 0)
+        collectDeclaredRules(gp_program, declared);
+
+    freeTree(Target_Program);
+    return true;
+}
+
+bool SyntaxCheck::parse(const QString &filePath, Target target,
+                        SyntaxError *error)
+{
+    if(error != 0)
+    {
+        *error = SyntaxError();
+        error->file = filePath;
+    }
+
+    FILE *input = fopen(QFile::encodeName(filePath).constData(), "r");
+    if(input == 0)
+    {
+        if(error != 0)
+            error->message = QObject::tr("could not open the file");
+        return false;
+    }
+
+    // Every check starts the parser from scratch, nothing else resets it
+    yyin = input;
+    yyrestart(yyin);
+    yylineno = 1;
+    yycolumn = 1;
+    syntax_error = false;
+    gp_program = NULL;
+    gp_rule = NULL;
+    ast_host_graph = NULL;
+    parse_target = target;
+
+    bool valid = (yyparse() == 0) && !syntax_error;
+    fclose(input);
+    yyin = NULL;
+
+    if(!valid && error != 0)
+    {
+        error->line = yylloc.first_line;
+        error->column = yylloc.first_column;
+        if(yytext != NULL && yytext[0] != '\0')
+            error->message = QObject::tr("syntax error near '%1'")
+                    .arg(QString::fromLocal8Bit(yytext).trimmed());
+        else
+            error->message = QObject::tr("syntax error");
+    }
+
+    if(!valid)
+        qDebug() << "    Syntax check rejected" << QFileInfo(filePath).fileName();
+
+    return valid;
+}
+
+void SyntaxCheck::freeTree(Target target)
+{
+    switch(target)
+    {
+    case Target_Program:
+        freeAST(gp_program);
+        gp_program = NULL;
+        break;
+    case Target_Graph:
+        if(ast_host_graph != NULL)
+            freeASTGraph(ast_host_graph);
+        ast_host_graph = NULL;
+        break;
+    case Target_Rule:
+        if(gp_rule != NULL)
+            freeASTRule(gp_rule);
+        gp_rule = NULL;
+        break;
+    }
+}
+
+}
@@ -0,0 +1,91 @@
+/*!
+ * \file
+ */
+#ifndef SYNTAXCHECK_HPP
+#define SYNTAXCHECK_HPP
+
+#include <QString>
+#include <QStringList>
+
+namespace Developer {
+
+/*!
+ * \brief Where and why the embedded parser rejected a file
+ */
+struct SyntaxError
+{
+    SyntaxError();
+
+    /*!
+     * \brief Format the error as "file:line:column: message"
+     */
+    QString toString() const;
+
+    QString file;
+    //! Line of the token the parser stopped at, counting from 1
+    int line;
+    //! Column of the token the parser stopped at, counting from 1
+    int column;
+    QString message;
+};
+
+/*!
+ * \brief Syntax checks using the GP2 parser built into the editor
+ *
+ * This is the same flex/bison grammar gp2compile uses, so a file it rejects
+ * would also be rejected by the compiler. No semantic analysis is done, that is
+ * left to the compiler. The parser keeps its state in globals, so checks must
+ * only be made from the GUI thread.
+ */
+class SyntaxCheck
+{
+public:
+    //! What to parse a file as, the values are the parser's start tokens
+    enum Target
+    {
+        Target_Program = 1,
+        Target_Graph = 2,
+        Target_Rule = 3
+    };
+
+    /*!
+     * \brief Parse a file and report whether it is syntactically valid
+     * \param filePath  The file to parse
+     * \param target    Whether the file is a program, a host graph or a rule
+     * \param error     If not null, receives the location of the first problem
+     *  when the file is rejected
+     * \return True if the file parsed without errors
+     */
+    static bool check(const QString &filePath, Target target,
+                      SyntaxError *error = 0);
+
+    /*!
+     * \brief Find the rules a program can call, starting from Main
+     *
+     * Main is followed through procedure calls, rule set calls and every
+     * branch of the control constructs. A procedure is looked up in the scope
+     * it was called from and then in each enclosing scope, as the compiler
+     * does. Procedures which are never called contribute nothing.
+     *
+     * \param filePath  The program to parse
+     * \param called    Receives the name of every rule reachable from Main,
+     *  each once
+     * \param declared  If not null, receives the rules the program declares
+     *  itself, reachable or not
+     * \param error     If not null, receives the location of the first problem
+     *  when the program is rejected
+     * \return True if the program parsed without errors
+     */
+    static bool reachableRules(const QString &filePath, QStringList *called,
+                               QStringList *declared = 0,
+                               SyntaxError *error = 0);
+
+private:
+    static bool parse(const QString &filePath, Target target,
+                      SyntaxError *error);
+    static void freeTree(Target target);
+};
+
+}
+
+#endif // SYNTAXCHECK_HPP
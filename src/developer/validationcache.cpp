@@ -0,0 +1,201 @@
+/*!
+ * \file
+ */
+#include "validationcache.hpp"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDateTime>
+#include <QDomDocument>
+#include <QCryptographicHash>
+#include <QStandardPaths>
+#include <QDebug>
+
+namespace Developer {
+
+ValidationCache::ValidationCache(const QString &cachePath)
+    : _cachePath(cachePath)
+    , _modified(false)
+{
+}
+
+QString ValidationCache::cachePath() const
+{
+    return _cachePath;
+}
+
+void ValidationCache::setCachePath(const QString &cachePath)
+{
+    _cachePath = cachePath;
+}
+
+void ValidationCache::setCompiler(const QString &compiler)
+{
+    QString identity = identify(compiler);
+    if(identity == _identity)
+        return;
+
+    if(!_valid.isEmpty())
+        qDebug() << "    Compiler changed, discarding cached validation results";
+
+    _identity = identity;
+    _valid.clear();
+    _modified = true;
+}
+
+QString ValidationCache::compilerIdentity() const
+{
+    return _identity;
+}
+
+bool ValidationCache::load()
+{
+    _valid.clear();
+    _used.clear();
+    _modified = false;
+
+    QFile file(_cachePath);
+    if(_cachePath.isEmpty() || !file.exists())
+        return false;
+
+    if(!file.open(QFile::ReadOnly))
+    {
+        qDebug() << "    Could not open validation cache: " << _cachePath;
+        return false;
+    }
+
+    QDomDocument document("validation");
+    if(!document.setContent(&file))
+    {
+        qDebug() << "    Validation cache could not be parsed, ignoring it.";
+        return false;
+    }
+
+    QDomElement root = document.documentElement();
+    _identity = root.attribute("compiler");
+
+    QDomNodeList entries = root.elementsByTagName("valid");
+    for(int i = 0; i < entries.count(); ++i)
+        _valid.insert(entries.at(i).toElement().text().toLatin1());
+
+    return true;
+}
+
+bool ValidationCache::save()
+{
+    // Nothing can be said about which entries are stale until some have been
+    // looked up
+    if(!_used.isEmpty())
+    {
+        QSet<QByteArray>::iterator iter = _valid.begin();
+        while(iter != _valid.end())
+        {
+            if(_used.contains(*iter))
+                ++iter;
+            else
+            {
+                iter = _valid.erase(iter);
+                _modified = true;
+            }
+        }
+    }
+
+    if(!_modified || _cachePath.isEmpty())
+        return true;
+
+    QDomDocument doc("validation");
+    QDomElement root = doc.createElement("validation");
+    root.setAttribute("compiler", _identity);
+    doc.appendChild(root);
+
+    foreach(QByteArray hash, _valid)
+    {
+        QDomElement entry = doc.createElement("valid");
+        entry.appendChild(doc.createTextNode(QString(hash)));
+        root.appendChild(entry);
+    }
+
+    QFile file(_cachePath);
+    if(!file.open(QFile::WriteOnly | QFile::Truncate))
+    {
+        qDebug() << "    Could not write validation cache: " << _cachePath;
+        return false;
+    }
+
+    QString xml = doc.toString(4);
+    xml.prepend("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+    file.write(xml.toUtf8());
+    file.close();
+
+    _modified = false;
+    return true;
+}
+
+void ValidationCache::clear()
+{
+    if(_valid.isEmpty())
+        return;
+
+    _valid.clear();
+    _modified = true;
+}
+
+bool ValidationCache::isValid(const QString &filePath, ValidationKind kind) const
+{
+    // Without a compiler identity there is nothing to trust the result against
+    if(_identity.isEmpty())
+        return false;
+
+    QByteArray hash = key(filePath, kind);
+    if(hash.isEmpty())
+        return false;
+
+    _used.insert(hash);
+    return _valid.contains(hash);
+}
+
+void ValidationCache::setValid(const QString &filePath, ValidationKind kind)
+{
+    if(_identity.isEmpty())
+        return;
+
+    QByteArray hash = key(filePath, kind);
+    if(hash.isEmpty())
+        return;
+
+    _used.insert(hash);
+    if(_valid.contains(hash))
+        return;
+
+    _valid.insert(hash);
+    _modified = true;
+}
+
+QString ValidationCache::identify(const QString &compiler)
+{
+    QString path = compiler;
+    if(!compiler.contains(QDir::separator()) && !compiler.contains('/'))
+        path = QStandardPaths::findExecutable(compiler);
+
+    QFileInfo info(path);
+    if(path.isEmpty() || !info.exists())
+        return QString();
+
+    return info.canonicalFilePath() + " "
+            + info.lastModified().toString(Qt::ISODate);
+}
+
+QByteArray ValidationCache::key(const QString &filePath, ValidationKind kind)
+{
+    QFile file(filePath);
+    if(!file.open(QFile::ReadOnly))
+        return QByteArray();
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray::number(static_cast<int>(kind)));
+    hash.addData(file.readAll());
+    return hash.result().toHex();
+}
+
+}
@@ -0,0 +1,104 @@
+/*!
+ * \file
+ */
+#ifndef VALIDATIONCACHE_HPP
+#define VALIDATIONCACHE_HPP
+
+#include <QString>
+#include <QByteArray>
+#include <QSet>
+
+namespace Developer {
+
+/*!
+ * \brief Record of files which the GP2 compiler has already accepted
+ *
+ * Validating a file with gp2compile only depends on the file's contents and on
+ * the compiler itself, so once a file has passed validation there is no need
+ * to check it again until one of those changes. Entries are keyed by a SHA-1
+ * hash of the kind of validation (rule, program or host graph) and the file's
+ * contents. The cache as a whole is tied to the compiler's identity, its
+ * resolved path and modification time, and is discarded when that changes.
+ *
+ * Only successful validations are recorded, a file which fails is always
+ * passed back to the compiler so that its errors appear in the log.
+ *
+ * A file which is edited or deleted leaves its old entry behind, and nothing
+ * will ever look that entry up again. save() therefore drops every entry which
+ * has not been looked up or recorded since the cache was loaded, so the cache
+ * only holds the files used in the current session. A file whose entry was
+ * dropped this way is simply validated again the next time it is used.
+ *
+ * The cache is stored in the project's results directory:
+ *
+ * \code
+ *  <?xml version="1.0" encoding="UTF-8" ?>
+ *  <validation compiler="/usr/local/bin/gp2compile 2014-03-01T12:00:00">
+ *      <valid>3f786850e387550fdab836ed7e6dc881de23001b</valid>
+ *  </validation>
+ * \endcode
+ */
+class ValidationCache
+{
+public:
+    /*!
+     * \brief The kinds of file gp2compile can validate
+     */
+    enum ValidationKind
+    {
+        //! gp2compile -r
+        RuleValidation,
+        //! gp2compile -p
+        ProgramValidation,
+        //! gp2compile -h
+        GraphValidation
+    };
+
+    explicit ValidationCache(const QString &cachePath = QString());
+
+    QString cachePath() const;
+    void setCachePath(const QString &cachePath);
+
+    /*!
+     * \brief Set the compiler whose results are being cached
+     *
+     * If the compiler's identity differs from the one the cache was built
+     * with then all existing entries are dropped.
+     *
+     * \param compiler  Name or path of the compiler executable
+     */
+    void setCompiler(const QString &compiler);
+    QString compilerIdentity() const;
+
+    bool load();
+    bool save();
+    void clear();
+
+    bool isValid(const QString &filePath, ValidationKind kind) const;
+    void setValid(const QString &filePath, ValidationKind kind);
+
+    /*!
+     * \brief Describe a compiler executable by its resolved path and
+     *  modification time
+     *
+     * \param compiler  Name or path of the compiler, names are looked up with
+     *  QStandardPaths::findExecutable()
+     * \return The identity string, or an empty string if the executable could
+     *  not be found
+     */
+    static QString identify(const QString &compiler);
+
+private:
+    static QByteArray key(const QString &filePath, ValidationKind kind);
+
+    QString _cachePath;
+    QString _identity;
+    QSet<QByteArray> _valid;
+    //! Keys looked up or recorded since load(), see save()
+    mutable QSet<QByteArray> _used;
+    bool _modified;
+};
+
+}
+
+#endif // VALIDATIONCACHE_HPP